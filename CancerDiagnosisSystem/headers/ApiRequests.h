@@ -0,0 +1,74 @@
+#ifndef API_REQUESTS_H
+#define API_REQUESTS_H
+
+#include "CancerDiagnosisSystem.h"
+#include "GeneticData.h"
+#include "Patient.h"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JsonReader;
+
+// Model named in a request (logistic|knn|decision_tree|naive_bayes);
+// unknown names select logistic regression
+CancerDiagnosisSystem::ModelType modelTypeFromName(std::string_view name);
+
+// Request bodies of the HTTP API, bound field by field from a single pass
+// of JsonReader. Each parse() returns false with a message in `error` if
+// the body is not valid JSON or a field has the wrong type; unknown
+// members are skipped, and missing fields keep their defaults so the
+// handlers can report them.
+
+// POST /load {"genesFile":"data/genes.csv","patientsFile":"data/patients.csv"}
+struct LoadRequest {
+    std::string genesFile;
+    std::string patientsFile;
+
+    bool parse(std::string_view body, std::string& error);
+};
+
+// POST /patients {"patient_id":"P011","name":"Alice","age":30,
+//                 "geneticRecords":[{"geneId":"GENE_010","mutationScore":0.45,"label":0}]}
+struct PatientRequest {
+    std::string patientId; // patient_id, patientId or id
+    std::string name;
+    int age = 0;
+    std::vector<GeneticData> geneticRecords; // geneId/gene_id, mutationScore/mutation_score, label
+
+    bool parse(std::string_view body, std::string& error);
+    bool read(JsonReader& reader); // The patient object at the reader's position
+    Patient toPatient() const;     // With the genetic records attached
+};
+
+// POST /queue {"patient_id":"P001","model":"knn","priority":"urgent","deadline_ms":2000}
+struct QueueRequest {
+    std::string patientId; // patient_id or patientId
+    CancerDiagnosisSystem::ModelType model = CancerDiagnosisSystem::ModelType::LOGISTIC;
+    std::optional<TestPriority> priority; // priority or urgency; unknown names leave it unset
+    std::optional<std::chrono::milliseconds> deadline; // Capped at the LOW budget; negative is an error
+
+    bool parse(std::string_view body, std::string& error);
+};
+
+// POST /queue/process {"model":"logistic"}; the body may be empty
+struct ProcessQueueRequest {
+    std::string modelName; // As given, for the response
+    std::optional<CancerDiagnosisSystem::ModelType> model;
+
+    bool parse(std::string_view body, std::string& error);
+};
+
+// POST /diagnose/batch {"patient_ids":["P001","P002"],"patients":[{ as POST /patients }],
+//                       "models":["logistic","knn"]}
+struct BatchDiagnosisRequest {
+    std::vector<std::string> patientIds; // Stored patients; patient_ids or patientIds
+    std::vector<PatientRequest> patients; // Inline patients, scored but not stored
+    std::vector<CancerDiagnosisSystem::ModelType> models; // Without repeats; logistic if none given
+
+    bool parse(std::string_view body, std::string& error);
+};
+
+#endif // API_REQUESTS_H
@@ -0,0 +1,24 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <string>
+#include <string_view>
+#include <initializer_list>
+
+/**
+ * @brief Crash-safe whole-file replacement
+ *
+ * The parts are written to "<filename>.tmp", fsync'd, and renamed over
+ * `filename`, so after a crash the target holds either the old or the new
+ * contents, never a truncated mix.
+ */
+bool writeFileAtomically(const std::string& filename, std::initializer_list<std::string_view> parts);
+
+// The two halves of writeFileAtomically, for replacing several files
+// together: stage each one (written and fsync'd as "<filename>.tmp"),
+// record that they belong together, then commit them
+bool stageFile(const std::string& filename, std::initializer_list<std::string_view> parts);
+bool commitStagedFile(const std::string& filename); // Rename into place, durably
+void discardStagedFile(const std::string& filename);
+
+#endif // ATOMIC_FILE_H
@@ -2,7 +2,10 @@
 #define CANCER_DIAGNOSIS_SYSTEM_H
 
 #include "Patient.h"
+#include "PatientStore.h"
 #include "GeneticData.h"
+#include "GeneticDataTable.h"
+#include "FeatureMatrix.h"
 #include "DataPreprocessor.h"
 #include "HashMapper.h"
 #include "DecisionTreeClassifier.h"
@@ -10,59 +13,244 @@
 #include "KNNClassifier.h"
 #include "NaiveBayesClassifier.h"
 #include "EvaluationMetrics.h"
+#include "WriteAheadLog.h"
+#include "PersistenceWorker.h"
+#include "Snapshot.h"
+#include "TestScheduler.h"
+#include "DiagnosisWorkerPool.h"
+#include "DiagnosisCache.h"
 #include <vector>
-#include <queue>
-#include <list>
+#include <algorithm>
+#include <span>
+#include <string_view>
+#include <deque>
+#include <atomic>
+#include <optional>
 #include <string>
 #include <memory>
-
-/**
- * @struct PatientNode
- * @brief Node for linked list storing patient history
- */
-struct PatientNode {
-    Patient patient;
-    std::shared_ptr<PatientNode> next;
-    
-    PatientNode(const Patient& p) : patient(p), next(nullptr) {}
-};
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <chrono>
 
 /**
  * @class CancerDiagnosisSystem
  * @brief Main controller class for the cancer diagnosis system
  */
 class CancerDiagnosisSystem {
+public:
+    enum class ModelType : uint8_t { LOGISTIC, KNN, DECISION_TREE, NAIVE_BAYES };
+    
+    // Outcome of one scheduled test
+    struct DiagnosisResult {
+        std::string patientId;
+        std::string name;
+        ModelType model;
+        double riskScore;
+        int prediction;
+        bool found; // False if the patient was no longer stored
+    };
+    
 private:
+    // A scheduled test: a handle to a stored patient and the model to use
+    struct DiagnosisRequest {
+        Symbol patientId;
+        ModelType model;
+        uint8_t batch; // Slot of pendingDiagnoses the test is counted in
+    };
+    
+    // Fitted preprocessing and trained models. A set is never modified once
+    // published: retraining builds a new one and swaps the pointer, and
+    // diagnoses still holding the old set finish with it.
+    struct ModelSet {
+        DataPreprocessor preprocessor;
+        std::unique_ptr<LogisticRegressionModel> logisticModel;
+        std::unique_ptr<KNNClassifier> knnModel;
+        std::unique_ptr<DecisionTreeClassifier> decisionTreeModel;
+        std::unique_ptr<NaiveBayesClassifier> naiveBayesModel;
+        bool trained;
+        uint64_t version; // Unique to this set, so cached scores name the models they came from
+        ModelSet(); // Untrained, with the default hyperparameters
+    };
+    
+    // Everything a full load replaces, built off the state lock. Patients
+    // refer to rows of the live gene table, which `geneticData` replaces
+    // on commit.
+    struct LoadedData {
+        GeneticDataTable geneticData;
+        HashMapper mutationMapper;
+        PatientStore patientHistory;
+        size_t genesFileOffset = 0;
+        size_t patientsFileOffset = 0;
+        std::vector<uint32_t> patientFileRows;
+        size_t logRecordsSeen = 0; // Write-ahead log records replayed so far
+    };
+    
+    static constexpr size_t kDiagnosisQueueCapacity = 4096;
+    static constexpr size_t kMaxCompletedDiagnoses = 4096; // Oldest uncollected results are dropped
+    static constexpr size_t kDiagnosisCacheCapacity = 65536; // Scores, one per patient and model
+    // A background flush folds the write-ahead log into the base files once
+    // it holds this many bytes, or once it has gone this long without a fold
+    static constexpr uint64_t kLogFoldBytes = 4 * 1024 * 1024;
+    static constexpr std::chrono::minutes kLogFoldAge{5};
+    
+    // CSV contents, encoded under the shared state lock and written after it is released
+    struct DataFileContents {
+        std::string genes;
+        std::string patients;
+        size_t geneCount = 0;
+        size_t patientCount = 0;
+        std::vector<uint32_t> patientRows; // Store positions written, in file order
+    };
+    
+    // A position in the write-ahead log, valid only while the log keeps the
+    // same id: the data files being written hold the records before it
+    struct LogCheckpoint {
+        uint64_t logId = 0;
+        uint64_t bytes = 0;
+    };
+    
+    // Snapshot payload encoded under the shared state lock; the stamp of the
+    // source files is filled in just before it is written
+    struct EncodedSnapshot {
+        SnapshotWriter writer;
+        size_t stampPosition = 0;
+    };
+    
+
     // Data structures
-    std::vector<GeneticData> geneticDataArray;
-    std::shared_ptr<PatientNode> patientHistoryHead; // Linked list
-    std::queue<Patient> testRequestQueue; // Queue for test scheduling
+    GeneticDataTable geneticData; // Columnar
+    PatientStore patientHistory; // Indexed by patient ID, newest last
+    std::unique_ptr<TestScheduler<DiagnosisRequest>> testRequestQueue; // Test scheduling
+    // Tests queued or in progress, by the parity of the collection batch they
+    // were scheduled in. collectDiagnoses closes the current batch and waits
+    // only for its tests, so tests scheduled meanwhile never hold it up.
+    std::atomic<size_t> pendingDiagnoses[2];
+    std::atomic<uint64_t> diagnosisBatch;
+    std::mutex collectMutex; // One collectDiagnoses at a time
+    // Notified when a batch's count drops to zero; the mutex orders that
+    // with a collector checking the count before it sleeps
+    std::mutex diagnosisMutex;
+    std::condition_variable diagnosisDone;
+    std::deque<DiagnosisResult> completedDiagnoses; // Guarded by stateMutex
+    std::unique_ptr<DiagnosisWorkerPool> diagnosisWorkers;
     HashMapper mutationMapper;
     
-    // Preprocessing
-    DataPreprocessor preprocessor;
+    // Preprocessing and ML models; replaced whole (under stateMutex) and
+    // read without it. modelsMutex only guards copying or swapping the
+    // pointer (std::atomic<std::shared_ptr> is missing from libc++).
+    std::shared_ptr<const ModelSet> models;
+    mutable std::mutex modelsMutex;
+    std::shared_ptr<const ModelSet> currentModels() const;
+    void publishModels(std::shared_ptr<const ModelSet> modelSet);
+    // Each gene table handed to training gets the next generation, and
+    // models are only published if trained on a newer table than the
+    // current set, so a slow retrain never replaces newer models. Both are
+    // guarded by stateMutex.
+    uint64_t trainingGeneration;
+    uint64_t modelsGeneration;
     
-    // ML Models
-    std::unique_ptr<LogisticRegressionModel> logisticModel;
-    std::unique_ptr<KNNClassifier> knnModel;
-    std::unique_ptr<DecisionTreeClassifier> decisionTreeModel;
-    std::unique_ptr<NaiveBayesClassifier> naiveBayesModel;
+    // Incremented after every change to the data or models
+    std::atomic<uint64_t> dataVersion;
+    void markDataChanged();
+    
+    // Scores of stored patients from diagnoseStoredPatient, checked against
+    // the patient's revision and the model set before reuse
+    mutable DiagnosisCache diagnosisCache;
     
     // Evaluation
     EvaluationMetrics evaluator;
     
-    // Training data
-    std::vector<std::vector<double>> X_train;
-    std::vector<int> y_train;
-    bool modelsTrained;
+    static constexpr size_t kFeatureCount = 1;
+    
+    // Incremental loading state (byte offsets of the first unread row)
+    std::string loadedGenesFile;
+    std::string loadedPatientsFile;
+    size_t genesFileOffset;
+    size_t patientsFileOffset;
+    // Store position of the patient each patients-file row was read into,
+    // in file order. A row's number drives its gene assignment, so rewrites
+    // keep every row, including IDs repeated in the file.
+    std::vector<uint32_t> patientFileRows;
+    
+    // Write-ahead log of individual additions to the base CSV files
+    std::unique_ptr<WriteAheadLog> writeAheadLog;
+    std::string logGenesFile;
+    std::string logPatientsFile;
+    std::chrono::steady_clock::time_point lastLogFold; // Guarded by loadMutex
+    
+    // Background CSV flushing (coalesced, crash-safe)
+    std::unique_ptr<PersistenceWorker> persistenceWorker;
+    std::string persistGenesFile;
+    std::string persistPatientsFile;
+    std::string persistSnapshotFile;
     
-    // Helper functions
-    void loadGeneticDataFromFile(const std::string& filename);
-    void loadPatientsFromFile(const std::string& filename);
+    // Readers (lookups, listings, diagnoses) share the lock; mutations, file
+    // writes and the background flush hold it exclusively
+    mutable std::shared_mutex stateMutex;
+    // Serializes loads and rewrites of the data files, so the write-ahead log
+    // is not folded while a load is being built. Taken before stateMutex.
+    mutable std::mutex loadMutex;
+    
+    // Helper functions (callers hold stateMutex unless noted; loaders return
+    // the offset just past the last row read)
+    void loadFromFiles(const std::string& genesFile, const std::string& patientsFile); // Holds loadMutex only
+    size_t loadGeneticDataFromFile(const std::string& filename, size_t startOffset, 
+                                   GeneticDataTable& genes, HashMapper& mapper) const;
+    size_t loadPatientsFromFile(const std::string& filename, size_t startOffset, 
+                                const GeneticDataTable& genes, PatientStore& patients, 
+                                std::vector<uint32_t>& fileRows) const;
+    // Swap in a loaded data set and its models; holds loadMutex and stateMutex
+    void commitLoadedData(LoadedData& data, std::shared_ptr<const ModelSet> loadedModels, 
+                          const std::string& genesFile, const std::string& patientsFile);
     void addPatientToHistory(const Patient& patient);
-    void prepareTrainingData();
-    void trainAllModels();
-    std::vector<double> extractFeatures(const Patient& patient) const;
+    void recordPatient(const Patient& patient); // addPatientToHistory + log
+    // Apply the log records after the first data.logRecordsSeen to a load
+    // being built; returns how many were applied. Holds loadMutex.
+    size_t replayWriteAheadLog(LoadedData& data) const;
+    // Files are written holding loadMutex but not stateMutex: the encode
+    // calls run under the shared lock, and the writes after releasing it
+    void encodeDataFiles(DataFileContents& out) const;
+    // Offsets and file rows are those of the CSV files the snapshot will
+    // describe. False while the models are being retrained for rows already
+    // in the table: the snapshot would pair the data with older models.
+    bool encodeSnapshot(EncodedSnapshot& out, uint64_t genesOffset, uint64_t patientsOffset, 
+                        const std::vector<uint32_t>& fileRows) const;
+    // Both files are replaced together: after a crash recoverDataFiles
+    // leaves either the old pair or the new one. `folded` names the log
+    // records the new files already hold.
+    bool writeDataFiles(const std::string& genesFile, const std::string& patientsFile, 
+                        const DataFileContents& contents, 
+                        std::optional<LogCheckpoint> folded = std::nullopt);
+    // Finish a rewrite of the data files that committed before a crash,
+    // and drop log records it folded if the crash came before they were.
+    // Holds loadMutex.
+    void recoverDataFiles(const std::string& genesFile, const std::string& patientsFile);
+    bool writeSnapshot(const std::string& snapshotFile, EncodedSnapshot& snapshot) const;
+    // Rewrite the base files (and the snapshot, if given) from the current
+    // state and drop the log records they now hold. Holds loadMutex only.
+    bool foldWriteAheadLog(const std::string& snapshotFile);
+    void flushChanges(); // Run by the persistence worker; takes loadMutex
+    // Fit the preprocessor and all four models on the table; needs no lock
+    // beyond what keeps `genes` unchanged
+    static std::shared_ptr<const ModelSet> trainModels(const GeneticDataTable& genes);
+    // Model risk score from extracted features; needs no lock
+    static double scoreFeatures(const ModelSet& modelSet, std::span<const double> features, ModelType model);
+    // Run one scheduled test (takes stateMutex); `model` overrides the request's
+    void runDiagnosis(DiagnosisRequest request, std::optional<ModelType> model);
+    bool processNextDiagnosis(); // Pop and run one request; false if none was queued
+    void finishDiagnosis(uint8_t batch); // Uncount a test that ran or was dropped
+    void discardQueuedTests();
+    std::vector<DiagnosisResult> collectDiagnoses(std::optional<ModelType> model);
+    // Writes the kFeatureCount model inputs for a patient into `features`
+    void extractFeatures(const Patient& patient, const ModelSet& modelSet, std::span<double> features) const;
+    // As above; `tableMean` caches the mean score of the whole gene table
+    // (used for patients without genetic data) across calls of one batch
+    void extractFeatures(const Patient& patient, const ModelSet& modelSet, std::span<double> features, 
+                         std::optional<double>& tableMean) const;
+    // Risk scores of every row of `features` under one model
+    static std::vector<double> scoreFeatureMatrix(const ModelSet& modelSet, const FeatureMatrix& features, 
+                                                  ModelType model);
     
 public:
     CancerDiagnosisSystem();
@@ -70,24 +258,69 @@ public:
     
     // Data acquisition
     void loadData(const std::string& genesFile, const std::string& patientsFile);
+    // Ingest only rows appended since the last load; falls back to loadData
+    // (and returns false) when the files changed identity or were rewritten
+    bool appendData(const std::string& genesFile, const std::string& patientsFile);
     void addPatient(const Patient& patient);
     void addGeneticData(const GeneticData& data);
     
-    // Test scheduling
-    void scheduleTest(const Patient& patient);
+    // Test scheduling. The queue holds patient IDs; scheduling returns false
+    // when it is full. Diagnosis workers, if started, run tests as soon as
+    // they are queued. The processTestQueue* calls run the tests scheduled
+    // before them that are still queued on the calling thread (with their own
+    // model, if given), wait for those in progress and return the results
+    // since the last call. Tests scheduled meanwhile are left to the next call.
+    //
+    // Without an explicit priority, a test is classed by defaultPriority()
+    // (in FIFO mode, tests scheduled by ID are NORMAL so that scheduling stays
+    // lock-free). In DEADLINE mode, which the server uses by default,
+    // scheduling and dispatch take the scheduler's short heap mutex; only
+    // FIFO mode is lock-free. `deadline` is relative to now.
+    bool scheduleTest(const Patient& patient, ModelType model = ModelType::LOGISTIC, // Stores the patient if new
+                      std::optional<TestPriority> priority = std::nullopt, 
+                      std::optional<std::chrono::milliseconds> deadline = std::nullopt);
+    bool scheduleTest(std::string_view patientId, ModelType model = ModelType::LOGISTIC, 
+                      std::optional<TestPriority> priority = std::nullopt, 
+                      std::optional<std::chrono::milliseconds> deadline = std::nullopt);
+    // HIGH for patients aged 65+ or with a prior risk score of 0.5 or more
+    static TestPriority defaultPriority(const Patient& patient);
+    // Configuration calls; not safe while other threads schedule or process tests
+    void startDiagnosisWorkers(size_t workerCount);
+    void stopDiagnosisWorkers();
+    bool setSchedulingMode(SchedulingMode mode); // False if tests are queued
+    SchedulingMode getSchedulingMode() const;
     void processTestQueue();
     // Process test queue and return number processed
     int processTestQueueAndReturnCount();
     // Process test queue with selected model and return diagnosis results
-    std::vector<std::string> processTestQueueWithModel(ModelType model);
-    // Query queue state
+    std::vector<std::string> processTestQueueWithModel(std::optional<ModelType> model);
+    // Query queue state (tests waiting for a worker)
     size_t getQueueSize() const;
-    std::vector<std::string> getQueuedPatientIds() const;
+    std::vector<std::string> getQueuedPatientIds() const; // In dispatch order
+    TestQueueStats getQueueStats(TestPriority priority) const;
     
-    // Diagnosis
-    enum class ModelType { LOGISTIC, KNN, DECISION_TREE, NAIVE_BAYES };
-    double diagnosePatient(const Patient& patient, ModelType model);
-    int predictPatient(const Patient& patient, ModelType model);
+    // Diagnosis. These take the state lock shared only to read the patient's
+    // genetic data; the models run outside it on the current model set, so
+    // a concurrent reload never blocks or disturbs them. Don't call them
+    // from a visitor.
+    double diagnosePatient(const Patient& patient, ModelType model) const;
+    int predictPatient(const Patient& patient, ModelType model) const;
+    // Diagnose a stored patient without copying it; std::nullopt if unknown.
+    // Unlike a scheduled test, the result is not recorded on the patient.
+    // Scores are cached until the patient, the gene table it draws on, or
+    // the models change.
+    std::optional<DiagnosisResult> diagnoseStoredPatient(std::string_view patientId, ModelType model) const;
+    // Diagnose many patients with several models at once: features of all
+    // of them go into one matrix under a single shared lock, and each model
+    // then scores the whole matrix. Stored patients are looked up by ID
+    // (unknown IDs give results with found == false); inline patients are
+    // scored as given and not stored. Results are patient-major, stored
+    // patients first: one per model for each patient in turn.
+    std::vector<DiagnosisResult> diagnoseBatch(std::span<const std::string> patientIds, 
+                                               std::span<const Patient> patients, 
+                                               std::span<const ModelType> modelTypes) const;
+    static const char* modelName(ModelType model); // As accepted by the API, e.g. "knn"
+    DiagnosisCache::Stats getDiagnosisCacheStats() const;
     
     // Evaluation
     void evaluateModels(const std::vector<Patient>& testPatients);
@@ -104,14 +337,128 @@ public:
     size_t getGeneticDataCount() const;
     size_t getPatientCount() const;
     bool areModelsTrained() const;
+    // Changes whenever anything a read returns may have changed. Read it
+    // before reading the data, so a version never labels older data.
+    uint64_t getDataVersion() const;
     bool getPatientById(const std::string& patientId, Patient& outPatient) const;
     
-    // Data export
+    // Read access without copying. The visitor runs under the shared state
+    // lock: it must not call methods that take the lock or keep the
+    // references it is given. Visitors on different threads run concurrently.
+    template <typename Visitor> void forEachPatient(Visitor&& visit) const; // Most recent first
+    // One page of forEachPatient: at most `limit` patients stored before
+    // position `before` (all of them for SIZE_MAX). Returns the position
+    // the next page starts from, or 0 after the oldest patient. Positions
+    // do not move as patients are added or replaced, so paging neither
+    // repeats nor skips records until the next load.
+    template <typename Visitor> size_t forEachPatientBefore(size_t before, size_t limit, Visitor&& visit) const;
+    template <typename Visitor> void forEachGeneticData(Visitor&& visit) const;
+    // At most `limit` genetic records from row `start`; returns the row after
+    // the last one visited (fewer than `limit` visited means the end was
+    // reached). Rows are only appended, so positions are stable until the
+    // next load.
+    template <typename Visitor> size_t forEachGeneticDataFrom(size_t start, size_t limit, Visitor&& visit) const;
+    // The whole genetic table at once, for column-wise readers
+    template <typename Visitor> void visitGeneticTable(Visitor&& visit) const;
+    // The gene ID to mutation score map built from the table
+    template <typename Visitor> void visitMutationMapper(Visitor&& visit) const;
+    // Returns false (without calling the visitor) if no patient has this ID
+    template <typename Visitor> bool visitPatient(std::string_view patientId, Visitor&& visit) const;
+    
+    // Data export (copies; prefer the visitors above on hot paths)
     std::vector<Patient> getAllPatients() const;
     std::vector<GeneticData> getAllGeneticData() const;
-    void saveDataToFiles(const std::string& genesFile, const std::string& patientsFile) const;
+    void saveDataToFiles(const std::string& genesFile, const std::string& patientsFile);
+    
+    // Write-ahead logging: additions are appended to the log instead of
+    // rewriting the base files, and replayed on top of them when loading
+    bool enableWriteAheadLog(const std::string& logFile, const std::string& genesFile, 
+                             const std::string& patientsFile, WriteAheadLog::FsyncPolicy policy);
+    bool syncWriteAheadLog(); // Wait until logged additions are durable
+    uint64_t getWriteAheadLogSize() const;
+    
+    // Flush changes to the CSV files from a background thread, at most once per
+    // interval; mutations only mark the system dirty. With a write-ahead log,
+    // changes are already durable, so a flush only folds the log into the CSV
+    // files once it reaches kLogFoldBytes or kLogFoldAge. If a snapshot file
+    // is given it is rewritten whenever the CSVs are, so it keeps matching them.
+    // Flushes never hold the state lock exclusively or while writing files.
+    void enableBackgroundPersistence(const std::string& genesFile, const std::string& patientsFile, 
+                                     std::chrono::milliseconds interval, 
+                                     const std::string& snapshotFile = "");
+    
+    // Binary snapshots (.cds) of data, preprocessing parameters and trained models.
+    // loadSnapshot only succeeds if the snapshot was built from the given CSV
+    // files and neither has changed since. A snapshot never includes changes
+    // still in the write-ahead log (loading replays the log on top), so
+    // saveSnapshot folds the log first if it holds any.
+    bool saveSnapshot(const std::string& snapshotFile);
+    bool loadSnapshot(const std::string& snapshotFile, const std::string& genesFile, 
+                      const std::string& patientsFile);
 };
 
+template <typename Visitor>
+void CancerDiagnosisSystem::forEachPatient(Visitor&& visit) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    for (auto it = patientHistory.rbegin(); it != patientHistory.rend(); ++it) {
+        visit(*it);
+    }
+}
+
+template <typename Visitor>
+size_t CancerDiagnosisSystem::forEachPatientBefore(size_t before, size_t limit, Visitor&& visit) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    size_t end = std::min(before, patientHistory.size());
+    size_t stop = end > limit ? end - limit : 0;
+    for (size_t position = end; position > stop; --position) {
+        visit(*(patientHistory.begin() + (position - 1)));
+    }
+    return stop;
+}
+
+template <typename Visitor>
+void CancerDiagnosisSystem::forEachGeneticData(Visitor&& visit) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    for (size_t i = 0; i < geneticData.size(); ++i) {
+        visit(geneticData.getRow(i));
+    }
+}
+
+template <typename Visitor>
+size_t CancerDiagnosisSystem::forEachGeneticDataFrom(size_t start, size_t limit, Visitor&& visit) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    // start + limit would overflow for limit = SIZE_MAX
+    size_t size = geneticData.size();
+    size_t end = start >= size ? start : (limit > size - start ? size : start + limit);
+    for (size_t i = start; i < end; ++i) {
+        visit(geneticData.getRow(i));
+    }
+    return end;
+}
+
+template <typename Visitor>
+void CancerDiagnosisSystem::visitGeneticTable(Visitor&& visit) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    visit(static_cast<const GeneticDataTable&>(geneticData));
+}
+
+template <typename Visitor>
+void CancerDiagnosisSystem::visitMutationMapper(Visitor&& visit) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    visit(static_cast<const HashMapper&>(mutationMapper));
+}
+
+template <typename Visitor>
+bool CancerDiagnosisSystem::visitPatient(std::string_view patientId, Visitor&& visit) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    const Patient* patient = patientHistory.find(patientId);
+    if (!patient) {
+        return false;
+    }
+    visit(*patient);
+    return true;
+}
+
 #endif // CANCER_DIAGNOSIS_SYSTEM_H
 
 
@@ -0,0 +1,39 @@
+#ifndef CSV_SCANNER_H
+#define CSV_SCANNER_H
+
+#include <string_view>
+#include <cstddef>
+
+/**
+ * @class CsvScanner
+ * @brief Allocation-free line and field scanner over an in-memory CSV buffer
+ *
+ * All returned views point into the scanned buffer.
+ */
+class CsvScanner {
+private:
+    std::string_view data;
+    size_t position;
+    size_t lineNumber;
+
+public:
+    explicit CsvScanner(std::string_view data, size_t startOffset = 0);
+
+    // Advance to the next line (without its line terminator); false at end of buffer
+    bool nextLine(std::string_view& line);
+
+    // Byte offset just past the last line returned
+    size_t offset() const;
+    // 1-based number of the last line returned
+    size_t getLineNumber() const;
+
+    // Split the first `count` comma-separated fields of a line
+    static bool splitFields(std::string_view line, std::string_view* fields, size_t count);
+
+    // Numeric field parsing (surrounding whitespace is ignored)
+    static std::string_view trim(std::string_view field);
+    static bool parseDouble(std::string_view field, double& out);
+    static bool parseInt(std::string_view field, int& out);
+};
+
+#endif // CSV_SCANNER_H
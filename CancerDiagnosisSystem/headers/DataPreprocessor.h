@@ -3,6 +3,10 @@
 
 #include <vector>
 #include <string>
+#include <span>
+
+class SnapshotWriter;
+class SnapshotReader;
 
 /**
  * @class DataPreprocessor
@@ -20,19 +24,25 @@ public:
     DataPreprocessor();
     
     // Fit preprocessing parameters on training data
-    void fit(const std::vector<double>& data);
+    void fit(std::span<const double> data);
     
     // Transform data using fitted parameters
-    std::vector<double> normalize(const std::vector<double>& data) const;
-    std::vector<double> minMaxScale(const std::vector<double>& data) const;
-    std::vector<double> standardize(const std::vector<double>& data) const;
+    std::vector<double> normalize(std::span<const double> data) const;
+    std::vector<double> minMaxScale(std::span<const double> data) const;
+    std::vector<double> standardize(std::span<const double> data) const;
+    // Standardize into a caller-provided buffer of the same size
+    void standardize(std::span<const double> data, std::span<double> out) const;
     
     // Fit and transform in one step
-    std::vector<double> fitTransform(const std::vector<double>& data);
+    std::vector<double> fitTransform(std::span<const double> data);
     
     // Utility
     bool getIsFitted() const;
     void reset();
+    
+    // Persistence
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader);
 };
 
 #endif // DATA_PREPROCESSOR_H
@@ -1,8 +1,13 @@
 #ifndef DECISION_TREE_CLASSIFIER_H
 #define DECISION_TREE_CLASSIFIER_H
 
+#include "FeatureMatrix.h"
 #include <vector>
 #include <memory>
+#include <span>
+
+class SnapshotWriter;
+class SnapshotReader;
 
 /**
  * @struct TreeNode
@@ -29,31 +34,36 @@ private:
     int maxDepth;
     int minSamplesSplit;
     
-    // Helper functions
-    double calculateGini(const std::vector<std::vector<double>>& X, 
-                        const std::vector<int>& y) const;
-    std::pair<int, double> findBestSplit(const std::vector<std::vector<double>>& X, 
-                                        const std::vector<int>& y) const;
-    int predictSample(const std::vector<double>& sample, 
-                     std::shared_ptr<TreeNode> node) const;
-    std::shared_ptr<TreeNode> buildTree(const std::vector<std::vector<double>>& X, 
-                                       const std::vector<int>& y, 
-                                       int depth) const;
-    int getMajorityClass(const std::vector<int>& y) const;
+    // Helper functions. Training works on a span of row indices into X and y,
+    // which buildTree partitions in place instead of copying rows per node.
+    double calculateGini(std::span<const size_t> classCounts, size_t total) const;
+    std::pair<int, double> findBestSplit(const FeatureMatrix& X, std::span<const int> y, 
+                                        std::span<const size_t> rows) const;
+    int predictSample(std::span<const double> sample, 
+                     const std::shared_ptr<TreeNode>& node) const;
+    std::shared_ptr<TreeNode> buildTree(const FeatureMatrix& X, std::span<const int> y, 
+                                       std::span<size_t> rows, int depth) const;
+    int getMajorityClass(std::span<const int> y, std::span<const size_t> rows) const;
+    void saveNode(SnapshotWriter& writer, const std::shared_ptr<TreeNode>& node) const;
+    std::shared_ptr<TreeNode> loadNode(SnapshotReader& reader, int depth);
     
 public:
     DecisionTreeClassifier(int maxDepth = 10, int minSamplesSplit = 2);
     
     // Training and prediction
-    void fit(const std::vector<std::vector<double>>& X, const std::vector<int>& y);
-    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
-    int predictSingle(const std::vector<double>& sample) const;
+    void fit(const FeatureMatrix& X, std::span<const int> y);
+    std::vector<int> predict(const FeatureMatrix& X) const;
+    int predictSingle(std::span<const double> sample) const;
     
     // Utility
     void setMaxDepth(int depth);
     void setMinSamplesSplit(int samples);
     void displayTree(std::shared_ptr<TreeNode> node, int depth = 0) const;
     std::shared_ptr<TreeNode> getRoot() const;
+    
+    // Persistence
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader);
 };
 
 #endif // DECISION_TREE_CLASSIFIER_H
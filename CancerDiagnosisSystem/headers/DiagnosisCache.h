@@ -0,0 +1,79 @@
+#ifndef DIAGNOSIS_CACHE_H
+#define DIAGNOSIS_CACHE_H
+
+#include "StringInterner.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class DiagnosisCache
+ * @brief Bounded LRU cache of diagnosis risk scores, sharded by patient
+ *
+ * There is one slot per patient and model. Each slot holds the score
+ * together with the versions it was computed from: the patient record's
+ * revision, the version of the gene table the features were drawn from
+ * (if they depend on it) and the trained model set. A lookup with any
+ * other versions misses and the next store overwrites the slot, so
+ * changes to the data or models need no explicit invalidation.
+ *
+ * Patients are spread over shards, each with its own lock and recency
+ * list; when a shard is full its least recently used slot is dropped.
+ */
+class DiagnosisCache {
+public:
+    struct Key {
+        Symbol patientId;
+        uint32_t modelId;
+        uint64_t patientRevision; // PatientStore::revisionOf
+        uint64_t tableVersion;    // 0 if the features do not depend on the gene table
+        uint64_t modelVersion;
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        size_t entries;
+        size_t capacity;
+    };
+
+private:
+    struct Slot {
+        Key key;
+        double riskScore;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Slot> recency; // Most recently used first
+        std::unordered_map<uint64_t, std::list<Slot>::iterator> slots; // By patient and model
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shardCapacity;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+    static uint64_t slotKey(const Key& key) {
+        return (static_cast<uint64_t>(key.patientId.id()) << 32) | key.modelId;
+    }
+    Shard& shardFor(const Key& key) const;
+
+public:
+    // Holds at most `capacity` scores (rounded up to a multiple of shardCount)
+    explicit DiagnosisCache(size_t capacity, size_t shardCount = 16);
+
+    // False (a miss) unless the slot was stored with exactly these versions
+    bool find(const Key& key, double& riskScore);
+    void store(const Key& key, double riskScore);
+    void clear();
+
+    Stats getStats() const;
+};
+
+#endif // DIAGNOSIS_CACHE_H
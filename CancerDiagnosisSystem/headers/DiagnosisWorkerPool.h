@@ -0,0 +1,43 @@
+#ifndef DIAGNOSIS_WORKER_POOL_H
+#define DIAGNOSIS_WORKER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ * @class DiagnosisWorkerPool
+ * @brief Worker threads that keep running a task function while it finds work
+ *
+ * The task function processes one queued item and returns false when there
+ * was nothing to do; the worker then sleeps until notify(). notify() only
+ * bumps an atomic counter and wakes one sleeper, so it adds no lock to
+ * queueing; whether queueing itself blocks is up to the queue.
+ */
+class DiagnosisWorkerPool {
+private:
+    std::function<bool()> processNext;
+    std::atomic<uint64_t> signal; // Bumped on every notify()
+    std::atomic<bool> stopping;
+    std::vector<std::thread> workers;
+
+    void run();
+
+public:
+    DiagnosisWorkerPool(size_t workerCount, std::function<bool()> processNext);
+    ~DiagnosisWorkerPool();
+
+    DiagnosisWorkerPool(const DiagnosisWorkerPool&) = delete;
+    DiagnosisWorkerPool& operator=(const DiagnosisWorkerPool&) = delete;
+
+    // Call after queueing an item
+    void notify();
+    // Finish the items in progress and join the workers; queued items are left
+    void stop();
+
+    size_t getWorkerCount() const { return workers.size(); }
+};
+
+#endif // DIAGNOSIS_WORKER_POOL_H
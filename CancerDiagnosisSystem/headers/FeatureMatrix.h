@@ -0,0 +1,38 @@
+#ifndef FEATURE_MATRIX_H
+#define FEATURE_MATRIX_H
+
+#include <span>
+#include <cstddef>
+
+/**
+ * @class FeatureMatrix
+ * @brief Non-owning row-major view of model input features
+ *
+ * The values belong to the caller and must outlive the view. A single
+ * feature column (one value per sample) is already a valid n x 1 matrix,
+ * so columnar data can be passed to the models without copying.
+ */
+class FeatureMatrix {
+private:
+    std::span<const double> values;
+    size_t columns;
+
+public:
+    FeatureMatrix() : columns(0) {}
+    FeatureMatrix(std::span<const double> values, size_t columns)
+        : values(values), columns(columns) {}
+
+    size_t rows() const { return columns == 0 ? 0 : values.size() / columns; }
+    size_t cols() const { return columns; }
+    bool empty() const { return rows() == 0; }
+
+    std::span<const double> row(size_t index) const {
+        return values.subspan(index * columns, columns);
+    }
+    double at(size_t rowIndex, size_t column) const {
+        return values[rowIndex * columns + column];
+    }
+    std::span<const double> data() const { return values; }
+};
+
+#endif // FEATURE_MATRIX_H
@@ -0,0 +1,42 @@
+#ifndef GENETIC_COLUMN_ENCODER_H
+#define GENETIC_COLUMN_ENCODER_H
+
+#include "GeneticDataTable.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @struct GeneticColumnsHeader
+ * @brief Fixed-size header at the start of an encoded genetic table
+ */
+struct GeneticColumnsHeader {
+    char magic[4];           // "CDSG"
+    uint32_t version;
+    uint64_t rowCount;
+    uint32_t dictionarySize; // Distinct gene IDs
+    uint32_t reserved;       // Zero
+};
+
+/**
+ * @class GeneticColumnEncoder
+ * @brief Compact columnar binary encoding of a GeneticDataTable
+ *
+ * Layout (little-endian, as the snapshot files), after the header:
+ *   - the gene ID dictionary: per distinct ID, a uint32 byte length and
+ *     the bytes, in order of first appearance
+ *   - uint32 gene index per row (into the dictionary)
+ *   - double mutation score per row
+ *   - int32 label per row
+ * Each column starts on an 8-byte boundary (zero padding), so a reader
+ * can use the columns in place. Repeated gene IDs are sent once.
+ */
+class GeneticColumnEncoder {
+public:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr const char* kContentType = "application/vnd.cds.genetic-columns";
+
+    // Replaces the contents of `out`
+    static void encode(const GeneticDataTable& table, std::string& out);
+};
+
+#endif // GENETIC_COLUMN_ENCODER_H
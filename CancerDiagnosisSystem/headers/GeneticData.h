@@ -1,7 +1,9 @@
 #ifndef GENETIC_DATA_H
 #define GENETIC_DATA_H
 
+#include "StringInterner.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -10,22 +12,24 @@
  */
 class GeneticData {
 private:
-    std::string geneId;
+    Symbol geneId; // Interned; shared by every copy of this gene's records
     double mutationScore;
     int label; // 0 = non-cancerous, 1 = cancerous
     
 public:
     // Constructors
     GeneticData();
-    GeneticData(const std::string& id, double score, int lbl);
+    GeneticData(std::string_view id, double score, int lbl);
+    GeneticData(Symbol id, double score, int lbl);
     
     // Getters
-    std::string getGeneId() const;
+    const std::string& getGeneId() const;
+    Symbol getGeneSymbol() const;
     double getMutationScore() const;
     int getLabel() const;
     
     // Setters
-    void setGeneId(const std::string& id);
+    void setGeneId(std::string_view id);
     void setMutationScore(double score);
     void setLabel(int lbl);
     
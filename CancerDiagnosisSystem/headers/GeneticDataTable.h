@@ -0,0 +1,101 @@
+#ifndef GENETIC_DATA_TABLE_H
+#define GENETIC_DATA_TABLE_H
+
+#include "GeneticData.h"
+#include "StringInterner.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+/**
+ * @class GeneticDataTable
+ * @brief Column-oriented store of genetic records
+ *
+ * Gene IDs, mutation scores and labels are kept in separate contiguous
+ * columns, so training can read the scores and labels as spans instead of
+ * walking an array of records.
+ */
+class GeneticDataTable {
+private:
+    std::vector<Symbol> geneIds;
+    std::vector<double> mutationScores;
+    std::vector<int> labels;
+
+public:
+    // Returns the index of the new row
+    size_t append(Symbol geneId, double mutationScore, int label);
+    size_t append(const GeneticData& data);
+
+    // Single rows
+    Symbol getGeneId(size_t index) const { return geneIds[index]; }
+    double getMutationScore(size_t index) const { return mutationScores[index]; }
+    int getLabel(size_t index) const { return labels[index]; }
+    GeneticData getRow(size_t index) const;
+
+    // Whole columns
+    std::span<const Symbol> geneIdColumn() const { return geneIds; }
+    std::span<const double> mutationScoreColumn() const { return mutationScores; }
+    std::span<const int> labelColumn() const { return labels; }
+
+    size_t size() const { return mutationScores.size(); }
+    bool empty() const { return mutationScores.empty(); }
+    void reserve(size_t count);
+    void clear();
+};
+
+/**
+ * @class GeneticDataView
+ * @brief Read-only sequence of genetic records, either owned records or
+ * rows of a GeneticDataTable
+ *
+ * Rows are resolved on access, so elements are returned by value. The view
+ * is invalidated by changes to whatever it refers to.
+ */
+class GeneticDataView {
+private:
+    const GeneticDataTable* table;
+    std::span<const uint32_t> rows;
+    std::span<const GeneticData> records;
+
+public:
+    class iterator {
+    private:
+        const GeneticDataView* view;
+        size_t index;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = GeneticData;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = GeneticData;
+
+        iterator(const GeneticDataView* view, size_t index) : view(view), index(index) {}
+        GeneticData operator*() const { return (*view)[index]; }
+        iterator& operator++() { ++index; return *this; }
+        bool operator==(const iterator& other) const { return index == other.index; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+    };
+
+    GeneticDataView(std::span<const GeneticData> records)
+        : table(nullptr), records(records) {}
+    GeneticDataView(const GeneticDataTable& table, std::span<const uint32_t> rows)
+        : table(&table), rows(rows) {}
+
+    size_t size() const { return table ? rows.size() : records.size(); }
+    bool empty() const { return size() == 0; }
+
+    GeneticData operator[](size_t index) const {
+        return table ? table->getRow(rows[index]) : records[index];
+    }
+    double getMutationScore(size_t index) const {
+        return table ? table->getMutationScore(rows[index]) : records[index].getMutationScore();
+    }
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, size()); }
+};
+
+#endif // GENETIC_DATA_TABLE_H
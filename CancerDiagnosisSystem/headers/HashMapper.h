@@ -1,40 +1,72 @@
 #ifndef HASH_MAPPER_H
 #define HASH_MAPPER_H
 
+#include "StringInterner.h"
 #include <map>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstdint>
 
 /**
  * @class HashMapper
  * @brief Maps genetic mutation patterns to risk scores using hash maps
+ *
+ * Mutations are keyed by their interned Symbol in an open-addressing table
+ * with linear probing. Each mutation gets a dense MutationId; table slots
+ * hold only the symbol and that ID, so probes compare integers and never
+ * touch the mutation strings.
  */
 class HashMapper {
+public:
+    using MutationId = uint32_t;
+    static constexpr MutationId kNoMutation = UINT32_MAX;
+
 private:
-    std::map<std::string, double> mutationToRiskMap;
+    struct Slot {
+        Symbol mutation;
+        MutationId id;      // kNoMutation when empty
+    };
+
+    std::vector<Slot> slots;                // Power-of-two sized
+    std::vector<Symbol> mutationKeys;       // Indexed by MutationId
+    std::vector<double> mutationRiskScores; // Indexed by MutationId
+
     std::map<int, std::string> labelToCategoryMap;
-    
+
+    MutationId find(Symbol mutation) const;
+    void insertSlot(MutationId id);
+    void rehash(size_t slotCount);
+
 public:
     HashMapper();
-    
+
     // Mutation mapping
-    void addMutationMapping(const std::string& mutation, double riskScore);
-    double getRiskScore(const std::string& mutation) const;
-    bool hasMutation(const std::string& mutation) const;
-    
+    MutationId addMutationMapping(Symbol mutation, double riskScore);
+    MutationId addMutationMapping(std::string_view mutation, double riskScore);
+    double getRiskScore(std::string_view mutation) const;
+    bool hasMutation(std::string_view mutation) const;
+
+    // Resolve a mutation once and look it up by ID afterwards
+    MutationId getMutationId(Symbol mutation) const;
+    MutationId getMutationId(std::string_view mutation) const;
+    double getRiskScore(MutationId id) const;
+    // out[i] = risk score of ids[i] (0.0 for unknown IDs); sizes must match
+    void getRiskScores(std::span<const MutationId> ids, std::span<double> out) const;
+
     // Label mapping
     void setLabelCategory(int label, const std::string& category);
     std::string getCategory(int label) const;
-    
+
     // Bulk operations
-    void buildMutationMap(const std::vector<std::string>& mutations, 
+    void buildMutationMap(const std::vector<std::string>& mutations,
                          const std::vector<double>& riskScores);
-    
+    void reserve(size_t mutationCount);
+
     // Utility
     void displayMappings() const;
     size_t size() const;
 };
 
 #endif // HASH_MAPPER_H
-
-
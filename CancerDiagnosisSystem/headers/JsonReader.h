@@ -0,0 +1,132 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+/**
+ * @class JsonReader
+ * @brief Single-pass streaming JSON reader over an in-memory buffer
+ *
+ * Values are consumed in document order, one at a time, without building
+ * a tree: callers read the value they expect next, or walk objects and
+ * arrays with callbacks that receive each member key or element in turn
+ * and read (or skip) its value. Strings without escapes are returned as
+ * views into the buffer; only escaped strings are decoded into a scratch
+ * string. Every byte is looked at once, so parsing is linear in the input.
+ *
+ * The first error stops the reader: every later read fails, and
+ * getError() describes the problem and where it was found.
+ */
+class JsonReader {
+public:
+    enum class Type { NONE, OBJECT, ARRAY, STRING, NUMBER, BOOLEAN, NULL_VALUE };
+
+    // Deeper nesting is rejected rather than risking the stack
+    static constexpr size_t kMaxDepth = 64;
+
+private:
+    std::string_view text;
+    size_t position;
+    size_t depth;
+    std::string error;
+    std::string keyScratch; // Decoded keys that had escapes
+
+    void skipWhitespace();
+    bool fail(const char* message);
+    bool consume(char expected);
+    bool consumeLiteral(std::string_view literal);
+    // Raw string contents between the quotes; `escaped` if they need decoding
+    bool scanString(std::string_view& raw, bool& escaped);
+    bool scanNumber(std::string_view& literal);
+    bool enter();
+    bool readKey(std::string_view& key);
+    // At the start (`first`) or after a member or element: consume the
+    // closing bracket (done) or the separating comma
+    bool nextInContainer(char close, bool first, bool& done);
+
+public:
+    explicit JsonReader(std::string_view text);
+
+    // Type of the next value (after whitespace); NONE at end of input or on error
+    Type peek();
+
+    // Typed reads of the next value. Each fails (and stops the reader) if
+    // the value has another type.
+    bool readString(std::string_view& out, std::string& scratch); // View into the buffer, or into `scratch`
+    bool readString(std::string& out);
+    // A JSON number, or a string holding a finite one (as some clients send)
+    bool readNumber(double& out);
+    bool readInt(int& out); // As readNumber, but the value must be a whole number that fits
+    bool readBool(bool& out);
+    bool readNull();
+    bool skipValue();
+
+    // Walk an object: onMember(std::string_view key) is called for each
+    // member and must consume its value; returning false fails the read.
+    // The key view is only valid until the next read.
+    template <typename MemberFn> bool readObject(MemberFn&& onMember);
+    // Walk an array: onElement() is called for each element and must
+    // consume it; returning false fails the read.
+    template <typename ElementFn> bool readArray(ElementFn&& onElement);
+
+    // True if only whitespace remains after the values read so far
+    bool finish();
+
+    bool ok() const { return error.empty(); }
+    // Empty while ok(); otherwise includes the byte offset of the problem
+    const std::string& getError() const { return error; }
+
+    // Decode the raw contents of a string literal (escapes, including
+    // \u surrogate pairs, become UTF-8); false on an invalid escape
+    static bool unescape(std::string_view raw, std::string& out);
+};
+
+template <typename MemberFn>
+bool JsonReader::readObject(MemberFn&& onMember) {
+    if (!consume('{') || !enter()) {
+        return false;
+    }
+    bool done = false;
+    if (!nextInContainer('}', true, done)) {
+        return false;
+    }
+    while (!done) {
+        std::string_view key;
+        if (!readKey(key)) {
+            return false;
+        }
+        if (!onMember(key)) {
+            return fail("Unexpected value for object member");
+        }
+        if (!nextInContainer('}', false, done)) {
+            return false;
+        }
+    }
+    depth--;
+    return true;
+}
+
+template <typename ElementFn>
+bool JsonReader::readArray(ElementFn&& onElement) {
+    if (!consume('[') || !enter()) {
+        return false;
+    }
+    bool done = false;
+    if (!nextInContainer(']', true, done)) {
+        return false;
+    }
+    while (!done) {
+        if (!onElement()) {
+            return fail("Unexpected array element");
+        }
+        if (!nextInContainer(']', false, done)) {
+            return false;
+        }
+    }
+    depth--;
+    return true;
+}
+
+#endif // JSON_READER_H
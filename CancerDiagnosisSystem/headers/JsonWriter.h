@@ -0,0 +1,66 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class JsonWriter
+ * @brief Appends JSON text to a reusable buffer
+ *
+ * Values are written in document order; commas between members and
+ * elements are inserted automatically. Numbers are formatted with
+ * std::to_chars (doubles in their shortest round-trip form, non-finite
+ * ones as null) and strings are escaped in runs, so writing does not go
+ * through iostreams or allocate beyond the buffer. The caller takes the
+ * text with str(), or streams a large document piece by piece: send
+ * view(), then clearText() and keep writing into the same capacity.
+ */
+class JsonWriter {
+private:
+    std::string buffer;
+    std::vector<bool> hasValue; // Per open container: something written already
+    bool afterKey;
+
+    void separate(); // Comma before the next member or element, if needed
+
+public:
+    JsonWriter();
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(int number);
+    JsonWriter& value(int64_t number);
+    JsonWriter& value(uint64_t number);
+    JsonWriter& value(double number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+    // Line break after a top-level value, for newline-delimited JSON
+    JsonWriter& newline() { buffer.push_back('\n'); return *this; }
+
+    // Members in one call: key(name).value(v)
+    template <typename T> JsonWriter& member(std::string_view name, const T& v) {
+        return key(name).value(v);
+    }
+
+    const std::string& str() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+    void reserve(size_t bytes) { buffer.reserve(bytes); }
+    std::string_view view() const { return buffer; }
+    // Drop the text written so far but keep the nesting state, so writing
+    // continues where the sent text left off
+    void clearText() { buffer.clear(); }
+
+    // Append `text` escaped for use inside a JSON string (no quotes)
+    static void appendEscaped(std::string& out, std::string_view text);
+};
+
+#endif // JSON_WRITER_H
@@ -1,40 +1,50 @@
 #ifndef KNN_CLASSIFIER_H
 #define KNN_CLASSIFIER_H
 
+#include "FeatureMatrix.h"
 #include <vector>
+#include <span>
 #include <utility>
 #include <algorithm>
 
+class SnapshotWriter;
+class SnapshotReader;
+
 /**
  * @class KNNClassifier
  * @brief Implements K-Nearest Neighbors algorithm for classification
  */
 class KNNClassifier {
 private:
-    std::vector<std::vector<double>> X_train;
+    std::vector<double> X_train; // Row-major, featureCount values per sample
     std::vector<int> y_train;
+    size_t featureCount;
     int k;
     bool isTrained;
     
     // Helper functions
-    double euclideanDistance(const std::vector<double>& a, 
-                            const std::vector<double>& b) const;
+    double euclideanDistance(std::span<const double> a, std::span<const double> b) const;
     int majorityVote(const std::vector<std::pair<double, int>>& neighbors) const;
-    std::vector<std::pair<double, int>> findKNearest(const std::vector<double>& sample) const;
+    std::vector<std::pair<double, int>> findKNearest(std::span<const double> sample) const;
     
 public:
     KNNClassifier(int k = 5);
     
     // Training and prediction
-    void fit(const std::vector<std::vector<double>>& X, const std::vector<int>& y);
-    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
-    int predictSingle(const std::vector<double>& sample) const;
-    std::vector<double> predictProbability(const std::vector<std::vector<double>>& X) const;
+    void fit(const FeatureMatrix& X, std::span<const int> y);
+    std::vector<int> predict(const FeatureMatrix& X) const;
+    int predictSingle(std::span<const double> sample) const;
+    std::vector<double> predictProbability(const FeatureMatrix& X) const;
+    double predictProbabilitySingle(std::span<const double> sample) const;
     
     // Parameters
     void setK(int k);
     int getK() const;
     bool getIsTrained() const;
+    
+    // Persistence
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader);
 };
 
 #endif // KNN_CLASSIFIER_H
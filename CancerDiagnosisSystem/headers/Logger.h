@@ -0,0 +1,192 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : uint8_t { DEBUG, INFO, WARN, ERROR, OFF };
+
+// Levels below this are compiled out of CDS_LOG_* statements entirely
+// (0 = DEBUG ... 3 = ERROR); set it with -DCDS_MIN_LOG_LEVEL=0 to keep debug logging
+#ifndef CDS_MIN_LOG_LEVEL
+#define CDS_MIN_LOG_LEVEL 1
+#endif
+
+/**
+ * @class Logger
+ * @brief Process-wide asynchronous logger writing timestamped lines to stderr
+ *
+ * Each thread that logs gets its own fixed-size ring of messages, which
+ * only that thread writes and only the drain thread reads, so logging
+ * takes no lock and makes no system call: formatting a message and
+ * copying it into the ring is all the caller pays. The drain thread
+ * writes whatever the rings hold in one batch every few milliseconds.
+ * When a ring is full, new messages are dropped and counted rather than
+ * making the caller wait; the count is reported with the next batch.
+ *
+ * Lines look like:
+ *   2026-01-31T09:15:02.417Z INFO  [t3] Loaded 150 genetic records from data/genes.csv
+ *
+ * Use the CDS_LOG_* macros, which skip formatting when the level is off.
+ */
+class Logger {
+public:
+    static constexpr size_t kMaxMessageLength = 238;
+
+private:
+    struct Record {
+        int64_t timeNanos; // Since the Unix epoch
+        LogLevel level;
+        uint8_t truncated;
+        uint16_t length;
+        char text[kMaxMessageLength];
+    };
+
+    // Single-producer, single-consumer
+    struct Ring {
+        static constexpr size_t kCapacity = 256;
+        Record records[kCapacity];
+        alignas(64) std::atomic<uint64_t> head{0}; // Next to drain
+        alignas(64) std::atomic<uint64_t> tail{0}; // Next to fill
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false}; // Its thread has exited
+        uint32_t threadNumber = 0;
+    };
+
+    // Registers the calling thread's ring on first use and retires it when the thread exits
+    struct ThreadRing {
+        Ring* ring = nullptr;
+        ~ThreadRing();
+    };
+
+    std::atomic<LogLevel> level;
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    uint32_t nextThreadNumber;
+
+    std::mutex drainMutex; // One drain at a time: the drain thread or flush()
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::thread drainThread;
+
+    Logger();
+    Ring& threadRing();
+    void drainLoop();
+    void drain(); // Caller holds drainMutex
+
+public:
+    static Logger& global();
+    ~Logger(); // Drains everything still buffered
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void setLevel(LogLevel minimum) { level.store(minimum, std::memory_order_relaxed); }
+    bool enabled(LogLevel messageLevel) const { return messageLevel >= level.load(std::memory_order_relaxed); }
+
+    // Queue one message, truncated to kMaxMessageLength bytes (`truncated`
+    // if the caller already cut it short)
+    void log(LogLevel messageLevel, std::string_view message, bool truncated = false);
+    // Write out everything logged so far before returning
+    void flush();
+
+    // "debug", "info", "warn" or "error"; false (leaving `out` alone) otherwise
+    static bool parseLevel(std::string_view name, LogLevel& out);
+};
+
+/**
+ * @class LogLine
+ * @brief Formats one message in a stack buffer and logs it when destroyed
+ */
+class LogLine {
+private:
+    LogLevel level;
+    size_t length;
+    bool truncated;
+    char text[Logger::kMaxMessageLength];
+
+    void append(std::string_view part);
+
+public:
+    explicit LogLine(LogLevel level) : level(level), length(0), truncated(false) {}
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+    ~LogLine();
+
+    LogLine& operator<<(std::string_view part) { append(part); return *this; }
+    LogLine& operator<<(const char* part) { append(part); return *this; }
+    LogLine& operator<<(const std::string& part) { append(part); return *this; }
+    LogLine& operator<<(char c) { append(std::string_view(&c, 1)); return *this; }
+    LogLine& operator<<(bool flag) { append(flag ? "true" : "false"); return *this; }
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    LogLine& operator<<(T number) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), number);
+        append(std::string_view(digits, result.ptr - digits));
+        return *this;
+    }
+};
+
+/**
+ * @class LogRateLimiter
+ * @brief Lets through at most a fixed number of messages per second
+ *
+ * For log statements inside loops: messages over the limit are counted
+ * and the count is reported with the next message let through.
+ */
+class LogRateLimiter {
+private:
+    uint32_t perSecond;
+    std::atomic<int64_t> windowStart; // Steady clock, in seconds
+    std::atomic<uint32_t> inWindow;
+    std::atomic<uint64_t> suppressed;
+
+public:
+    explicit LogRateLimiter(uint32_t perSecond) : perSecond(perSecond), windowStart(0), inWindow(0), suppressed(0) {}
+    // True if a message may be logged now; `suppressedBefore` is how many were dropped since the last one
+    bool allow(uint64_t& suppressedBefore);
+};
+
+#define CDS_LOG_AT(messageLevel, message)                                     \
+    do {                                                                      \
+        if (static_cast<int>(messageLevel) >= CDS_MIN_LOG_LEVEL &&            \
+            Logger::global().enabled(messageLevel)) {                         \
+            LogLine(messageLevel) << message;                                 \
+        }                                                                     \
+    } while (0)
+
+// At most `perSecond` messages from this statement per second
+#define CDS_LOG_LIMITED(messageLevel, perSecond, message)                     \
+    do {                                                                      \
+        if (static_cast<int>(messageLevel) >= CDS_MIN_LOG_LEVEL &&            \
+            Logger::global().enabled(messageLevel)) {                         \
+            static LogRateLimiter cdsLogLimiter(perSecond);                   \
+            uint64_t cdsLogSuppressed = 0;                                    \
+            if (cdsLogLimiter.allow(cdsLogSuppressed)) {                      \
+                LogLine cdsLogLine(messageLevel);                             \
+                cdsLogLine << message;                                        \
+                if (cdsLogSuppressed > 0) {                                   \
+                    cdsLogLine << " (" << cdsLogSuppressed << " similar messages suppressed)"; \
+                }                                                             \
+            }                                                                 \
+        }                                                                     \
+    } while (0)
+
+#define CDS_LOG_DEBUG(message) CDS_LOG_AT(LogLevel::DEBUG, message)
+#define CDS_LOG_INFO(message) CDS_LOG_AT(LogLevel::INFO, message)
+#define CDS_LOG_WARN(message) CDS_LOG_AT(LogLevel::WARN, message)
+#define CDS_LOG_ERROR(message) CDS_LOG_AT(LogLevel::ERROR, message)
+
+#endif // LOGGER_H
@@ -1,7 +1,12 @@
 #ifndef LOGISTIC_REGRESSION_MODEL_H
 #define LOGISTIC_REGRESSION_MODEL_H
 
+#include "FeatureMatrix.h"
 #include <vector>
+#include <span>
+
+class SnapshotWriter;
+class SnapshotReader;
 
 /**
  * @class LogisticRegressionModel
@@ -17,22 +22,20 @@ private:
     
     // Helper functions
     double sigmoid(double z) const;
-    double rawPredictProbability(const std::vector<double>& features) const;
-    double computeLoss(const std::vector<std::vector<double>>& X, 
-                      const std::vector<int>& y) const;
-    void gradientDescent(const std::vector<std::vector<double>>& X, 
-                        const std::vector<int>& y);
-    double predictProbability(const std::vector<double>& features) const;
+    double rawPredictProbability(std::span<const double> features) const;
+    double computeLoss(const FeatureMatrix& X, std::span<const int> y) const;
+    void gradientDescent(const FeatureMatrix& X, std::span<const int> y);
+    double predictProbability(std::span<const double> features) const;
     
 public:
     LogisticRegressionModel(double learningRate = 0.01, int maxIterations = 1000);
     
     // Training and prediction
-    void fit(const std::vector<std::vector<double>>& X, const std::vector<int>& y);
-    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
-    int predictSingle(const std::vector<double>& features) const;
-    std::vector<double> predictProbabilityBatch(const std::vector<std::vector<double>>& X) const;
-    double predictProbabilitySingle(const std::vector<double>& features) const;
+    void fit(const FeatureMatrix& X, std::span<const int> y);
+    std::vector<int> predict(const FeatureMatrix& X) const;
+    int predictSingle(std::span<const double> features) const;
+    std::vector<double> predictProbabilityBatch(const FeatureMatrix& X) const;
+    double predictProbabilitySingle(std::span<const double> features) const;
     
     // Parameters
     void setLearningRate(double rate);
@@ -40,6 +43,10 @@ public:
     std::vector<double> getWeights() const;
     double getBias() const;
     bool getIsTrained() const;
+    
+    // Persistence
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader);
 };
 
 #endif // LOGISTIC_REGRESSION_MODEL_H
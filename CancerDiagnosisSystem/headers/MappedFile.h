@@ -0,0 +1,43 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The mapping stays valid for the lifetime of the object, so string_views
+ * handed out by view() must not outlive it.
+ */
+class MappedFile {
+private:
+    const char* data;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the file; returns false if it cannot be opened or mapped
+    bool open(const std::string& filename);
+    void close();
+
+    // Accessors
+    bool isOpen() const;
+    std::string_view view() const;
+    size_t size() const;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,172 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Number of cells each counter and histogram is split into. Every thread
+// updates the cell it was assigned, so threads rarely share a cache line;
+// readers add the cells up.
+constexpr size_t kMetricStripes = 8;
+
+// Cell of the calling thread, assigned round robin on first use
+size_t metricStripe();
+
+/**
+ * @class Counter
+ * @brief Monotonic count, updated without locks
+ */
+class Counter {
+private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    Cell cells[kMetricStripes];
+
+public:
+    void increment(uint64_t amount = 1) {
+        cells[metricStripe()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+};
+
+/**
+ * @class Gauge
+ * @brief Last value set
+ */
+class Gauge {
+private:
+    std::atomic<double> current{0.0};
+
+public:
+    void set(double value) { current.store(value, std::memory_order_relaxed); }
+    double value() const { return current.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Distribution of durations in log-linear buckets, updated without locks
+ *
+ * Durations are counted in whole microseconds. Up to 8 us every value has
+ * its own bucket; above that each power of two is split into 8 equal
+ * buckets, so a bucket is at most 12.5% wide relative to its values (as
+ * in an HDR histogram with 3 significant bits). Durations from about 19
+ * hours up share the last bucket. Recording is two relaxed atomic adds on
+ * the calling thread's cell.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 8;
+    static constexpr size_t kMaxExponent = 35; // Highest power of two with its own buckets
+    static constexpr size_t kBucketCount = (kMaxExponent - 2) * kSubBuckets + kSubBuckets;
+
+    struct Snapshot {
+        std::vector<uint64_t> buckets; // kBucketCount counts
+        uint64_t count;
+        uint64_t sumNanos;
+    };
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> buckets[kBucketCount] = {};
+        std::atomic<uint64_t> sumNanos{0};
+    };
+    std::unique_ptr<Cell[]> cells;
+
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::nanoseconds elapsed);
+    Snapshot snapshot() const;
+
+    static size_t bucketFor(uint64_t micros);
+    // Smallest duration, in microseconds, that falls past the bucket
+    static uint64_t bucketLimitMicros(size_t bucket);
+};
+
+/**
+ * @class ScopedTimer
+ * @brief Measures its own lifetime into a histogram, or sets a gauge to it in seconds
+ */
+class ScopedTimer {
+private:
+    LatencyHistogram* histogram;
+    Gauge* gauge;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(LatencyHistogram& histogram)
+        : histogram(&histogram), gauge(nullptr), start(std::chrono::steady_clock::now()) {}
+    explicit ScopedTimer(Gauge& gauge)
+        : histogram(nullptr), gauge(&gauge), start(std::chrono::steady_clock::now()) {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer();
+};
+
+/**
+ * @class Metrics
+ * @brief Process-wide registry of metrics, rendered in the Prometheus text format
+ *
+ * A metric is a family name plus a label set such as
+ * `method="GET",route="/status"`. Registering returns the metric, which
+ * stays at the same address for the life of the process: callers look it
+ * up once and then update it directly, so the registry lock is never
+ * taken on a hot path. Registering the same name and labels again returns
+ * the existing metric.
+ *
+ * Values owned elsewhere are registered as callbacks, which are only run
+ * when the metrics are rendered.
+ */
+class Metrics {
+public:
+    enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+private:
+    struct Series {
+        std::string labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<LatencyHistogram> histogram;
+        std::function<double()> read; // For callbacks
+    };
+
+    struct Family {
+        std::string help;
+        Type type;
+        std::vector<std::unique_ptr<Series>> series; // In registration order
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, Family, std::less<>> families; // Rendered in name order
+
+    // Callers hold mutex
+    Series& findOrAdd(std::string_view name, std::string_view labels, std::string_view help, Type type);
+
+public:
+    static Metrics& global();
+
+    Counter& counter(std::string_view name, std::string_view labels, std::string_view help);
+    Gauge& gauge(std::string_view name, std::string_view labels, std::string_view help);
+    LatencyHistogram& histogram(std::string_view name, std::string_view labels, std::string_view help);
+    // `read` replaces any callback registered before under the same name and labels
+    void counter(std::string_view name, std::string_view labels, std::string_view help,
+                 std::function<double()> read);
+    void gauge(std::string_view name, std::string_view labels, std::string_view help,
+               std::function<double()> read);
+
+    // Text exposition format 0.0.4; histograms are reported in seconds
+    void render(std::string& out) const;
+    static constexpr const char* kContentType = "text/plain; version=0.0.4; charset=utf-8";
+};
+
+#endif // METRICS_H
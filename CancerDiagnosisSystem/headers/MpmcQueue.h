@@ -0,0 +1,138 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @class MpmcQueue
+ * @brief Bounded lock-free multi-producer multi-consumer FIFO queue
+ *
+ * A ring of slots, each with a sequence number that tells producers and
+ * consumers whether the slot is free for the current lap (D. Vyukov's
+ * bounded MPMC queue). tryPush and tryPop never block or allocate; they
+ * fail when the queue is full or empty. Capacity is rounded up to a power
+ * of two. Values must be small trivially copyable types.
+ */
+template <typename T>
+class MpmcQueue {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "Queue values must be trivially copyable");
+    static_assert(std::atomic<T>::is_always_lock_free, "Queue values must fit a lock-free atomic");
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        std::atomic<T> value;
+    };
+
+    // Keep the two hot counters on separate cache lines
+    static constexpr size_t kCacheLine = 64;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(kCacheLine) std::atomic<size_t> enqueuePosition;
+    alignas(kCacheLine) std::atomic<size_t> dequeuePosition;
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t capacity = 2;
+        while (capacity < value) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+public:
+    explicit MpmcQueue(size_t capacity)
+        : slots(new Slot[roundUpToPowerOfTwo(capacity)]),
+          mask(roundUpToPowerOfTwo(capacity) - 1),
+          enqueuePosition(0), dequeuePosition(0) {
+        for (size_t i = 0; i <= mask; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // Returns false if the queue is full
+    bool tryPush(const T& value) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (lag == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                          std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false; // Slot still holds a value from the previous lap
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value.store(value, std::memory_order_relaxed);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty
+    bool tryPop(T& value) {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (lag == 0) {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1,
+                                                          std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false; // Slot not yet filled for this lap
+            } else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        value = slot->value.load(std::memory_order_relaxed);
+        slot->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Visit queued values oldest first without removing them. Each visited
+    // value is intact, but under concurrent use the sequence as a whole is
+    // only a best-effort snapshot.
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        size_t position = dequeuePosition.load(std::memory_order_acquire);
+        size_t end = enqueuePosition.load(std::memory_order_acquire);
+        for (; position < end; ++position) {
+            const Slot& slot = slots[position & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+                continue; // Already consumed, or not yet published
+            }
+            T value = slot.value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == position + 1) {
+                visit(value);
+            }
+        }
+    }
+
+    // Approximate while producers or consumers are active
+    size_t size() const {
+        size_t end = enqueuePosition.load(std::memory_order_acquire);
+        size_t begin = dequeuePosition.load(std::memory_order_acquire);
+        return end > begin ? end - begin : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask + 1; }
+};
+
+#endif // MPMC_QUEUE_H
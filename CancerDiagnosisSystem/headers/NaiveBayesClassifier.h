@@ -1,10 +1,15 @@
 #ifndef NAIVE_BAYES_CLASSIFIER_H
 #define NAIVE_BAYES_CLASSIFIER_H
 
+#include "FeatureMatrix.h"
 #include <vector>
+#include <span>
 #include <map>
 #include <cmath>
 
+class SnapshotWriter;
+class SnapshotReader;
+
 /**
  * @class NaiveBayesClassifier
  * @brief Implements Naive Bayes algorithm for probabilistic classification
@@ -19,23 +24,26 @@ private:
     
     // Helper functions
     double calculateProbability(double x, double mean, double std) const;
-    double calculateClassProbability(const std::vector<double>& features, int classLabel) const;
-    void calculateClassStatistics(const std::vector<std::vector<double>>& X, 
-                                  const std::vector<int>& y);
+    double calculateClassProbability(std::span<const double> features, int classLabel) const;
+    void calculateClassStatistics(const FeatureMatrix& X, std::span<const int> y);
     
 public:
     NaiveBayesClassifier();
     
     // Training and prediction
-    void fit(const std::vector<std::vector<double>>& X, const std::vector<int>& y);
-    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
-    int predictSingle(const std::vector<double>& features) const;
-    std::vector<double> predictProbability(const std::vector<std::vector<double>>& X) const;
-    double predictProbabilitySingle(const std::vector<double>& features) const;
+    void fit(const FeatureMatrix& X, std::span<const int> y);
+    std::vector<int> predict(const FeatureMatrix& X) const;
+    int predictSingle(std::span<const double> features) const;
+    std::vector<double> predictProbability(const FeatureMatrix& X) const;
+    double predictProbabilitySingle(std::span<const double> features) const;
     
     // Utility
     bool getIsTrained() const;
     std::map<int, double> getClassPrior() const;
+    
+    // Persistence
+    void saveState(SnapshotWriter& writer) const;
+    void loadState(SnapshotReader& reader);
 };
 
 #endif // NAIVE_BAYES_CLASSIFIER_H
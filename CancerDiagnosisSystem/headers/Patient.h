@@ -2,45 +2,81 @@
 #define PATIENT_H
 
 #include <string>
+#include <string_view>
+#include <span>
 #include <vector>
+#include <memory_resource>
+#include <cstdint>
 #include "GeneticData.h"
+#include "GeneticDataTable.h"
+#include "StringInterner.h"
 
 /**
  * @class Patient
  * @brief Represents a patient with genetic data and medical history
+ *
+ * Allocator-aware: the name and genetic data are allocated from the
+ * patient's memory resource. Plain copies use the default resource; the
+ * allocator-extended constructors place the copy in the given one.
+ *
+ * Genetic data are either owned records or row indices into a shared
+ * GeneticDataTable, resolved on access. Plain copies resolve the rows into
+ * owned records, so a copy never depends on the table; allocator-extended
+ * copies and moves keep referring to it.
  */
 class Patient {
 private:
-    std::string patientId;
-    std::string name;
+    Symbol patientId; // Interned
+    std::pmr::string name;
     int age;
-    std::vector<GeneticData> geneticData;
+    const GeneticDataTable* geneTable; // Set while genetic data are rows of this table
+    std::pmr::vector<uint32_t> geneRows;
+    std::pmr::vector<GeneticData> geneticData; // Owned records otherwise
     double riskScore;
     int prediction; // 0 = non-cancerous, 1 = cancerous
     
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    
     // Constructors
     Patient();
-    Patient(const std::string& id, const std::string& name, int age);
+    explicit Patient(const allocator_type& alloc);
+    Patient(std::string_view id, std::string_view name, int age, const allocator_type& alloc = {});
+    Patient(const Patient& other);
+    Patient(Patient&& other) noexcept = default;
+    Patient(const Patient& other, const allocator_type& alloc);
+    Patient(Patient&& other, const allocator_type& alloc);
+    Patient& operator=(const Patient& other);
+    Patient& operator=(Patient&& other) = default;
+    
+    allocator_type get_allocator() const;
     
     // Getters
-    std::string getPatientId() const;
-    std::string getName() const;
+    const std::string& getPatientId() const;
+    Symbol getPatientSymbol() const;
+    std::string_view getName() const;
     int getAge() const;
-    std::vector<GeneticData> getGeneticData() const;
+    // Invalidated by addGeneticData and by changes to a referenced table
+    GeneticDataView getGeneticData() const;
+    // Referenced table and rows; nullptr and empty when records are owned
+    const GeneticDataTable* getGeneTable() const;
+    std::span<const uint32_t> getGeneRows() const;
     double getRiskScore() const;
     int getPrediction() const;
     
     // Setters
-    void setPatientId(const std::string& id);
-    void setName(const std::string& name);
+    void setPatientId(std::string_view id);
+    void setName(std::string_view name);
     void setAge(int age);
     void setRiskScore(double score);
     void setPrediction(int pred);
     
     // Data management
     void addGeneticData(const GeneticData& data);
-    std::vector<double> getMutationScores() const;
+    // Refer to a row of `table`; the table must outlive this patient (or
+    // its plain copies must be taken first). Falls back to copying the
+    // record if the patient already holds other data.
+    void addGeneticDataRow(const GeneticDataTable& table, size_t row);
     
     // Utility
     void display() const;
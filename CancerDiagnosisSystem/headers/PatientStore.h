@@ -0,0 +1,94 @@
+#ifndef PATIENT_STORE_H
+#define PATIENT_STORE_H
+
+#include "Patient.h"
+#include "StringInterner.h"
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * @class PatientStore
+ * @brief Patient history in contiguous storage with a hash index on patient ID
+ *
+ * Patients are kept in insertion order; the history (most recent first) is
+ * that order reversed. IDs are indexed by the symbol of the ID with
+ * surrounding whitespace trimmed, and adding a patient whose ID is already
+ * present replaces the stored record in place.
+ *
+ * Stored records (names, genetic data and the ID index) are allocated from
+ * monotonic arenas owned by the current load epoch. clear() ends the epoch
+ * and releases all of its memory in one step; memory of records replaced
+ * during an epoch is only reclaimed then. Patients copied out of the store
+ * use the default allocator and are unaffected.
+ *
+ * Every stored record also has a revision, drawn from a process-wide
+ * counter whenever it is inserted or replaced, so that results derived
+ * from a record can be checked against it later, even across stores.
+ */
+class PatientStore {
+private:
+    struct Epoch {
+        std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> arenas;
+        std::pmr::unordered_map<Symbol, size_t> indexById; // In arenas[0]
+        Epoch();
+    };
+
+    // Declared before `patients` so the records are destroyed first
+    std::unique_ptr<Epoch> epoch;
+    std::vector<Patient> patients;
+    std::vector<uint64_t> revisions; // Parallel to `patients`
+
+    static Symbol keyFor(const Patient& patient);
+    bool ownsMemoryOf(const Patient& patient) const;
+
+public:
+    using allocator_type = Patient::allocator_type;
+    using const_iterator = std::vector<Patient>::const_iterator;
+    using const_reverse_iterator = std::vector<Patient>::const_reverse_iterator;
+
+    PatientStore();
+    PatientStore(const PatientStore&) = delete;
+    PatientStore& operator=(const PatientStore&) = delete;
+    void swap(PatientStore& other) noexcept;
+
+    // Allocator of the current epoch; build patients with it so upserting
+    // them moves rather than copies. Not thread-safe, like the store itself.
+    allocator_type get_allocator() const;
+    // An extra arena in the current epoch, for building patients on another
+    // thread (one arena per thread)
+    allocator_type createArena();
+
+    // Insert or replace by ID; returns true if the patient was new
+    bool upsert(const Patient& patient);
+    bool upsert(Patient&& patient);
+
+    // nullptr if no patient has this ID
+    const Patient* find(std::string_view patientId) const;
+    bool contains(std::string_view patientId) const;
+    // Revision of a record returned by find(); a different one means it was replaced
+    uint64_t revisionOf(const Patient& stored) const { return revisions[&stored - patients.data()]; }
+    // Insertion-order position of a record returned by find(); stable until clear()
+    size_t positionOf(const Patient& stored) const { return &stored - patients.data(); }
+
+    size_t size() const { return patients.size(); }
+    bool empty() const { return patients.empty(); }
+    void reserve(size_t count);
+    void clear(); // Ends the epoch
+
+    // Insertion order (oldest first)
+    const_iterator begin() const { return patients.begin(); }
+    const_iterator end() const { return patients.end(); }
+    // History order (most recent first)
+    const_reverse_iterator rbegin() const { return patients.rbegin(); }
+    const_reverse_iterator rend() const { return patients.rend(); }
+
+    // `patientId` without surrounding whitespace
+    static std::string_view normalizeId(std::string_view patientId);
+};
+
+#endif // PATIENT_STORE_H
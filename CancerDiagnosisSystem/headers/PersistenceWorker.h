@@ -0,0 +1,43 @@
+#ifndef PERSISTENCE_WORKER_H
+#define PERSISTENCE_WORKER_H
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * @class PersistenceWorker
+ * @brief Background thread that coalesces dirty notifications into periodic flushes
+ *
+ * markDirty() is cheap and never blocks on I/O. However many times it is
+ * called, the flush function runs at most once per interval, and once more
+ * on stop() if changes are still pending.
+ */
+class PersistenceWorker {
+private:
+    std::function<void()> flushFunction;
+    std::chrono::milliseconds interval;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool dirty;
+    bool stopping;
+    std::thread worker;
+
+    void run();
+
+public:
+    PersistenceWorker(std::function<void()> flush, std::chrono::milliseconds interval);
+    ~PersistenceWorker();
+
+    PersistenceWorker(const PersistenceWorker&) = delete;
+    PersistenceWorker& operator=(const PersistenceWorker&) = delete;
+
+    void markDirty();
+    // Flush any pending changes and stop the thread
+    void stop();
+};
+
+#endif // PERSISTENCE_WORKER_H
@@ -0,0 +1,67 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ResponseCache
+ * @brief Serialized responses of read endpoints, each valid for one data version
+ *
+ * Entries are keyed by request (path, parameters and representation) and
+ * tagged with the data version they were built from. A lookup at any
+ * other version misses, so nothing needs to be invalidated when the data
+ * change: storing an entry just evicts those of older versions first.
+ * Responses are shared and immutable, so a hit is served without copying
+ * the body. Bodies over the size limit are not kept.
+ */
+class ResponseCache {
+public:
+    struct Response {
+        std::string body;
+        std::string contentType;
+        std::vector<std::pair<std::string, std::string>> headers; // Sent along with the body
+    };
+
+private:
+    struct Entry {
+        uint64_t version;
+        std::shared_ptr<const Response> response;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    size_t maxEntries;
+    size_t maxBodyBytes;
+    mutable std::atomic<uint64_t> hits;
+    mutable std::atomic<uint64_t> misses;
+
+public:
+    ResponseCache(size_t maxEntries, size_t maxBodyBytes);
+
+    // nullptr unless `key` was stored at exactly this version
+    std::shared_ptr<const Response> find(const std::string& key, uint64_t version) const;
+    // Returns the response for sending, whether or not it was kept
+    std::shared_ptr<const Response> store(const std::string& key, uint64_t version, Response response);
+
+    uint64_t getHits() const { return hits.load(std::memory_order_relaxed); }
+    uint64_t getMisses() const { return misses.load(std::memory_order_relaxed); }
+
+    // Strong ETag of a representation at a data version; `instance` tells
+    // server processes apart, as their data versions all count from zero
+    static std::string makeETag(std::string_view instance, uint64_t version, std::string_view variant);
+    // Does an If-None-Match header list `etag` (or "*")? Weak validators
+    // match too, as If-None-Match uses the weak comparison.
+    static bool etagMatches(std::string_view header, std::string_view etag);
+};
+
+#endif // RESPONSE_CACHE_H
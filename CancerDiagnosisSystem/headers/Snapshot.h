@@ -0,0 +1,127 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "MappedFile.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @struct SnapshotHeader
+ * @brief Fixed-size header at the start of every .cds snapshot file
+ */
+struct SnapshotHeader {
+    char magic[8];          // "CDSSNAP\0"
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t payloadSize;
+    uint64_t checksum;      // Checksum of the payload bytes
+};
+
+// FNV-1a style mixing over 8-byte words (tail bytes one at a time); also
+// used to recognise data files staged by a crashed rewrite
+uint64_t payloadChecksum(std::string_view data);
+
+/**
+ * @class SnapshotWriter
+ * @brief Builds a snapshot payload and writes it with a header and checksum
+ *
+ * Arrays are 8-byte aligned relative to the payload start so that a mapped
+ * snapshot can be read column by column without unaligned access.
+ */
+class SnapshotWriter {
+private:
+    std::string buffer;
+
+public:
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        write<uint64_t>(values.size());
+        align();
+        buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T>& values) {
+        writeArray(std::span<const T>(values));
+    }
+
+    void writeString(std::string_view value);
+    void align();
+
+    // Offset of the next value written, for filling it in later with overwrite()
+    size_t position() const { return buffer.size(); }
+
+    template <typename T>
+    void overwrite(size_t at, const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        std::memcpy(buffer.data() + at, &value, sizeof(T));
+    }
+
+    // Write header and payload to a temporary file, then rename it over `filename`
+    bool saveToFile(const std::string& filename) const;
+};
+
+/**
+ * @class SnapshotReader
+ * @brief Maps a snapshot file, validates it and reads the payload in order
+ *
+ * Read errors (truncated or corrupt payloads) throw std::runtime_error.
+ */
+class SnapshotReader {
+private:
+    MappedFile file;
+    std::string_view payload;
+    size_t position;
+
+    const char* take(size_t bytes);
+
+public:
+    SnapshotReader();
+
+    // Map and validate; on failure `error` describes the problem
+    bool open(const std::string& filename, std::string& error);
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> readArray() {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+        uint64_t count = read<uint64_t>();
+        align();
+        if (count > (payload.size() - position) / (sizeof(T) ? sizeof(T) : 1)) {
+            throw std::runtime_error("Snapshot array exceeds payload");
+        }
+        std::vector<T> values(count);
+        if (count > 0) {
+            std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+        }
+        return values;
+    }
+
+    std::string readString();
+    void align();
+};
+
+// Current on-disk snapshot format version
+constexpr uint32_t kSnapshotVersion = 4;
+
+#endif // SNAPSHOT_H
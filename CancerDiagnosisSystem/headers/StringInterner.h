@@ -0,0 +1,93 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+class StringInterner;
+
+/**
+ * @class Symbol
+ * @brief Compact handle for an interned identifier string
+ *
+ * Two symbols are equal exactly when their strings are equal, so equality
+ * and hashing are integer operations. The default symbol is the empty string.
+ */
+class Symbol {
+private:
+    uint32_t value;
+
+    friend class StringInterner;
+    constexpr explicit Symbol(uint32_t id) : value(id) {}
+
+public:
+    constexpr Symbol() : value(0) {}
+    // Interns `text` in the global interner
+    explicit Symbol(std::string_view text);
+
+    uint32_t id() const { return value; }
+    bool empty() const { return value == 0; }
+    const std::string& str() const;
+
+    friend bool operator==(Symbol a, Symbol b) { return a.value == b.value; }
+    friend bool operator!=(Symbol a, Symbol b) { return a.value != b.value; }
+};
+
+namespace std {
+template <>
+struct hash<Symbol> {
+    size_t operator()(Symbol symbol) const noexcept {
+        // Multiplicative mixing so dense IDs spread over hash buckets
+        return static_cast<size_t>(symbol.id() * 0x9e3779b97f4a7c15ULL);
+    }
+};
+} // namespace std
+
+/**
+ * @class StringInterner
+ * @brief Process-wide table mapping identifier strings to 32-bit symbols
+ *
+ * Strings are stored once, in chunks that never move, and are never
+ * released. Looking up the string of a symbol takes no lock; interning
+ * takes a shared lock when the string is already known and an exclusive
+ * lock only to add a new one.
+ */
+class StringInterner {
+private:
+    static constexpr size_t kFirstChunkSize = 1024;
+    static constexpr size_t kMaxChunks = 23; // Chunk k holds kFirstChunkSize << k strings
+
+    std::atomic<std::string*> chunks[kMaxChunks];
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string_view, uint32_t> ids; // Views into the chunks
+    uint32_t count;
+
+    StringInterner();
+
+public:
+    ~StringInterner();
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    static StringInterner& global();
+
+    Symbol intern(std::string_view text);
+    // Look up without interning; false if `text` was never interned
+    bool find(std::string_view text, Symbol& symbol) const;
+    const std::string& lookup(Symbol symbol) const;
+    size_t size() const;
+};
+
+inline Symbol::Symbol(std::string_view text) : value(StringInterner::global().intern(text).value) {}
+
+inline const std::string& Symbol::str() const {
+    return StringInterner::global().lookup(*this);
+}
+
+#endif // STRING_INTERNER_H
@@ -0,0 +1,248 @@
+#ifndef TEST_SCHEDULER_H
+#define TEST_SCHEDULER_H
+
+#include "MpmcQueue.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Priority classes, most urgent first
+enum class TestPriority : uint8_t { URGENT, HIGH, NORMAL, LOW };
+constexpr size_t kTestPriorityCount = 4;
+
+inline const char* testPriorityName(TestPriority priority) {
+    switch (priority) {
+        case TestPriority::URGENT: return "urgent";
+        case TestPriority::HIGH: return "high";
+        case TestPriority::LOW: return "low";
+        default: return "normal";
+    }
+}
+
+// Longest a test of each class should wait; with no caller deadline this
+// is the test's deadline
+inline std::chrono::milliseconds testPriorityBudget(TestPriority priority) {
+    switch (priority) {
+        case TestPriority::URGENT: return std::chrono::seconds(5);
+        case TestPriority::HIGH: return std::chrono::seconds(30);
+        case TestPriority::LOW: return std::chrono::minutes(10);
+        default: return std::chrono::minutes(2);
+    }
+}
+
+enum class SchedulingMode {
+    FIFO,    // Arrival order, lock-free
+    DEADLINE // Earliest deadline first
+};
+
+// Per-class counters; waits cover tests already dispatched
+struct TestQueueStats {
+    size_t depth;
+    uint64_t dispatched;
+    double meanWaitMs;
+    double maxWaitMs;
+    uint64_t missedDeadlines; // Dispatched after their deadline
+};
+
+/**
+ * @class TestScheduler
+ * @brief Bounded queue of pending tests, dispatched in FIFO or deadline order
+ *
+ * Every test gets a deadline: its class budget, or the caller's deadline if
+ * that is sooner. In DEADLINE mode the test with the earliest deadline runs
+ * next (ties in arrival order). Since budgets grow with lower priority, a
+ * waiting low-priority test eventually has an earlier deadline than newly
+ * arriving urgent ones, so nothing starves. DEADLINE mode keeps a heap
+ * under a short mutex; FIFO mode is lock-free and uses the classes only
+ * for statistics.
+ *
+ * Tests live in a fixed pool of entries; the queues pass 32-bit entry
+ * handles, with free entries kept in a lock-free ring of their own.
+ */
+template <typename T>
+class TestScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "Scheduled values must be trivially copyable");
+
+    struct Entry {
+        std::atomic<T> value; // Atomic so forEach can read it while the entry is reused
+        TestPriority priority;
+        Clock::time_point enqueued;
+        Clock::time_point deadline;
+    };
+
+    struct HeapItem {
+        Clock::time_point deadline;
+        uint64_t sequence;
+        uint32_t entry;
+    };
+
+    struct ClassCounters {
+        std::atomic<size_t> depth{0};
+        std::atomic<uint64_t> dispatched{0};
+        std::atomic<uint64_t> totalWaitMicros{0};
+        std::atomic<uint64_t> maxWaitMicros{0};
+        std::atomic<uint64_t> missedDeadlines{0};
+        LatencyHistogram* waitTime = nullptr; // Shared by all schedulers, in Metrics::global()
+    };
+
+    SchedulingMode mode;
+    std::unique_ptr<Entry[]> entries;
+    MpmcQueue<uint32_t> freeEntries;
+    MpmcQueue<uint32_t> fifo; // FIFO mode
+
+    mutable std::mutex heapMutex; // DEADLINE mode
+    std::vector<HeapItem> heap;
+    uint64_t nextSequence;
+
+    ClassCounters counters[kTestPriorityCount];
+
+    // Min-heap on (deadline, sequence)
+    static bool later(const HeapItem& a, const HeapItem& b) {
+        if (a.deadline != b.deadline) return a.deadline > b.deadline;
+        return a.sequence > b.sequence;
+    }
+
+    void recordDispatch(const Entry& entry) {
+        Clock::time_point now = Clock::now();
+        ClassCounters& counter = counters[static_cast<size_t>(entry.priority)];
+        uint64_t waitMicros = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - entry.enqueued).count());
+        counter.depth.fetch_sub(1, std::memory_order_relaxed);
+        counter.dispatched.fetch_add(1, std::memory_order_relaxed);
+        counter.totalWaitMicros.fetch_add(waitMicros, std::memory_order_relaxed);
+        uint64_t previous = counter.maxWaitMicros.load(std::memory_order_relaxed);
+        while (previous < waitMicros &&
+               !counter.maxWaitMicros.compare_exchange_weak(previous, waitMicros, std::memory_order_relaxed)) {
+        }
+        counter.waitTime->record(now - entry.enqueued);
+        if (now > entry.deadline) {
+            counter.missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    TestScheduler(size_t capacity, SchedulingMode mode)
+        : mode(mode), entries(new Entry[capacity]), freeEntries(capacity), fifo(capacity),
+          nextSequence(0) {
+        for (size_t i = 0; i < capacity; ++i) {
+            freeEntries.tryPush(static_cast<uint32_t>(i));
+        }
+        if (mode == SchedulingMode::DEADLINE) {
+            heap.reserve(capacity);
+        }
+        for (size_t i = 0; i < kTestPriorityCount; ++i) {
+            std::string labels = std::string("priority=\"") + testPriorityName(static_cast<TestPriority>(i)) + "\"";
+            counters[i].waitTime = &Metrics::global().histogram("cds_queue_wait_seconds", labels,
+                                                                "Time tests waited in the queue before dispatch");
+        }
+    }
+
+    TestScheduler(const TestScheduler&) = delete;
+    TestScheduler& operator=(const TestScheduler&) = delete;
+
+    // Returns false if the queue is full. `deadline` (from now) only
+    // counts if it is sooner than the class budget.
+    bool push(const T& value, TestPriority priority, Clock::duration deadline = Clock::duration::max()) {
+        uint32_t index;
+        if (!freeEntries.tryPop(index)) {
+            return false;
+        }
+        Entry& entry = entries[index];
+        entry.value.store(value, std::memory_order_relaxed);
+        entry.priority = priority;
+        entry.enqueued = Clock::now();
+        entry.deadline = entry.enqueued + std::min<Clock::duration>(deadline, testPriorityBudget(priority));
+        counters[static_cast<size_t>(priority)].depth.fetch_add(1, std::memory_order_relaxed);
+
+        if (mode == SchedulingMode::FIFO) {
+            fifo.tryPush(index); // Cannot fail: it has room for every entry
+        } else {
+            std::lock_guard<std::mutex> lock(heapMutex);
+            heap.push_back({entry.deadline, nextSequence++, index});
+            std::push_heap(heap.begin(), heap.end(), later);
+        }
+        return true;
+    }
+
+    // Returns false if no test is waiting
+    bool pop(T& value) {
+        uint32_t index;
+        if (mode == SchedulingMode::FIFO) {
+            if (!fifo.tryPop(index)) {
+                return false;
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(heapMutex);
+            if (heap.empty()) {
+                return false;
+            }
+            std::pop_heap(heap.begin(), heap.end(), later);
+            index = heap.back().entry;
+            heap.pop_back();
+        }
+        Entry& entry = entries[index];
+        value = entry.value.load(std::memory_order_relaxed);
+        recordDispatch(entry);
+        freeEntries.tryPush(index);
+        return true;
+    }
+
+    // Visit waiting values in dispatch order without removing them; a
+    // best-effort snapshot while other threads push or pop
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        if (mode == SchedulingMode::FIFO) {
+            fifo.forEach([&](uint32_t index) {
+                visit(entries[index].value.load(std::memory_order_relaxed));
+            });
+            return;
+        }
+        std::vector<HeapItem> ordered;
+        {
+            std::lock_guard<std::mutex> lock(heapMutex);
+            ordered = heap;
+        }
+        std::sort(ordered.begin(), ordered.end(), [](const HeapItem& a, const HeapItem& b) {
+            return later(b, a);
+        });
+        for (const HeapItem& item : ordered) {
+            visit(entries[item.entry].value.load(std::memory_order_relaxed));
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& counter : counters) {
+            total += counter.depth.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    bool empty() const { return size() == 0; }
+    SchedulingMode getMode() const { return mode; }
+
+    TestQueueStats getStats(TestPriority priority) const {
+        const ClassCounters& counter = counters[static_cast<size_t>(priority)];
+        TestQueueStats stats;
+        stats.depth = counter.depth.load(std::memory_order_relaxed);
+        stats.dispatched = counter.dispatched.load(std::memory_order_relaxed);
+        uint64_t totalWait = counter.totalWaitMicros.load(std::memory_order_relaxed);
+        stats.meanWaitMs = stats.dispatched ? totalWait / 1000.0 / stats.dispatched : 0.0;
+        stats.maxWaitMs = counter.maxWaitMicros.load(std::memory_order_relaxed) / 1000.0;
+        stats.missedDeadlines = counter.missedDeadlines.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+#endif // TEST_SCHEDULER_H
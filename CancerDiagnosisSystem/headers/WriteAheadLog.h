@@ -0,0 +1,103 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @class WriteAheadLog
+ * @brief Append-only record log with group commit
+ *
+ * Records are newline-terminated text lines. Appends only copy into an
+ * in-memory buffer; a background thread writes everything buffered so far
+ * with a single write (and at most one fsync), so concurrent writers share
+ * the cost of each flush.
+ *
+ * The first line of the file ("WAL<tab><id>") is a header naming this
+ * generation of the log; it is not a record and not counted by size().
+ * Logs written before the header existed have none and report id 0.
+ */
+class WriteAheadLog {
+public:
+    enum class FsyncPolicy {
+        NEVER,      // Leave flushing to the OS page cache
+        ALWAYS,     // fsync before every group commit is acknowledged
+        PERIODIC    // fsync at most once per fsync interval. Acknowledged records
+                    // are written but may be unsynced for up to one interval.
+    };
+
+private:
+    std::string filename;
+    FsyncPolicy fsyncPolicy;
+    std::chrono::milliseconds fsyncInterval;
+    int fd;
+
+    std::mutex mutex;
+    std::condition_variable pendingCondition;
+    std::condition_variable durableCondition;
+    std::string pending;
+    uint64_t appendedSequence;  // Last record handed to append()
+    uint64_t durableSequence;   // Last record written (and synced per policy)
+    uint64_t logBytes;          // In the file, being written or buffered
+    uint64_t headerBytes;       // Of logBytes, taken by the header line
+    uint64_t logId;
+    bool stopping;
+    bool writeFailed;
+    bool flushing;              // The flusher is writing or syncing without the lock
+    bool unsynced;              // Written since the last fsync (PERIODIC only)
+    std::thread flusher;
+    std::chrono::steady_clock::time_point lastSync;
+
+    void flushLoop();
+    bool writeAll(const std::string& data);
+    void syncFile();
+    static std::string makeHeader(uint64_t id);
+
+public:
+    WriteAheadLog();
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Open (creating if needed) and start the group-commit thread
+    bool open(const std::string& filename, FsyncPolicy policy,
+              std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+    void close();
+
+    // Buffer one record (a trailing newline is added); returns its sequence number
+    uint64_t append(std::string_view record);
+    // Block until every record up to `sequence` is durable (under PERIODIC:
+    // written, and synced within one interval); false on I/O error
+    bool waitDurable(uint64_t sequence);
+    // Block until everything appended so far is durable
+    bool sync();
+
+    // Drop the first `bytes` bytes of records (those folded into the base
+    // files), keeping any appended after them. The log is replaced under a
+    // new id. Waits for pending records to be written; appends block while
+    // the kept tail is copied.
+    bool discardPrefix(uint64_t bytes);
+
+    // Bytes of records in the log, including those not yet written; a
+    // position in the log for discardPrefix once they are
+    uint64_t size();
+    // Names the log's current contents: set when the file is created and
+    // changed by every discardPrefix, so a position is only meaningful
+    // together with the id it was taken under
+    uint64_t getLogId();
+    const std::string& getFilename() const;
+
+    // Call visitor for every complete record in a log file, in order (the
+    // header is skipped)
+    static size_t replay(const std::string& filename,
+                         const std::function<void(std::string_view)>& visitor);
+};
+
+#endif // WRITE_AHEAD_LOG_H
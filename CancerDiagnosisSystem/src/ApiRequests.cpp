@@ -0,0 +1,215 @@
+#include "../headers/ApiRequests.h"
+#include "../headers/JsonReader.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Run `onMember` over the members of the top-level object in `body`
+template <typename MemberFn>
+bool parseObject(std::string_view body, std::string& error, MemberFn&& onMember) {
+    JsonReader reader(body);
+    if (reader.peek() != JsonReader::Type::OBJECT) {
+        reader.skipValue(); // Reports what was found instead
+        error = reader.ok() ? "Expected a JSON object" : reader.getError();
+        return false;
+    }
+    if (!reader.readObject([&](std::string_view key) { return onMember(reader, key); }) || !reader.finish()) {
+        error = reader.getError();
+        return false;
+    }
+    return true;
+}
+
+// A string member; null leaves `out` unchanged
+bool readOptionalString(JsonReader& reader, std::string& out) {
+    if (reader.peek() == JsonReader::Type::NULL_VALUE) {
+        return reader.readNull();
+    }
+    return reader.readString(out);
+}
+
+bool readPriority(JsonReader& reader, std::optional<TestPriority>& priority) {
+    std::string scratch;
+    std::string_view name;
+    if (reader.peek() == JsonReader::Type::NULL_VALUE) {
+        return reader.readNull();
+    }
+    if (!reader.readString(name, scratch)) {
+        return false;
+    }
+    if (name == "urgent") priority = TestPriority::URGENT;
+    else if (name == "high") priority = TestPriority::HIGH;
+    else if (name == "normal") priority = TestPriority::NORMAL;
+    else if (name == "low") priority = TestPriority::LOW;
+    return true;
+}
+
+bool readGeneRecord(JsonReader& reader, std::vector<GeneticData>& records) {
+    std::string scratch;
+    std::string_view geneId;
+    bool hasGeneId = false;
+    double mutationScore = 0.0;
+    int label = 0;
+    bool parsed = reader.readObject([&](std::string_view key) {
+        if (key == "geneId" || key == "gene_id") {
+            hasGeneId = true;
+            return reader.readString(geneId, scratch);
+        }
+        if (key == "mutationScore" || key == "mutation_score") return reader.readNumber(mutationScore);
+        if (key == "label") return reader.readInt(label);
+        return reader.skipValue();
+    });
+    if (!parsed) {
+        return false;
+    }
+    // Records without a gene ID are ignored, as before
+    if (hasGeneId) {
+        records.emplace_back(geneId, mutationScore, label);
+    }
+    return true;
+}
+
+} // namespace
+
+CancerDiagnosisSystem::ModelType modelTypeFromName(std::string_view name) {
+    if (name == "knn") return CancerDiagnosisSystem::ModelType::KNN;
+    if (name == "decision_tree") return CancerDiagnosisSystem::ModelType::DECISION_TREE;
+    if (name == "naive_bayes") return CancerDiagnosisSystem::ModelType::NAIVE_BAYES;
+    return CancerDiagnosisSystem::ModelType::LOGISTIC;
+}
+
+bool LoadRequest::parse(std::string_view body, std::string& error) {
+    return parseObject(body, error, [&](JsonReader& reader, std::string_view key) {
+        if (key == "genesFile") return readOptionalString(reader, genesFile);
+        if (key == "patientsFile") return readOptionalString(reader, patientsFile);
+        return reader.skipValue();
+    });
+}
+
+bool PatientRequest::read(JsonReader& reader) {
+    std::string firstId, secondId, thirdId;
+    bool parsed = reader.readObject([&](std::string_view key) {
+        if (key == "patient_id") return readOptionalString(reader, firstId);
+        if (key == "patientId") return readOptionalString(reader, secondId);
+        if (key == "id") return readOptionalString(reader, thirdId);
+        if (key == "name") return readOptionalString(reader, name);
+        if (key == "age") {
+            if (reader.peek() == JsonReader::Type::NULL_VALUE) return reader.readNull();
+            return reader.readInt(age);
+        }
+        if (key == "geneticRecords" || key == "genetic_records") {
+            return reader.readArray([&] { return readGeneRecord(reader, geneticRecords); });
+        }
+        return reader.skipValue();
+    });
+    // Key variants in order of preference
+    patientId = !firstId.empty() ? firstId : !secondId.empty() ? secondId : thirdId;
+    return parsed;
+}
+
+bool PatientRequest::parse(std::string_view body, std::string& error) {
+    JsonReader reader(body);
+    if (!read(reader) || !reader.finish()) {
+        error = reader.getError();
+        return false;
+    }
+    return true;
+}
+
+Patient PatientRequest::toPatient() const {
+    Patient patient(patientId, name, age);
+    for (const GeneticData& record : geneticRecords) {
+        patient.addGeneticData(record);
+    }
+    return patient;
+}
+
+bool QueueRequest::parse(std::string_view body, std::string& error) {
+    std::string firstId, secondId;
+    std::optional<TestPriority> urgency;
+    bool badDeadline = false;
+    bool parsed = parseObject(body, error, [&](JsonReader& reader, std::string_view key) {
+        if (key == "patient_id") return readOptionalString(reader, firstId);
+        if (key == "patientId") return readOptionalString(reader, secondId);
+        if (key == "model") {
+            std::string modelName;
+            if (!readOptionalString(reader, modelName)) return false;
+            model = modelTypeFromName(modelName);
+            return true;
+        }
+        if (key == "priority") return readPriority(reader, priority);
+        if (key == "urgency") return readPriority(reader, urgency);
+        if (key == "deadline_ms") {
+            if (reader.peek() == JsonReader::Type::NULL_VALUE) return reader.readNull();
+            double milliseconds = 0.0;
+            if (!reader.readNumber(milliseconds)) return false;
+            if (!std::isfinite(milliseconds) || milliseconds < 0.0) {
+                badDeadline = true;
+                return false;
+            }
+            // No test waits longer than the lowest class's budget anyway
+            double longest = static_cast<double>(testPriorityBudget(TestPriority::LOW).count());
+            deadline = std::chrono::milliseconds(static_cast<long long>(std::min(milliseconds, longest)));
+            return true;
+        }
+        return reader.skipValue();
+    });
+    if (badDeadline) {
+        error = "deadline_ms must be a non-negative number";
+    }
+    patientId = !firstId.empty() ? firstId : secondId;
+    if (!priority) {
+        priority = urgency;
+    }
+    return parsed;
+}
+
+bool ProcessQueueRequest::parse(std::string_view body, std::string& error) {
+    if (body.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+        return true;
+    }
+    return parseObject(body, error, [&](JsonReader& reader, std::string_view key) {
+        if (key == "model") {
+            if (reader.peek() == JsonReader::Type::NULL_VALUE) return reader.readNull();
+            if (!reader.readString(modelName)) return false;
+            model = modelTypeFromName(modelName);
+            return true;
+        }
+        return reader.skipValue();
+    });
+}
+
+bool BatchDiagnosisRequest::parse(std::string_view body, std::string& error) {
+    bool parsed = parseObject(body, error, [&](JsonReader& reader, std::string_view key) {
+        if (key == "patient_ids" || key == "patientIds") {
+            return reader.readArray([&] {
+                patientIds.emplace_back();
+                return reader.readString(patientIds.back());
+            });
+        }
+        if (key == "patients") {
+            return reader.readArray([&] {
+                patients.emplace_back();
+                return patients.back().read(reader);
+            });
+        }
+        if (key == "models") {
+            return reader.readArray([&] {
+                std::string scratch;
+                std::string_view name;
+                if (!reader.readString(name, scratch)) return false;
+                CancerDiagnosisSystem::ModelType model = modelTypeFromName(name);
+                if (std::find(models.begin(), models.end(), model) == models.end()) {
+                    models.push_back(model);
+                }
+                return true;
+            });
+        }
+        return reader.skipValue();
+    });
+    if (models.empty()) {
+        models.push_back(CancerDiagnosisSystem::ModelType::LOGISTIC);
+    }
+    return parsed;
+}
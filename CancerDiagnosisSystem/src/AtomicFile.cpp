@@ -0,0 +1,109 @@
+#include "../headers/AtomicFile.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool writeAll(int fd, std::string_view data) {
+    size_t written = 0;
+    while (written < data.size()) {
+#ifdef _WIN32
+        int n = _write(fd, data.data() + written, static_cast<unsigned int>(data.size() - written));
+#else
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+#endif
+        if (n <= 0) {
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+#ifndef _WIN32
+// Make the rename itself durable
+void syncParentDirectory(const std::string& filename) {
+    size_t slash = filename.find_last_of('/');
+    std::string directory = (slash == std::string::npos) ? "." : filename.substr(0, slash + 1);
+    int dirFd = ::open(directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+#endif
+
+} // namespace
+
+bool stageFile(const std::string& filename, std::initializer_list<std::string_view> parts) {
+    std::string tempFile = filename + ".tmp";
+
+#ifdef _WIN32
+    int fd = _open(tempFile.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(tempFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    if (fd < 0) {
+        return false;
+    }
+
+    bool ok = true;
+    for (std::string_view part : parts) {
+        if (!writeAll(fd, part)) {
+            ok = false;
+            break;
+        }
+    }
+
+#ifdef _WIN32
+    ok = ok && _commit(fd) == 0;
+    _close(fd);
+#else
+    ok = ok && fsync(fd) == 0;
+    ::close(fd);
+#endif
+
+    if (!ok) {
+        std::remove(tempFile.c_str());
+    }
+    return ok;
+}
+
+bool commitStagedFile(const std::string& filename) {
+    std::string tempFile = filename + ".tmp";
+#ifdef _WIN32
+    return MoveFileExA(tempFile.c_str(), filename.c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(tempFile.c_str(), filename.c_str()) != 0) {
+        return false;
+    }
+    syncParentDirectory(filename);
+    return true;
+#endif
+}
+
+void discardStagedFile(const std::string& filename) {
+    std::remove((filename + ".tmp").c_str());
+}
+
+bool writeFileAtomically(const std::string& filename, std::initializer_list<std::string_view> parts) {
+    if (!stageFile(filename, parts)) {
+        return false;
+    }
+    if (!commitStagedFile(filename)) {
+        discardStagedFile(filename);
+        return false;
+    }
+    return true;
+}
@@ -1,432 +1,1099 @@
 #include "../headers/CancerDiagnosisSystem.h"
+#include "../headers/MappedFile.h"
+#include "../headers/CsvScanner.h"
+#include "../headers/Snapshot.h"
+#include "../headers/WriteAheadLog.h"
+#include "../headers/AtomicFile.h"
+#include "../headers/Metrics.h"
+#include "../headers/Logger.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
+#include <thread>
+#include <filesystem>
+#include <unordered_map>
+#include <charconv>
 
 
-CancerDiagnosisSystem::CancerDiagnosisSystem() 
-    : patientHistoryHead(nullptr), modelsTrained(false) {
-    // Initialize ML models
-    logisticModel = std::make_unique<LogisticRegressionModel>(0.01, 1000);
-    knnModel = std::make_unique<KNNClassifier>(5);
-    decisionTreeModel = std::make_unique<DecisionTreeClassifier>(10, 2);
-    naiveBayesModel = std::make_unique<NaiveBayesClassifier>();
+namespace {
+
+// Files smaller than this per worker are not worth splitting further
+constexpr size_t kMinPatientChunkBytes = 1 << 20;
+
+// Source of ModelSet::version; never reused within the process
+std::atomic<uint64_t> nextModelSetVersion(1);
+
+struct PatientRow {
+    std::string_view patientId;
+    std::string_view name;
+    int age;
+};
+
+struct PatientChunk {
+    std::vector<PatientRow> rows;
+    std::vector<std::pair<size_t, std::string_view>> malformed; // chunk-relative line, text
+    size_t lineCount = 0;
+    std::vector<Patient> patients; // Built from rows in the chunk's own arena
+};
+
+// Split [start, data.size()) into roughly equal ranges that each end on a line boundary
+std::vector<size_t> splitAtLines(std::string_view data, size_t start, size_t minChunkBytes) {
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t bodySize = data.size() - start;
+    size_t chunkCount = std::max<size_t>(1, std::min(workers, bodySize / minChunkBytes));
+    size_t target = bodySize / chunkCount;
+    
+    std::vector<size_t> boundaries{start};
+    for (size_t c = 1; c < chunkCount; ++c) {
+        size_t newline = data.find('\n', std::max(boundaries.back(), start + c * target));
+        if (newline == std::string_view::npos) break;
+        if (newline + 1 > boundaries.back()) {
+            boundaries.push_back(newline + 1);
+        }
+    }
+    boundaries.push_back(data.size());
+    return boundaries;
+}
+
+// Restrict an incremental read to complete lines so a row still being written
+// by another process is picked up by the next append instead of half-parsed
+std::string_view completeLines(std::string_view data, size_t startOffset) {
+    if (startOffset == 0) {
+        return data;
+    }
+    size_t lastNewline = data.rfind('\n');
+    if (lastNewline == std::string_view::npos || lastNewline < startOffset) {
+        return data.substr(0, startOffset);
+    }
+    return data.substr(0, lastNewline + 1);
+}
+
+size_t fileSize(const std::string& filename) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(filename, ec);
+    return ec ? 0 : static_cast<size_t>(size);
+}
+
+// Write-ahead log records are tab-separated lines:
+//   G <geneId> <score> <label>
+//   P <id> <name> <age> <riskScore> <prediction> <geneCount> [<geneId> <score> <label>]...
+void appendLogField(std::string& record, std::string_view field) {
+    record.push_back('\t');
+    for (char c : field) {
+        record.push_back((c == '\t' || c == '\n' || c == '\r') ? ' ' : c);
+    }
+}
+
+template <typename Number>
+void appendLogNumber(std::string& record, Number value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    record.push_back('\t');
+    record.append(buffer, result.ptr);
+}
+
+void appendGeneFields(std::string& record, const GeneticData& data) {
+    appendLogField(record, data.getGeneId());
+    appendLogNumber(record, data.getMutationScore());
+    appendLogNumber(record, data.getLabel());
+}
+
+// Sequential tab-separated field reader for write-ahead log records
+class LogFieldReader {
+private:
+    std::string_view record;
+    size_t position;
+    
+public:
+    explicit LogFieldReader(std::string_view record) : record(record), position(0) {}
+    
+    bool next(std::string_view& field) {
+        if (position > record.size()) return false;
+        size_t tab = record.find('\t', position);
+        size_t end = (tab == std::string_view::npos) ? record.size() : tab;
+        field = record.substr(position, end - position);
+        position = end + 1;
+        return true;
+    }
+    
+    template <typename Number>
+    bool nextNumber(Number& value) {
+        std::string_view field;
+        if (!next(field)) return false;
+        auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+        return result.ec == std::errc() && result.ptr == field.data() + field.size();
+    }
     
+    bool nextGene(GeneticData& data) {
+        std::string_view geneId;
+        double score = 0.0;
+        int label = 0;
+        if (!next(geneId) || !nextNumber(score) || !nextNumber(label)) return false;
+        data = GeneticData(geneId, score, label);
+        return true;
+    }
+};
+
+// A rewrite of the data files commits once "<genesFile>.commit" names the
+// staged contents of both (by checksum) and the log prefix they hold:
+//   C <patientsFile> <logFile> <logId> <logBytes> <genesChecksum> <patientsChecksum>
+struct DataFileCommit {
+    std::string patientsFile;
+    std::string logFile; // Empty if no log records were folded
+    uint64_t logId = 0;
+    uint64_t logBytes = 0;
+    uint64_t genesChecksum = 0;
+    uint64_t patientsChecksum = 0;
+};
+
+std::string commitRecordFile(const std::string& genesFile) {
+    return genesFile + ".commit";
+}
+
+std::string encodeCommitRecord(const DataFileCommit& commit) {
+    std::string record = "C";
+    appendLogField(record, commit.patientsFile);
+    appendLogField(record, commit.logFile);
+    appendLogNumber(record, commit.logId);
+    appendLogNumber(record, commit.logBytes);
+    appendLogNumber(record, commit.genesChecksum);
+    appendLogNumber(record, commit.patientsChecksum);
+    record.push_back('\n');
+    return record;
+}
+
+bool readCommitRecord(const std::string& genesFile, DataFileCommit& commit) {
+    MappedFile file;
+    if (!file.open(commitRecordFile(genesFile))) {
+        return false;
+    }
+    std::string_view contents = file.view();
+    LogFieldReader reader(contents.substr(0, contents.find('\n')));
+    std::string_view type, patientsFile, logFile;
+    if (!reader.next(type) || type != "C" || !reader.next(patientsFile) || !reader.next(logFile) ||
+        !reader.nextNumber(commit.logId) || !reader.nextNumber(commit.logBytes) ||
+        !reader.nextNumber(commit.genesChecksum) || !reader.nextNumber(commit.patientsChecksum)) {
+        return false;
+    }
+    commit.patientsFile = patientsFile;
+    commit.logFile = logFile;
+    return true;
+}
+
+// Rename a staged data file into place if it is the one the commit record
+// names; a staged file that does not match never committed and is dropped
+void rollForwardStagedFile(const std::string& filename, uint64_t checksum) {
+    bool committed;
+    {
+        MappedFile staged;
+        if (!staged.open(filename + ".tmp")) {
+            return;
+        }
+        committed = payloadChecksum(staged.view()) == checksum;
+    }
+    if (!committed) {
+        discardStagedFile(filename);
+    } else if (commitStagedFile(filename)) {
+        CDS_LOG_WARN("Completed interrupted rewrite of " << filename);
+    } else {
+        CDS_LOG_ERROR("Could not complete interrupted rewrite of " << filename);
+    }
+}
+
+// Identity of a source CSV as recorded in snapshots
+int64_t fileModifiedTime(const std::string& filename) {
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(filename, ec);
+    return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+// Run task(0..count-1), one thread per task, on the calling thread when count is 1
+template <typename Task>
+void runParallel(size_t count, Task task) {
+    if (count <= 1) {
+        if (count == 1) task(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(count - 1);
+    for (size_t i = 1; i < count; ++i) {
+        workers.emplace_back(task, i);
+    }
+    task(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Instruments in Metrics::global(), shared by every system in the process
+struct SystemMetrics {
+    LatencyHistogram* inferenceTime[4]; // By ModelType
+    LatencyHistogram* dataFileWriteTime;
+    Gauge* lastLoadDuration;
+    Gauge* lastTrainingDuration;
+};
+
+const SystemMetrics& systemMetrics() {
+    static const SystemMetrics metrics = [] {
+        Metrics& registry = Metrics::global();
+        SystemMetrics m;
+        using ModelType = CancerDiagnosisSystem::ModelType;
+        for (ModelType model : {ModelType::LOGISTIC, ModelType::KNN, ModelType::DECISION_TREE, ModelType::NAIVE_BAYES}) {
+            m.inferenceTime[static_cast<size_t>(model)] = &registry.histogram(
+                "cds_model_inference_seconds", std::string("model=\"") + CancerDiagnosisSystem::modelName(model) + "\"", 
+                "Time to score one patient, or one batch of patients, with a model");
+        }
+        m.dataFileWriteTime = &registry.histogram("cds_save_data_seconds", "", 
+            "Time spent writing the CSV data files (saveDataToFiles, background flushes and log compaction)");
+        m.lastLoadDuration = &registry.gauge("cds_last_load_seconds", "", 
+            "Duration of the last load or append from the CSV files, training included");
+        m.lastTrainingDuration = &registry.gauge("cds_last_training_seconds", "", 
+            "Duration of the last model training");
+        return m;
+    }();
+    return metrics;
+}
+
+} // namespace
+
+CancerDiagnosisSystem::ModelSet::ModelSet() 
+    : logisticModel(std::make_unique<LogisticRegressionModel>(0.01, 1000)), 
+      knnModel(std::make_unique<KNNClassifier>(5)), 
+      decisionTreeModel(std::make_unique<DecisionTreeClassifier>(10, 2)), 
+      naiveBayesModel(std::make_unique<NaiveBayesClassifier>()), 
+      trained(false), 
+      version(nextModelSetVersion.fetch_add(1, std::memory_order_relaxed)) {}
+
+CancerDiagnosisSystem::CancerDiagnosisSystem() 
+    : testRequestQueue(std::make_unique<TestScheduler<DiagnosisRequest>>(kDiagnosisQueueCapacity, 
+                                                                           SchedulingMode::FIFO)), 
+      pendingDiagnoses(), diagnosisBatch(0), models(std::make_shared<const ModelSet>()), 
+      trainingGeneration(0), modelsGeneration(0), dataVersion(0), 
+      diagnosisCache(kDiagnosisCacheCapacity), 
+      genesFileOffset(0), patientsFileOffset(0) {
     // Initialize mutation mapper with default mappings
     mutationMapper.setLabelCategory(0, "Non-Cancerous");
     mutationMapper.setLabelCategory(1, "Cancerous");
 }
 
 CancerDiagnosisSystem::~CancerDiagnosisSystem() {
-    // Clean up linked list
-    while (patientHistoryHead) {
-        auto temp = patientHistoryHead;
-        patientHistoryHead = patientHistoryHead->next;
-        // Shared pointer will handle deletion automatically
-    }
+    diagnosisWorkers.reset();
+    // Final flush of pending changes while the rest of the system is still alive
+    persistenceWorker.reset();
 }
 
-void CancerDiagnosisSystem::loadGeneticDataFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return;
+size_t CancerDiagnosisSystem::loadGeneticDataFromFile(const std::string& filename, size_t startOffset, 
+                                                      GeneticDataTable& genes, HashMapper& mapper) const {
+    MappedFile file;
+    if (!file.open(filename)) {
+        CDS_LOG_ERROR("Could not open " << filename);
+        return startOffset;
     }
     
-    std::string line;
-    bool isFirstLine = true;
+    std::string_view contents = completeLines(file.view(), startOffset);
+    size_t recordsBefore = genes.size();
     
-    while (std::getline(file, line)) {
-        if (isFirstLine) {
-            isFirstLine = false;
-            continue; // Skip header
-        }
-        
+    // One record per line, so the newline count bounds the number of rows
+    size_t lineCount = std::count(contents.begin() + startOffset, contents.end(), '\n') + 1;
+    genes.reserve(genes.size() + lineCount);
+    mapper.reserve(mapper.size() + lineCount);
+    
+    CsvScanner scanner(contents, startOffset);
+    std::string_view line;
+    std::string_view fields[3];
+    size_t malformedRows = 0;
+    
+    // Skip header (only present when reading from the start of the file)
+    if (startOffset == 0) {
+        scanner.nextLine(line);
+    }
+    
+    while (scanner.nextLine(line)) {
         if (line.empty()) continue;
         
-        std::stringstream ss(line);
-        std::string geneId, mutationScoreStr, labelStr;
-        
-        if (std::getline(ss, geneId, ',') &&
-            std::getline(ss, mutationScoreStr, ',') &&
-            std::getline(ss, labelStr, ',')) {
-            
-            try {
-                double mutationScore = std::stod(mutationScoreStr);
-                int label = std::stoi(labelStr);
-                
-                GeneticData data(geneId, mutationScore, label);
-                geneticDataArray.push_back(data);
-                
-                // Add to mutation mapper
-                mutationMapper.addMutationMapping(geneId, mutationScore);
-            } catch (const std::exception&) {
-                std::cerr << "Error parsing line: " << line << std::endl;
-            }
+        double mutationScore = 0.0;
+        int label = 0;
+        if (!CsvScanner::splitFields(line, fields, 3) ||
+            !CsvScanner::parseDouble(fields[1], mutationScore) ||
+            !CsvScanner::parseInt(fields[2], label)) {
+            CDS_LOG_LIMITED(LogLevel::WARN, 10, filename << " line " << scanner.getLineNumber()
+                                                << " not parsed: " << line);
+            malformedRows++;
+            continue;
         }
+        
+        Symbol geneId(fields[0]);
+        mapper.addMutationMapping(geneId, mutationScore);
+        genes.append(geneId, mutationScore, label);
     }
     
-    file.close();
-    std::cout << "Loaded " << geneticDataArray.size() << " genetic data records." << std::endl;
+    if (malformedRows > 0) {
+        CDS_LOG_WARN("Skipped " << malformedRows << " malformed rows in " << filename);
+    }
+    CDS_LOG_INFO("Loaded " << genes.size() - recordsBefore << " genetic records from " << filename);
+    return scanner.offset();
 }
 
-void CancerDiagnosisSystem::loadPatientsFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return;
+size_t CancerDiagnosisSystem::loadPatientsFromFile(const std::string& filename, size_t startOffset, 
+                                                   const GeneticDataTable& genes, PatientStore& patients, 
+                                                   std::vector<uint32_t>& fileRows) const {
+    MappedFile file;
+    if (!file.open(filename)) {
+        CDS_LOG_ERROR("Could not open " << filename);
+        return startOffset;
     }
     
-    std::string line;
-    bool isFirstLine = true;
-    size_t patientIndex = 0; // Track patient index for genetic data assignment
+    std::string_view contents = completeLines(file.view(), startOffset);
     
-    while (std::getline(file, line)) {
-        if (isFirstLine) {
-            isFirstLine = false;
-            continue; // Skip header
-        }
-        
-        if (line.empty()) continue;
-        
-        std::stringstream ss(line);
-        std::string patientId, name, ageStr;
+    // Skip header (only present when reading from the start of the file)
+    size_t bodyStart = startOffset;
+    if (startOffset == 0) {
+        size_t headerEnd = contents.find('\n');
+        bodyStart = (headerEnd == std::string_view::npos) ? contents.size() : headerEnd + 1;
+    }
+    
+    // Split the body into newline-aligned chunks, one per worker
+    std::vector<size_t> boundaries = splitAtLines(contents, bodyStart, kMinPatientChunkBytes);
+    size_t chunkCount = boundaries.size() - 1;
+    std::vector<PatientChunk> chunks(chunkCount);
+    
+    runParallel(chunkCount, [&](size_t c) {
+        std::string_view chunkData = contents.substr(0, boundaries[c + 1]);
+        CsvScanner scanner(chunkData, boundaries[c]);
+        std::string_view line;
+        std::string_view fields[3];
+        PatientChunk& chunk = chunks[c];
         
-        if (std::getline(ss, patientId, ',') &&
-            std::getline(ss, name, ',') &&
-            std::getline(ss, ageStr, ',')) {
+        while (scanner.nextLine(line)) {
+            if (line.empty()) continue;
+            
+            int age = 0;
+            if (!CsvScanner::splitFields(line, fields, 3) ||
+                !CsvScanner::parseInt(fields[2], age)) {
+                chunk.malformed.push_back({scanner.getLineNumber(), line});
+                continue;
+            }
+            chunk.rows.push_back({fields[0], fields[1], age});
+        }
+        chunk.lineCount = scanner.getLineNumber();
+    });
+    
+    // Report malformed rows by line number within this read (header is line 1 on full loads)
+    size_t firstLine = (startOffset == 0) ? 2 : 1;
+    size_t totalRows = 0;
+    size_t malformedRows = 0;
+    for (const auto& chunk : chunks) {
+        for (const auto& bad : chunk.malformed) {
+            CDS_LOG_LIMITED(LogLevel::WARN, 10, filename << " line " << firstLine + bad.first - 1
+                                                << " not parsed: " << bad.second);
+        }
+        firstLine += chunk.lineCount;
+        totalRows += chunk.rows.size();
+        malformedRows += chunk.malformed.size();
+    }
+    if (malformedRows > 0) {
+        CDS_LOG_WARN("Skipped " << malformedRows << " malformed rows in " << filename);
+    }
+    
+    // Build patients in parallel; each row's gene assignment depends only on
+    // its position in file order, which matches the serial loader exactly
+    std::vector<size_t> chunkFirstRow(chunkCount, fileRows.size());
+    for (size_t c = 1; c < chunkCount; ++c) {
+        chunkFirstRow[c] = chunkFirstRow[c - 1] + chunks[c - 1].rows.size();
+    }
+    
+    // Each worker allocates from its own arena of the store's current epoch
+    std::vector<Patient::allocator_type> chunkAllocators;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        chunkAllocators.push_back(c == 0 ? patients.get_allocator() : patients.createArena());
+    }
+    
+    runParallel(chunkCount, [&](size_t c) {
+        size_t rowIndex = chunkFirstRow[c];
+        std::vector<Patient>& chunkPatients = chunks[c].patients;
+        chunkPatients.reserve(chunks[c].rows.size());
+        for (const auto& row : chunks[c].rows) {
+            Patient& patient = chunkPatients.emplace_back(row.patientId, row.name, row.age, chunkAllocators[c]);
             
-            try {
-                int age = std::stoi(ageStr);
-                Patient patient(patientId, name, age);
+            // Add a subset of genetic data to each patient (not all genes)
+            // This ensures each patient has unique genetic profiles for different predictions.
+            // Rows are numbered in `genes` but refer to the live table, which
+            // is `genes` itself or is replaced by it when a load commits.
+            if (!genes.empty()) {
+                size_t dataStart = rowIndex % genes.size();
+                size_t dataCount = std::min(static_cast<size_t>(5), genes.size()); // Each patient gets ~5 genes
                 
-                // Add a subset of genetic data to each patient (not all genes)
-                // This ensures each patient has unique genetic profiles for different predictions
-                if (!geneticDataArray.empty()) {
-                    size_t dataStart = patientIndex % geneticDataArray.size();
-                    size_t dataCount = std::min(static_cast<size_t>(5), geneticDataArray.size()); // Each patient gets ~5 genes
-                    
-                    for (size_t i = 0; i < dataCount; ++i) {
-                        size_t idx = (dataStart + i) % geneticDataArray.size();
-                        patient.addGeneticData(geneticDataArray[idx]);
-                    }
-                    patientIndex++;
+                for (size_t i = 0; i < dataCount; ++i) {
+                    size_t idx = (dataStart + i) % genes.size();
+                    patient.addGeneticDataRow(geneticData, idx);
                 }
-                
-                addPatientToHistory(patient);
-            } catch (const std::exception&) {
-                std::cerr << "Error parsing line: " << line << std::endl;
             }
+            rowIndex++;
+        }
+    });
+    
+    patients.reserve(patients.size() + totalRows);
+    fileRows.reserve(fileRows.size() + totalRows);
+    for (auto& chunk : chunks) {
+        for (auto& patient : chunk.patients) {
+            Symbol patientId = patient.getPatientSymbol();
+            size_t position = patients.size();
+            if (!patients.upsert(std::move(patient))) {
+                position = patients.positionOf(*patients.find(patientId.str())); // Repeated ID
+            }
+            fileRows.push_back(static_cast<uint32_t>(position));
         }
     }
     
-    file.close();
+    CDS_LOG_INFO("Read " << totalRows << " patient rows from " << filename);
+    return boundaries.back();
 }
 
 void CancerDiagnosisSystem::loadData(const std::string& genesFile, 
                                      const std::string& patientsFile) {
-    std::cout << "\n=== Loading Data ===" << std::endl;
-
-    // Clear existing in-memory data to avoid duplication when loading multiple times
-    geneticDataArray.clear();
-    // Reset patient history linked list
-    patientHistoryHead = nullptr;
-    // Clear any pending test requests
-    while (!testRequestQueue.empty()) testRequestQueue.pop();
-    // Reset mutation mapper and preprocessing state
-    mutationMapper = HashMapper();
-    preprocessor.reset();
-    // Clear training buffers and flags
-    X_train.clear();
-    y_train.clear();
-    modelsTrained = false;
-
-    loadGeneticDataFromFile(genesFile);
-    loadPatientsFromFile(patientsFile);
-    
-    std::cout << "\n=== Data Summary ===" << std::endl;
-    std::cout << "Genetic records loaded: " << geneticDataArray.size() << std::endl;
-    std::cout << "Patient records loaded: " << getPatientCount() << std::endl;
-    
-    if (geneticDataArray.empty()) {
-        std::cerr << "\n✗ ERROR: No genetic data loaded! Cannot train models." << std::endl;
-        std::cerr << "  Please check that " << genesFile << " exists and contains data." << std::endl;
-        modelsTrained = false;
-        return;
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    loadFromFiles(genesFile, patientsFile);
+}
+
+void CancerDiagnosisSystem::loadFromFiles(const std::string& genesFile, 
+                                          const std::string& patientsFile) {
+    ScopedTimer timer(*systemMetrics().lastLoadDuration);
+    CDS_LOG_INFO("Loading " << genesFile << " and " << patientsFile);
+    recoverDataFiles(genesFile, patientsFile);
+
+    // Build the new data and models on the side; the live system keeps
+    // serving (and taking additions, which reach the log) until the commit
+    LoadedData data;
+    data.genesFileOffset = loadGeneticDataFromFile(genesFile, 0, data.geneticData, data.mutationMapper);
+    data.patientsFileOffset = loadPatientsFromFile(patientsFile, 0, data.geneticData, 
+                                                   data.patientHistory, data.patientFileRows);
+    
+    // Re-apply changes logged since the base files were last compacted
+    bool replayLog = writeAheadLog && genesFile == logGenesFile && patientsFile == logPatientsFile;
+    size_t replayed = replayLog ? replayWriteAheadLog(data) : 0;
+    
+    bool hasData = !data.geneticData.empty();
+    std::shared_ptr<const ModelSet> loadedModels;
+    if (!hasData) {
+        CDS_LOG_ERROR("No genetic data loaded from " << genesFile << "; models not trained");
+        loadedModels = std::make_shared<const ModelSet>();
+    } else {
+        loadedModels = trainModels(data.geneticData);
     }
+    bool trained = loadedModels->trained;
+    size_t genesLoaded = 0;
+    size_t patientsLoaded = 0;
     
-    prepareTrainingData();
-    trainAllModels();
+    {
+        std::lock_guard<std::shared_mutex> lock(stateMutex);
+        if (replayLog) {
+            replayed += replayWriteAheadLog(data); // Logged while we were building
+        }
+        genesLoaded = data.geneticData.size();
+        patientsLoaded = data.patientHistory.size();
+        commitLoadedData(data, std::move(loadedModels), genesFile, patientsFile);
+    }
+    
+    // Fold replayed changes in so the files on disk match memory again
+    if (replayed > 0) {
+        foldWriteAheadLog("");
+    }
     
-    if (modelsTrained) {
-        std::cout << "\n✓ System ready for diagnosis!" << std::endl;
+    if (!hasData) {
+        return;
+    }
+    if (trained) {
+        CDS_LOG_INFO("Ready for diagnosis: " << genesLoaded << " genetic records, " << patientsLoaded
+                     << " patients");
     } else {
-        std::cerr << "\n✗ WARNING: Models were not trained successfully!" << std::endl;
+        CDS_LOG_WARN("Models were not trained; diagnoses will score 0");
+    }
+}
+
+void CancerDiagnosisSystem::commitLoadedData(LoadedData& data, std::shared_ptr<const ModelSet> loadedModels, 
+                                             const std::string& genesFile, const std::string& patientsFile) {
+    // Tests queued against the old data are dropped
+    discardQueuedTests();
+    
+    geneticData = std::move(data.geneticData);
+    mutationMapper = std::move(data.mutationMapper);
+    // The old records end up in `data` and are released by the caller,
+    // after the lock
+    patientHistory.swap(data.patientHistory);
+    genesFileOffset = data.genesFileOffset;
+    patientsFileOffset = data.patientsFileOffset;
+    patientFileRows.swap(data.patientFileRows);
+    loadedGenesFile = genesFile;
+    loadedPatientsFile = patientsFile;
+    modelsGeneration = ++trainingGeneration; // Supersedes any retrain still running
+    publishModels(std::move(loadedModels));
+    markDataChanged();
+    diagnosisCache.clear(); // No cached score can match the new patients or models
+}
+
+bool CancerDiagnosisSystem::appendData(const std::string& genesFile, 
+                                       const std::string& patientsFile) {
+    std::unique_lock<std::mutex> loadLock(loadMutex);
+    ScopedTimer timer(*systemMetrics().lastLoadDuration);
+    
+    // Offsets are only meaningful for the files we last read; anything else
+    // (or a file that shrank because it was rewritten) needs a full reload.
+    // Both only change under loadMutex, so the answer holds until we append.
+    bool fullReload;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        fullReload = genesFile != loadedGenesFile || patientsFile != loadedPatientsFile ||
+                     fileSize(genesFile) < genesFileOffset || fileSize(patientsFile) < patientsFileOffset;
+    }
+    if (fullReload) {
+        loadFromFiles(genesFile, patientsFile);
+        return false;
     }
+    
+    // Models are retrained off the lock on a copy of the table, like a full load
+    std::optional<GeneticDataTable> staged;
+    uint64_t stagedGeneration = 0;
+    {
+        std::lock_guard<std::shared_mutex> lock(stateMutex);
+        size_t genesBefore = geneticData.size();
+        size_t patientsBefore = patientFileRows.size();
+        genesFileOffset = loadGeneticDataFromFile(genesFile, genesFileOffset, geneticData, mutationMapper);
+        patientsFileOffset = loadPatientsFromFile(patientsFile, patientsFileOffset, geneticData, 
+                                                  patientHistory, patientFileRows);
+        
+        CDS_LOG_INFO("Appended " << geneticData.size() - genesBefore << " genetic records and "
+                     << patientFileRows.size() - patientsBefore << " patients");
+        
+        // Models are trained on genetic data only, so patient-only deltas need no retraining
+        if (geneticData.size() != genesBefore || !currentModels()->trained) {
+            staged.emplace(geneticData);
+            stagedGeneration = ++trainingGeneration;
+        }
+        markDataChanged();
+    }
+    loadLock.unlock();
+    
+    if (staged) {
+        // Readers, writers and other loads carry on while the models are
+        // retrained; only publishing them takes the lock. If a load or
+        // append staged a newer table meanwhile, its models win.
+        std::shared_ptr<const ModelSet> retrained = trainModels(*staged);
+        std::lock_guard<std::shared_mutex> lock(stateMutex);
+        if (stagedGeneration > modelsGeneration) {
+            modelsGeneration = stagedGeneration;
+            publishModels(std::move(retrained));
+            markDataChanged();
+        }
+    }
+    return true;
 }
 
 void CancerDiagnosisSystem::addPatient(const Patient& patient) {
-    Patient patientCopy = patient;
-    addPatientToHistory(patientCopy);
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    recordPatient(patient);
 }
 
 void CancerDiagnosisSystem::addPatientToHistory(const Patient& patient) {
-    auto newNode = std::make_shared<PatientNode>(patient);
-    newNode->next = patientHistoryHead;
-    patientHistoryHead = newNode;
+    patientHistory.upsert(patient);
 }
 
 void CancerDiagnosisSystem::addGeneticData(const GeneticData& data) {
-    geneticDataArray.push_back(data);
-    mutationMapper.addMutationMapping(data.getGeneId(), data.getMutationScore());
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    
+    geneticData.append(data);
+    mutationMapper.addMutationMapping(data.getGeneSymbol(), data.getMutationScore());
+    markDataChanged();
+    
+    if (writeAheadLog) {
+        std::string record = "G";
+        appendGeneFields(record, data);
+        writeAheadLog->append(record);
+    }
+    if (persistenceWorker) {
+        persistenceWorker->markDirty();
+    }
 }
 
-void CancerDiagnosisSystem::scheduleTest(const Patient& patient) {
-    testRequestQueue.push(patient);
+void CancerDiagnosisSystem::recordPatient(const Patient& patient) {
+    addPatientToHistory(patient);
+    markDataChanged();
+    
+    if (writeAheadLog) {
+        GeneticDataView genes = patient.getGeneticData();
+        std::string record = "P";
+        appendLogField(record, patient.getPatientId());
+        appendLogField(record, patient.getName());
+        appendLogNumber(record, patient.getAge());
+        appendLogNumber(record, patient.getRiskScore());
+        appendLogNumber(record, patient.getPrediction());
+        appendLogNumber(record, genes.size());
+        for (const auto& data : genes) {
+            appendGeneFields(record, data);
+        }
+        writeAheadLog->append(record);
+    }
+    if (persistenceWorker) {
+        persistenceWorker->markDirty();
+    }
 }
 
-void CancerDiagnosisSystem::processTestQueue() {
-    std::cout << "\n=== Processing Test Queue ===" << std::endl;
-    int count = 0;
-    
-    while (!testRequestQueue.empty()) {
-        Patient patient = testRequestQueue.front();
-        testRequestQueue.pop();
-        
-        // Perform diagnosis using default model (Logistic Regression)
-        double riskScore = diagnosePatient(patient, ModelType::LOGISTIC);
-        patient.setRiskScore(riskScore);
-        patient.setPrediction(riskScore >= 0.5 ? 1 : 0);
-        
-        addPatientToHistory(patient);
-        count++;
-        
-        std::cout << "Processed patient: " << patient.getName() 
-                  << " - Risk Score: " << std::fixed << std::setprecision(4) << riskScore << std::endl;
+bool CancerDiagnosisSystem::scheduleTest(const Patient& patient, ModelType model, 
+                                         std::optional<TestPriority> priority, 
+                                         std::optional<std::chrono::milliseconds> deadline) {
+    {
+        std::lock_guard<std::shared_mutex> lock(stateMutex);
+        if (!patientHistory.contains(patient.getPatientId())) {
+            recordPatient(patient);
+        }
+    }
+    return scheduleTest(patient.getPatientId(), model, priority.value_or(defaultPriority(patient)), deadline);
+}
+
+bool CancerDiagnosisSystem::scheduleTest(std::string_view patientId, ModelType model, 
+                                         std::optional<TestPriority> priority, 
+                                         std::optional<std::chrono::milliseconds> deadline) {
+    if (!priority) {
+        priority = TestPriority::NORMAL;
+        if (testRequestQueue->getMode() == SchedulingMode::DEADLINE) {
+            std::shared_lock<std::shared_mutex> lock(stateMutex);
+            if (const Patient* stored = patientHistory.find(patientId)) {
+                priority = defaultPriority(*stored);
+            }
+        }
     }
     
-    std::cout << "Processed " << count << " patients from queue." << std::endl;
-    std::cout << "============================\n" << std::endl;
+    using Duration = TestScheduler<DiagnosisRequest>::Clock::duration;
+    Duration due = deadline ? std::chrono::duration_cast<Duration>(*deadline) : Duration::max();
+    uint8_t batch = static_cast<uint8_t>(diagnosisBatch.load() & 1);
+    pendingDiagnoses[batch].fetch_add(1);
+    if (!testRequestQueue->push({Symbol(PatientStore::normalizeId(patientId)), model, batch}, *priority, due)) {
+        finishDiagnosis(batch);
+        return false;
+    }
+    if (diagnosisWorkers) {
+        diagnosisWorkers->notify();
+    }
+    return true;
 }
 
-int CancerDiagnosisSystem::processTestQueueAndReturnCount() {
-    std::cout << "\n=== Processing Test Queue (API) ===" << std::endl;
-    int count = 0;
+void CancerDiagnosisSystem::startDiagnosisWorkers(size_t workerCount) {
+    stopDiagnosisWorkers();
+    if (workerCount > 0) {
+        diagnosisWorkers = std::make_unique<DiagnosisWorkerPool>(workerCount, [this] {
+            return processNextDiagnosis();
+        });
+    }
+}
 
-    while (!testRequestQueue.empty()) {
-        Patient patient = testRequestQueue.front();
-        testRequestQueue.pop();
+void CancerDiagnosisSystem::stopDiagnosisWorkers() {
+    diagnosisWorkers.reset();
+}
 
-        double riskScore = diagnosePatient(patient, ModelType::LOGISTIC);
-        patient.setRiskScore(riskScore);
-        patient.setPrediction(riskScore >= 0.5 ? 1 : 0);
+TestPriority CancerDiagnosisSystem::defaultPriority(const Patient& patient) {
+    if (patient.getAge() >= 65 || patient.getRiskScore() >= 0.5) {
+        return TestPriority::HIGH;
+    }
+    return TestPriority::NORMAL;
+}
 
-        addPatientToHistory(patient);
-        count++;
+bool CancerDiagnosisSystem::setSchedulingMode(SchedulingMode mode) {
+    if (mode == testRequestQueue->getMode()) {
+        return true;
+    }
+    if (!testRequestQueue->empty()) {
+        return false;
+    }
+    testRequestQueue = std::make_unique<TestScheduler<DiagnosisRequest>>(kDiagnosisQueueCapacity, mode);
+    return true;
+}
 
-        std::cout << "Processed patient: " << patient.getName()
-                  << " - Risk Score: " << std::fixed << std::setprecision(4) << riskScore << std::endl;
+SchedulingMode CancerDiagnosisSystem::getSchedulingMode() const {
+    return testRequestQueue->getMode();
+}
+
+bool CancerDiagnosisSystem::processNextDiagnosis() {
+    DiagnosisRequest request;
+    if (!testRequestQueue->pop(request)) {
+        return false;
     }
+    runDiagnosis(request, std::nullopt);
+    return true;
+}
 
-    std::cout << "Processed " << count << " patients from queue." << std::endl;
-    std::cout << "============================\n" << std::endl;
-    return count;
+void CancerDiagnosisSystem::runDiagnosis(DiagnosisRequest request, std::optional<ModelType> model) {
+    DiagnosisResult result{request.patientId.str(), "", model.value_or(request.model), 0.0, 0, false};
+    double features[kFeatureCount];
+    std::shared_ptr<const ModelSet> modelSet;
+    {
+        // Read the patient under the shared lock so workers run in parallel...
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        if (const Patient* stored = patientHistory.find(result.patientId)) {
+            modelSet = currentModels();
+            extractFeatures(*stored, *modelSet, features);
+            result.name = stored->getName();
+            result.found = true;
+        }
+    }
+    if (result.found) {
+        // ...score it on the model set we read it with, holding no lock...
+        result.riskScore = scoreFeatures(*modelSet, features, result.model);
+        result.prediction = result.riskScore >= 0.5 ? 1 : 0;
+    }
+    {
+        // ...and record the outcome on whatever is stored under the ID now
+        std::lock_guard<std::shared_mutex> lock(stateMutex);
+        const Patient* stored = result.found ? patientHistory.find(result.patientId) : nullptr;
+        if (stored) {
+            Patient patient(*stored);
+            patient.setRiskScore(result.riskScore);
+            patient.setPrediction(result.prediction);
+            recordPatient(patient);
+        }
+        completedDiagnoses.push_back(std::move(result));
+        if (completedDiagnoses.size() > kMaxCompletedDiagnoses) {
+            completedDiagnoses.pop_front();
+        }
+    }
+    finishDiagnosis(request.batch);
 }
 
-size_t CancerDiagnosisSystem::getQueueSize() const {
-    return testRequestQueue.size();
+void CancerDiagnosisSystem::finishDiagnosis(uint8_t batch) {
+    if (pendingDiagnoses[batch].fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(diagnosisMutex);
+        diagnosisDone.notify_all();
+    }
 }
 
-std::vector<std::string> CancerDiagnosisSystem::getQueuedPatientIds() const {
-    std::vector<std::string> ids;
-    auto q = testRequestQueue; // copy
-    while (!q.empty()) {
-        ids.push_back(q.front().getPatientId());
-        q.pop();
+void CancerDiagnosisSystem::discardQueuedTests() {
+    DiagnosisRequest request;
+    while (testRequestQueue->pop(request)) {
+        finishDiagnosis(request.batch);
     }
-    return ids;
 }
 
-std::vector<std::string> CancerDiagnosisSystem::processTestQueueWithModel(ModelType model) {
-    std::cout << "\n=== Processing Test Queue with Model (API) ===" << std::endl;
-    std::vector<std::string> results; // JSON lines for each diagnosis
-    int count = 0;
+std::vector<CancerDiagnosisSystem::DiagnosisResult> 
+CancerDiagnosisSystem::collectDiagnoses(std::optional<ModelType> model) {
+    std::lock_guard<std::mutex> collectLock(collectMutex);
+    // Close the current batch: tests scheduled from here on count towards the
+    // next one. The previous call drained the slot they move to.
+    std::atomic<size_t>& pending = pendingDiagnoses[diagnosisBatch.fetch_add(1) & 1];
+    DiagnosisRequest request;
+    auto drained = [&] { return pending.load() == 0; };
+    while (!drained()) {
+        // Help the workers (or stand in for them) with whatever is queued
+        if (testRequestQueue->pop(request)) {
+            runDiagnosis(request, model);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(diagnosisMutex);
+        if (diagnosisWorkers) {
+            diagnosisDone.wait(lock, drained); // Tests still running on workers
+        } else {
+            // A producer is between counting and pushing, and pushing does
+            // not notify; look at the queue again shortly
+            diagnosisDone.wait_for(lock, std::chrono::milliseconds(1), drained);
+        }
+    }
+    
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    std::vector<DiagnosisResult> results(std::make_move_iterator(completedDiagnoses.begin()), 
+                                         std::make_move_iterator(completedDiagnoses.end()));
+    completedDiagnoses.clear();
+    return results;
+}
 
-    while (!testRequestQueue.empty()) {
-        Patient patient = testRequestQueue.front();
-        testRequestQueue.pop();
+void CancerDiagnosisSystem::processTestQueue() {
+    std::vector<DiagnosisResult> results = collectDiagnoses(std::nullopt);
+    // Per-patient lines are compiled out unless CDS_MIN_LOG_LEVEL admits DEBUG
+    for (const auto& result : results) {
+        if (!result.found) {
+            CDS_LOG_DEBUG("Skipped patient " << result.patientId << ": no longer stored");
+            continue;
+        }
+        CDS_LOG_DEBUG("Processed patient " << result.name << ", risk score " << result.riskScore);
+    }
+    
+    CDS_LOG_INFO("Processed " << results.size() << " patients from queue");
+}
 
-        double riskScore = diagnosePatient(patient, model);
-        int prediction = riskScore >= 0.5 ? 1 : 0;
-        patient.setRiskScore(riskScore);
-        patient.setPrediction(prediction);
+int CancerDiagnosisSystem::processTestQueueAndReturnCount() {
+    return static_cast<int>(collectDiagnoses(std::nullopt).size());
+}
 
-        addPatientToHistory(patient);
-        count++;
+size_t CancerDiagnosisSystem::getQueueSize() const {
+    return testRequestQueue->size();
+}
 
-        // Build JSON-like result string for this patient
-        std::ostringstream result;
-        result << "{\"patient_id\":\"" << patient.getPatientId() 
-               << "\",\"name\":\"" << patient.getName()
-               << "\",\"riskScore\":" << std::fixed << std::setprecision(4) << riskScore
-               << ",\"prediction\":" << prediction
-               << ",\"status\":\"processed\"}"; 
-        results.push_back(result.str());
+std::vector<std::string> CancerDiagnosisSystem::getQueuedPatientIds() const {
+    std::vector<std::string> ids;
+    testRequestQueue->forEach([&](const DiagnosisRequest& request) {
+        ids.push_back(request.patientId.str());
+    });
+    return ids;
+}
 
-        std::cout << "Processed patient: " << patient.getName()
-                  << " - Risk Score: " << std::fixed << std::setprecision(4) << riskScore 
-                  << " - Prediction: " << (prediction == 1 ? "CANCEROUS" : "NON-CANCEROUS") << std::endl;
-    }
+TestQueueStats CancerDiagnosisSystem::getQueueStats(TestPriority priority) const {
+    return testRequestQueue->getStats(priority);
+}
 
-    std::cout << "Processed " << count << " patients from queue." << std::endl;
-    std::cout << "====================================\n" << std::endl;
-    return results;
+std::vector<std::string> CancerDiagnosisSystem::processTestQueueWithModel(std::optional<ModelType> model) {
+    std::vector<DiagnosisResult> results = collectDiagnoses(model);
+    std::vector<std::string> lines; // JSON lines for each diagnosis
+    lines.reserve(results.size());
+    
+    for (const auto& result : results) {
+        // Build JSON-like result string for this patient
+        std::ostringstream line;
+        line << "{\"patient_id\":\"" << result.patientId 
+             << "\",\"name\":\"" << result.name
+             << "\",\"model\":\"" << modelName(result.model)
+             << "\",\"riskScore\":" << std::fixed << std::setprecision(4) << result.riskScore
+             << ",\"prediction\":" << result.prediction
+             << ",\"status\":\"" << (result.found ? "processed" : "not_found") << "\"}"; 
+        lines.push_back(line.str());
+    }
+    
+    CDS_LOG_INFO("Collected " << lines.size() << " diagnoses from queue");
+    return lines;
 }
 
-void CancerDiagnosisSystem::prepareTrainingData() {
-    X_train.clear();
-    y_train.clear();
+std::shared_ptr<const CancerDiagnosisSystem::ModelSet> 
+CancerDiagnosisSystem::trainModels(const GeneticDataTable& genes) {
+    ScopedTimer timer(*systemMetrics().lastTrainingDuration);
+    auto modelSet = std::make_shared<ModelSet>();
     
-    if (geneticDataArray.empty()) {
-        std::cerr << "\n✗ Warning: No genetic data available for training." << std::endl;
-        std::cerr << "  Please ensure genes.csv file contains valid data." << std::endl;
-        return;
+    if (genes.empty()) {
+        CDS_LOG_WARN("No genetic data available for training");
+        return modelSet;
     }
     
-    std::cout << "\nPreparing training data from " << geneticDataArray.size() << " genetic records..." << std::endl;
+    // The only feature is the mutation score; it is standardized straight
+    // from the table's score column into one flat buffer. Labels are read
+    // straight from the table.
+    std::span<const double> mutationScores = genes.mutationScoreColumn();
+    modelSet->preprocessor.fit(mutationScores);
+    std::vector<double> trainingFeatures(mutationScores.size());
+    modelSet->preprocessor.standardize(mutationScores, trainingFeatures);
+    
+    FeatureMatrix X_train(trainingFeatures, kFeatureCount);
+    std::span<const int> y_train = genes.labelColumn();
+    
+    CDS_LOG_INFO("Training models on " << X_train.rows() << " samples");
     
-    // Extract features from genetic data
-    for (const auto& data : geneticDataArray) {
-        std::vector<double> features;
-        features.push_back(data.getMutationScore());
-        // Can add more features here
+    try {
+        modelSet->logisticModel->fit(X_train, y_train);
+        CDS_LOG_DEBUG("Logistic regression trained");
+        modelSet->knnModel->fit(X_train, y_train);
+        CDS_LOG_DEBUG("KNN trained");
+        modelSet->decisionTreeModel->fit(X_train, y_train);
+        CDS_LOG_DEBUG("Decision tree trained");
+        modelSet->naiveBayesModel->fit(X_train, y_train);
+        CDS_LOG_DEBUG("Naive Bayes trained");
         
-        X_train.push_back(features);
-        y_train.push_back(data.getLabel());
+        modelSet->trained = true;
+        CDS_LOG_INFO("All models trained");
+    } catch (const std::exception& e) {
+        CDS_LOG_ERROR("Error training models: " << e.what());
     }
     
-    // Preprocess features
-    if (!X_train.empty()) {
-        std::vector<double> mutationScores;
-        for (const auto& features : X_train) {
-            mutationScores.push_back(features[0]);
+    return modelSet;
+}
+
+void CancerDiagnosisSystem::extractFeatures(const Patient& patient, const ModelSet& modelSet, 
+                                            std::span<double> features) const {
+    std::optional<double> tableMean;
+    extractFeatures(patient, modelSet, features, tableMean);
+}
+
+void CancerDiagnosisSystem::extractFeatures(const Patient& patient, const ModelSet& modelSet, 
+                                            std::span<double> features, std::optional<double>& tableMean) const {
+    // Use average mutation score of the patient's genetic data, or of all
+    // genetic data if the patient has none
+    GeneticDataView genes = patient.getGeneticData();
+    size_t count = genes.size();
+    if (count > 0) {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += genes.getMutationScore(i);
         }
-        
-        preprocessor.fit(mutationScores);
-        std::vector<double> normalized = preprocessor.standardize(mutationScores);
-        
-        // Update X_train with normalized values
-        for (size_t i = 0; i < X_train.size(); ++i) {
-            X_train[i][0] = normalized[i];
+        features[0] = sum / count;
+    } else {
+        if (!tableMean) {
+            double sum = 0.0;
+            for (double score : geneticData.mutationScoreColumn()) {
+                sum += score;
+            }
+            tableMean = geneticData.empty() ? 0.0 : sum / geneticData.size();
         }
+        features[0] = *tableMean;
     }
     
-    std::cout << "✓ Prepared " << X_train.size() << " training samples." << std::endl;
+    // Normalize features
+    if (modelSet.preprocessor.getIsFitted()) {
+        modelSet.preprocessor.standardize(features, features);
+    }
 }
 
-void CancerDiagnosisSystem::trainAllModels() {
-    if (X_train.empty() || y_train.empty()) {
-        std::cerr << "Warning: Cannot train models with empty training data." << std::endl;
-        std::cerr << "X_train size: " << X_train.size() << ", y_train size: " << y_train.size() << std::endl;
-        modelsTrained = false;
-        return;
+double CancerDiagnosisSystem::diagnosePatient(const Patient& patient, ModelType model) const {
+    double features[kFeatureCount];
+    std::shared_ptr<const ModelSet> modelSet;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        modelSet = currentModels();
+        extractFeatures(patient, *modelSet, features);
     }
-    
-    std::cout << "\n=== Training ML Models ===" << std::endl;
-    std::cout << "Training samples: " << X_train.size() << std::endl;
-    
-    modelsTrained = false;  // Reset flag
-    
-    try {
-        std::cout << "Training Logistic Regression..." << std::endl;
-        logisticModel->fit(X_train, y_train);
-        std::cout << "  ✓ Logistic Regression trained" << std::endl;
-        
-        std::cout << "Training KNN Classifier..." << std::endl;
-        knnModel->fit(X_train, y_train);
-        std::cout << "  ✓ KNN trained" << std::endl;
-        
-        std::cout << "Training Decision Tree..." << std::endl;
-        decisionTreeModel->fit(X_train, y_train);
-        std::cout << "  ✓ Decision Tree trained" << std::endl;
-        
-        std::cout << "Training Naive Bayes..." << std::endl;
-        naiveBayesModel->fit(X_train, y_train);
-        std::cout << "  ✓ Naive Bayes trained" << std::endl;
-        
-        modelsTrained = true;
-        std::cout << "\n✓ All models trained successfully!" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "\n✗ Error training models: " << e.what() << std::endl;
-        modelsTrained = false;
+    return scoreFeatures(*modelSet, features, model);
+}
+
+std::optional<CancerDiagnosisSystem::DiagnosisResult> 
+CancerDiagnosisSystem::diagnoseStoredPatient(std::string_view patientId, ModelType model) const {
+    DiagnosisResult result{"", "", model, 0.0, 0, true};
+    double features[kFeatureCount];
+    std::shared_ptr<const ModelSet> modelSet;
+    DiagnosisCache::Key key;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        const Patient* patient = patientHistory.find(patientId);
+        if (!patient) {
+            return std::nullopt;
+        }
+        result.patientId = patient->getPatientId();
+        result.name = patient->getName();
+        modelSet = currentModels();
+        // Patients without genetic data are scored on the mean of the whole
+        // table, so their scores also depend on its version
+        key = {patient->getPatientSymbol(), static_cast<uint32_t>(model), patientHistory.revisionOf(*patient), 
+               patient->getGeneticData().empty() ? getDataVersion() : 0, modelSet->version};
+        if (diagnosisCache.find(key, result.riskScore)) {
+            result.prediction = result.riskScore >= 0.5 ? 1 : 0;
+            return result;
+        }
+        extractFeatures(*patient, *modelSet, features);
     }
-    
-    std::cout << "=========================\n" << std::endl;
+    result.riskScore = scoreFeatures(*modelSet, features, model);
+    result.prediction = result.riskScore >= 0.5 ? 1 : 0;
+    if (modelSet->trained) {
+        diagnosisCache.store(key, result.riskScore);
+    }
+    return result;
 }
 
-std::vector<double> CancerDiagnosisSystem::extractFeatures(const Patient& patient) const {
+std::vector<CancerDiagnosisSystem::DiagnosisResult> 
+CancerDiagnosisSystem::diagnoseBatch(std::span<const std::string> patientIds, std::span<const Patient> patients, 
+                                     std::span<const ModelType> modelTypes) const {
+    struct Subject {
+        std::string patientId;
+        std::string name;
+        size_t row; // In the feature matrix, if found
+        bool found;
+    };
+    std::vector<Subject> subjects;
+    subjects.reserve(patientIds.size() + patients.size());
     std::vector<double> features;
-    
-    // Extract mutation scores from patient's genetic data
-    std::vector<double> mutationScores = patient.getMutationScores();
-    
-    if (mutationScores.empty()) {
-        // Use average mutation score if patient has no genetic data
-        if (!geneticDataArray.empty()) {
-            double sum = 0.0;
-            for (const auto& data : geneticDataArray) {
-                sum += data.getMutationScore();
+    features.reserve(subjects.capacity() * kFeatureCount);
+    std::shared_ptr<const ModelSet> modelSet;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        modelSet = currentModels();
+        std::optional<double> tableMean;
+        auto addPatient = [&](const Patient& patient) {
+            size_t row = features.size() / kFeatureCount;
+            features.resize(features.size() + kFeatureCount);
+            extractFeatures(patient, *modelSet, std::span<double>(features).subspan(row * kFeatureCount, kFeatureCount), 
+                            tableMean);
+            subjects.push_back({patient.getPatientId(), std::string(patient.getName()), row, true});
+        };
+        for (const std::string& patientId : patientIds) {
+            if (const Patient* stored = patientHistory.find(patientId)) {
+                addPatient(*stored);
+            } else {
+                subjects.push_back({patientId, "", 0, false});
             }
-            features.push_back(sum / geneticDataArray.size());
-        } else {
-            features.push_back(0.0);
         }
-    } else {
-        // Use average mutation score
-        double sum = 0.0;
-        for (double score : mutationScores) {
-            sum += score;
+        for (const Patient& patient : patients) {
+            addPatient(patient);
         }
-        features.push_back(sum / mutationScores.size());
     }
     
-    // Normalize features
-    if (preprocessor.getIsFitted() && !features.empty()) {
-        std::vector<double> normalized = preprocessor.standardize(features);
-        features = normalized;
+    // Each model scores every patient in one pass, holding no lock
+    FeatureMatrix X(features, kFeatureCount);
+    std::vector<std::vector<double>> scores;
+    scores.reserve(modelTypes.size());
+    for (ModelType model : modelTypes) {
+        scores.push_back(scoreFeatureMatrix(*modelSet, X, model));
     }
     
-    return features;
+    std::vector<DiagnosisResult> results;
+    results.reserve(subjects.size() * modelTypes.size());
+    for (const Subject& subject : subjects) {
+        for (size_t m = 0; m < modelTypes.size(); ++m) {
+            double riskScore = subject.found ? scores[m][subject.row] : 0.0;
+            results.push_back({subject.patientId, subject.name, modelTypes[m], riskScore, 
+                               riskScore >= 0.5 ? 1 : 0, subject.found});
+        }
+    }
+    return results;
 }
 
-double CancerDiagnosisSystem::diagnosePatient(const Patient& patient, ModelType model) {
-    if (!modelsTrained) {
-        std::cerr << "Error: Models not trained. Please load data first." << std::endl;
-        return 0.0;
+std::vector<double> CancerDiagnosisSystem::scoreFeatureMatrix(const ModelSet& modelSet, const FeatureMatrix& features, 
+                                                              ModelType model) {
+    if (!modelSet.trained) {
+        CDS_LOG_LIMITED(LogLevel::WARN, 1, "Models not trained; load data first");
+        return std::vector<double>(features.rows(), 0.0);
     }
+    if (features.empty()) {
+        return {};
+    }
+    ScopedTimer timer(*systemMetrics().inferenceTime[static_cast<size_t>(model)]);
     
-    std::vector<double> features = extractFeatures(patient);
-    std::vector<std::vector<double>> X = {features};
+    switch (model) {
+        case ModelType::KNN:
+            return modelSet.knnModel->predictProbability(features);
+        case ModelType::DECISION_TREE: {
+            // As in scoreFeatures: 1.0 for a positive prediction, 0.0 otherwise
+            std::vector<int> predictions = modelSet.decisionTreeModel->predict(features);
+            return std::vector<double>(predictions.begin(), predictions.end());
+        }
+        case ModelType::NAIVE_BAYES:
+            return modelSet.naiveBayesModel->predictProbability(features);
+        default:
+            return modelSet.logisticModel->predictProbabilityBatch(features);
+    }
+}
+
+const char* CancerDiagnosisSystem::modelName(ModelType model) {
+    switch (model) {
+        case ModelType::KNN: return "knn";
+        case ModelType::DECISION_TREE: return "decision_tree";
+        case ModelType::NAIVE_BAYES: return "naive_bayes";
+        default: return "logistic";
+    }
+}
+
+double CancerDiagnosisSystem::scoreFeatures(const ModelSet& modelSet, std::span<const double> features, 
+                                            ModelType model) {
+    if (!modelSet.trained) {
+        CDS_LOG_LIMITED(LogLevel::WARN, 1, "Models not trained; load data first");
+        return 0.0;
+    }
+    ScopedTimer timer(*systemMetrics().inferenceTime[static_cast<size_t>(model)]);
     
     switch (model) {
         case ModelType::LOGISTIC: {
-            std::vector<double> probs = logisticModel->predictProbabilityBatch(X);
-            return probs[0];
+            return modelSet.logisticModel->predictProbabilitySingle(features);
         }
         case ModelType::KNN: {
-            std::vector<double> probs = knnModel->predictProbability(X);
-            return probs[0];
+            return modelSet.knnModel->predictProbabilitySingle(features);
         }
         case ModelType::DECISION_TREE: {
-            std::vector<int> predictions = decisionTreeModel->predict(X);
             // Decision tree doesn't provide probabilities directly
             // Return 1.0 if prediction is 1, 0.0 otherwise
-            return predictions[0] == 1 ? 1.0 : 0.0;
+            return modelSet.decisionTreeModel->predictSingle(features) == 1 ? 1.0 : 0.0;
         }
         case ModelType::NAIVE_BAYES: {
-            double prob = naiveBayesModel->predictProbabilitySingle(features);
+            double prob = modelSet.naiveBayesModel->predictProbabilitySingle(features);
             return prob;
         }
         default:
@@ -434,53 +1101,64 @@ double CancerDiagnosisSystem::diagnosePatient(const Patient& patient, ModelType
     }
 }
 
-int CancerDiagnosisSystem::predictPatient(const Patient& patient, ModelType model) {
+int CancerDiagnosisSystem::predictPatient(const Patient& patient, ModelType model) const {
     double riskScore = diagnosePatient(patient, model);
     return riskScore >= 0.5 ? 1 : 0;
 }
 
 void CancerDiagnosisSystem::evaluateModels(const std::vector<Patient>& testPatients) {
-    if (!modelsTrained) {
-        std::cerr << "Error: Models not trained." << std::endl;
+    std::shared_ptr<const ModelSet> modelSet = currentModels();
+    if (!modelSet->trained) {
+        CDS_LOG_ERROR("Models not trained; nothing to evaluate");
         return;
     }
     
-    // Extract test data
-    std::vector<std::vector<double>> X_test;
+    // Extract test data (one feature per patient)
+    std::vector<double> testFeatures(testPatients.size() * kFeatureCount);
     std::vector<int> y_test;
+    y_test.reserve(testPatients.size());
     
-    for (const auto& patient : testPatients) {
-        std::vector<double> features = extractFeatures(patient);
-        X_test.push_back(features);
-        
-        // Use patient's prediction or genetic data label if available
-        if (!patient.getGeneticData().empty()) {
-            y_test.push_back(patient.getGeneticData()[0].getLabel());
-        } else {
-            y_test.push_back(patient.getPrediction());
+    {
+        // Patients' genetic data may refer to the live gene table
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        std::optional<double> tableMean;
+        for (size_t i = 0; i < testPatients.size(); ++i) {
+            const Patient& patient = testPatients[i];
+            extractFeatures(patient, *modelSet, 
+                            std::span<double>(testFeatures).subspan(i * kFeatureCount, kFeatureCount), tableMean);
+            
+            // Use patient's prediction or genetic data label if available
+            GeneticDataView genes = patient.getGeneticData();
+            if (!genes.empty()) {
+                y_test.push_back(genes[0].getLabel());
+            } else {
+                y_test.push_back(patient.getPrediction());
+            }
         }
     }
     
+    FeatureMatrix X_test(testFeatures, kFeatureCount);
+    
     // Evaluate each model
     std::cout << "\n=== Model Evaluation ===" << std::endl;
     
     // Logistic Regression
-    std::vector<int> y_pred_logistic = logisticModel->predict(X_test);
+    std::vector<int> y_pred_logistic = modelSet->logisticModel->predict(X_test);
     std::cout << "\n--- Logistic Regression ---" << std::endl;
     evaluator.displayMetrics(y_test, y_pred_logistic);
     
     // KNN
-    std::vector<int> y_pred_knn = knnModel->predict(X_test);
+    std::vector<int> y_pred_knn = modelSet->knnModel->predict(X_test);
     std::cout << "\n--- KNN Classifier ---" << std::endl;
     evaluator.displayMetrics(y_test, y_pred_knn);
     
     // Decision Tree
-    std::vector<int> y_pred_dt = decisionTreeModel->predict(X_test);
+    std::vector<int> y_pred_dt = modelSet->decisionTreeModel->predict(X_test);
     std::cout << "\n--- Decision Tree ---" << std::endl;
     evaluator.displayMetrics(y_test, y_pred_dt);
     
     // Naive Bayes
-    std::vector<int> y_pred_nb = naiveBayesModel->predict(X_test);
+    std::vector<int> y_pred_nb = modelSet->naiveBayesModel->predict(X_test);
     std::cout << "\n--- Naive Bayes ---" << std::endl;
     evaluator.displayMetrics(y_test, y_pred_nb);
     
@@ -494,124 +1172,709 @@ void CancerDiagnosisSystem::displayModelMetrics(ModelType model,
 }
 
 void CancerDiagnosisSystem::displayGeneticData() const {
-    std::cout << "\n=== Genetic Data (" << geneticDataArray.size() << " records) ===" << std::endl;
-    for (const auto& data : geneticDataArray) {
-        data.display();
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    std::cout << "\n=== Genetic Data (" << geneticData.size() << " records) ===" << std::endl;
+    for (size_t i = 0; i < geneticData.size(); ++i) {
+        geneticData.getRow(i).display();
     }
     std::cout << "===========================\n" << std::endl;
 }
 
 void CancerDiagnosisSystem::displayPatientHistory() const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
     std::cout << "\n=== Patient History ===" << std::endl;
-    int count = 0;
-    auto current = patientHistoryHead;
-    
-    while (current) {
-        current->patient.display();
-        current = current->next;
-        count++;
+    for (auto it = patientHistory.rbegin(); it != patientHistory.rend(); ++it) {
+        it->display();
     }
     
-    std::cout << "Total patients: " << count << std::endl;
+    std::cout << "Total patients: " << patientHistory.size() << std::endl;
     std::cout << "=======================\n" << std::endl;
 }
 
 void CancerDiagnosisSystem::displayMutationMappings() const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
     mutationMapper.displayMappings();
 }
 
 void CancerDiagnosisSystem::displayDecisionTree() const {
+    std::shared_ptr<const ModelSet> modelSet = currentModels();
     std::cout << "\n=== Decision Tree Structure ===" << std::endl;
-    decisionTreeModel->displayTree(decisionTreeModel->getRoot());
+    modelSet->decisionTreeModel->displayTree(modelSet->decisionTreeModel->getRoot());
     std::cout << "===============================\n" << std::endl;
 }
 
 size_t CancerDiagnosisSystem::getGeneticDataCount() const {
-    return geneticDataArray.size();
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return geneticData.size();
 }
 
 size_t CancerDiagnosisSystem::getPatientCount() const {
-    size_t count = 0;
-    auto current = patientHistoryHead;
-    while (current) {
-        count++;
-        current = current->next;
-    }
-    return count;
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return patientHistory.size();
+}
+
+DiagnosisCache::Stats CancerDiagnosisSystem::getDiagnosisCacheStats() const {
+    return diagnosisCache.getStats();
+}
+
+uint64_t CancerDiagnosisSystem::getDataVersion() const {
+    return dataVersion.load(std::memory_order_acquire);
+}
+
+void CancerDiagnosisSystem::markDataChanged() {
+    dataVersion.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const CancerDiagnosisSystem::ModelSet> CancerDiagnosisSystem::currentModels() const {
+    std::lock_guard<std::mutex> lock(modelsMutex);
+    return models;
+}
+
+void CancerDiagnosisSystem::publishModels(std::shared_ptr<const ModelSet> modelSet) {
+    std::lock_guard<std::mutex> lock(modelsMutex);
+    models.swap(modelSet); // The old set is released by the caller, after the lock
 }
 
 bool CancerDiagnosisSystem::areModelsTrained() const {
-    return modelsTrained;
+    return currentModels()->trained;
 }
 
 bool CancerDiagnosisSystem::getPatientById(const std::string& patientId, Patient& outPatient) const {
-    // Helper to trim whitespace
-    auto trim = [](const std::string& str) {
-        size_t first = str.find_first_not_of(" \t\n\r");
-        if (first == std::string::npos) return std::string("");
-        size_t last = str.find_last_not_of(" \t\n\r");
-        return str.substr(first, (last - first + 1));
-    };
-    
-    std::string trimmedId = trim(patientId);
-    auto current = patientHistoryHead;
-    while (current) {
-        std::string storedId = trim(current->patient.getPatientId());
-        if (storedId == trimmedId) {
-            outPatient = current->patient;
-            return true;
-        }
-        current = current->next;
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    const Patient* patient = patientHistory.find(patientId);
+    if (!patient) {
+        return false;
     }
-    return false;
+    outPatient = *patient;
+    return true;
 }
 
 std::vector<Patient> CancerDiagnosisSystem::getAllPatients() const {
-    std::vector<Patient> patients;
-    auto current = patientHistoryHead;
-    while (current) {
-        patients.push_back(current->patient);
-        current = current->next;
-    }
-    return patients;
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    // Most recent first, matching the history display
+    return std::vector<Patient>(patientHistory.rbegin(), patientHistory.rend());
 }
 
 std::vector<GeneticData> CancerDiagnosisSystem::getAllGeneticData() const {
-    return geneticDataArray;
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    std::vector<GeneticData> records;
+    records.reserve(geneticData.size());
+    for (size_t i = 0; i < geneticData.size(); ++i) {
+        records.push_back(geneticData.getRow(i));
+    }
+    return records;
+}
+
+void CancerDiagnosisSystem::saveDataToFiles(const std::string& genesFile, const std::string& patientsFile) {
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    DataFileContents contents;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        encodeDataFiles(contents);
+    }
+    writeDataFiles(genesFile, patientsFile, contents);
 }
 
-void CancerDiagnosisSystem::saveDataToFiles(const std::string& genesFile, const std::string& patientsFile) const {
-    // Save genetic data to genes file
-    std::ofstream genesOut(genesFile);
-    if (genesOut.is_open()) {
-        genesOut << "Gene_ID,Mutation_Score,Label\n";
-        for (const auto& data : geneticDataArray) {
-            genesOut << data.getGeneId() << ","
-                     << std::fixed << std::setprecision(4) << data.getMutationScore() << ","
-                     << data.getLabel() << "\n";
+void CancerDiagnosisSystem::encodeDataFiles(DataFileContents& out) const {
+    char number[32];
+    
+    // Genetic data
+    std::string& genesOut = out.genes;
+    genesOut = "Gene_ID,Mutation_Score,Label\n";
+    genesOut.reserve(geneticData.size() * 24);
+    for (size_t i = 0; i < geneticData.size(); ++i) {
+        auto end = std::to_chars(number, number + sizeof(number), geneticData.getMutationScore(i), 
+                                 std::chars_format::fixed, 4).ptr;
+        genesOut += geneticData.getGeneId(i).str();
+        genesOut += ',';
+        genesOut.append(number, end);
+        genesOut += ',';
+        genesOut += std::to_string(geneticData.getLabel(i));
+        genesOut += '\n';
+    }
+    out.geneCount = geneticData.size();
+    
+    // Patient data: one row per row the loader read, so every row (and with
+    // it the gene assignment of the rows after it) stays in place. A row
+    // whose ID was repeated later in the file holds the stored record, like
+    // the later row. Patients added since follow in insertion order.
+    std::string& patientsOut = out.patients;
+    patientsOut = "Patient_ID,Name,Age\n";
+    std::vector<uint32_t>& rows = out.patientRows;
+    rows = patientFileRows;
+    std::vector<bool> inFile(patientHistory.size());
+    for (uint32_t position : rows) {
+        inFile[position] = true;
+    }
+    for (size_t position = 0; position < inFile.size(); ++position) {
+        if (!inFile[position]) {
+            rows.push_back(static_cast<uint32_t>(position));
         }
-        genesOut.close();
-        std::cout << "✓ Saved " << geneticDataArray.size() << " genetic records to " << genesFile << std::endl;
+    }
+    for (uint32_t position : rows) {
+        const Patient& patient = patientHistory.begin()[position];
+        patientsOut += patient.getPatientId();
+        patientsOut += ',';
+        patientsOut += patient.getName();
+        patientsOut += ',';
+        patientsOut += std::to_string(patient.getAge());
+        patientsOut += '\n';
+    }
+    out.patientCount = rows.size();
+}
+
+bool CancerDiagnosisSystem::writeDataFiles(const std::string& genesFile, const std::string& patientsFile, 
+                                           const DataFileContents& contents, 
+                                           std::optional<LogCheckpoint> folded) {
+    ScopedTimer timer(*systemMetrics().dataFileWriteTime);
+    
+    // Stage both files, then commit them with one record; a crash before
+    // the record leaves the old pair, after it recovery finishes the renames
+    DataFileCommit commit;
+    commit.patientsFile = patientsFile;
+    if (folded) {
+        commit.logFile = writeAheadLog->getFilename();
+        commit.logId = folded->logId;
+        commit.logBytes = folded->bytes;
+    }
+    commit.genesChecksum = payloadChecksum(contents.genes);
+    commit.patientsChecksum = payloadChecksum(contents.patients);
+    if (!stageFile(genesFile, {contents.genes}) || !stageFile(patientsFile, {contents.patients}) ||
+        !writeFileAtomically(commitRecordFile(genesFile), {encodeCommitRecord(commit)})) {
+        discardStagedFile(genesFile);
+        discardStagedFile(patientsFile);
+        CDS_LOG_ERROR("Could not write " << genesFile << " and " << patientsFile);
+        return false;
+    }
+    
+    bool genesSaved = commitStagedFile(genesFile);
+    if (genesSaved) {
+        CDS_LOG_INFO("Saved " << contents.geneCount << " genetic records to " << genesFile);
     } else {
-        std::cerr << "✗ Error: Could not open " << genesFile << " for writing" << std::endl;
-    }
-    
-    // Save patient data to patients file
-    std::ofstream patientsOut(patientsFile);
-    if (patientsOut.is_open()) {
-        patientsOut << "Patient_ID,Name,Age\n";
-        auto current = patientHistoryHead;
-        int count = 0;
-        while (current) {
-            patientsOut << current->patient.getPatientId() << ","
-                        << current->patient.getName() << ","
-                        << current->patient.getAge() << "\n";
-            current = current->next;
-            count++;
-        }
-        patientsOut.close();
-        std::cout << "✓ Saved " << count << " patient records to " << patientsFile << std::endl;
+        CDS_LOG_ERROR("Could not write " << genesFile);
+    }
+    bool patientsSaved = commitStagedFile(patientsFile);
+    if (patientsSaved) {
+        CDS_LOG_INFO("Saved " << contents.patientCount << " patient records to " << patientsFile);
     } else {
-        std::cerr << "✗ Error: Could not open " << patientsFile << " for writing" << std::endl;
+        CDS_LOG_ERROR("Could not write " << patientsFile);
     }
+    
+    // The rewritten files now hold exactly the encoded state, so later
+    // appends start from their current end (offsets and file rows only
+    // change under loadMutex)
+    if (genesFile == loadedGenesFile) {
+        genesFileOffset = fileSize(genesFile);
+    }
+    if (patientsFile == loadedPatientsFile) {
+        patientsFileOffset = fileSize(patientsFile);
+        patientFileRows = contents.patientRows;
+    }
+    return genesSaved && patientsSaved;
+}
+
+bool CancerDiagnosisSystem::saveSnapshot(const std::string& snapshotFile) {
+    // State is only encoded under the shared lock, so diagnoses carry on;
+    // loadMutex keeps other file writers (and loads) out
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    EncodedSnapshot snapshot;
+    bool logPending;
+    bool encoded = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        // Writers append to the log under the exclusive lock, so this holds until we release it
+        logPending = writeAheadLog && loadedGenesFile == logGenesFile && 
+                     loadedPatientsFile == logPatientsFile && writeAheadLog->size() > 0;
+        if (!logPending) {
+            encoded = encodeSnapshot(snapshot, genesFileOffset, patientsFileOffset, patientFileRows);
+        }
+    }
+    if (logPending) {
+        return foldWriteAheadLog(snapshotFile);
+    }
+    return encoded && writeSnapshot(snapshotFile, snapshot);
+}
+
+bool CancerDiagnosisSystem::writeSnapshot(const std::string& snapshotFile, EncodedSnapshot& snapshot) const {
+    // Stamp the source files as they are now on disk; a snapshot is only
+    // reused while both are unchanged
+    SnapshotWriter& writer = snapshot.writer;
+    size_t at = snapshot.stampPosition;
+    writer.overwrite<uint64_t>(at, fileSize(loadedGenesFile));
+    writer.overwrite<int64_t>(at + 8, fileModifiedTime(loadedGenesFile));
+    writer.overwrite<uint64_t>(at + 16, fileSize(loadedPatientsFile));
+    writer.overwrite<int64_t>(at + 24, fileModifiedTime(loadedPatientsFile));
+    
+    if (!writer.saveToFile(snapshotFile)) {
+        CDS_LOG_ERROR("Could not write snapshot " << snapshotFile);
+        return false;
+    }
+    CDS_LOG_INFO("Saved snapshot to " << snapshotFile);
+    return true;
+}
+
+bool CancerDiagnosisSystem::encodeSnapshot(EncodedSnapshot& out, uint64_t genesOffset, 
+                                           uint64_t patientsOffset, 
+                                           const std::vector<uint32_t>& fileRows) const {
+    if (modelsGeneration != trainingGeneration) {
+        CDS_LOG_WARN("Snapshot skipped: models are being retrained");
+        return false;
+    }
+    SnapshotWriter& writer = out.writer;
+    std::shared_ptr<const ModelSet> modelSet = currentModels();
+    
+    // Source files the snapshot is built from; their sizes and modification
+    // times are filled in by writeSnapshot
+    writer.writeString(loadedGenesFile);
+    writer.writeString(loadedPatientsFile);
+    out.stampPosition = writer.position();
+    writer.write<uint64_t>(0);
+    writer.write<int64_t>(0);
+    writer.write<uint64_t>(0);
+    writer.write<int64_t>(0);
+    writer.write<uint64_t>(genesOffset);
+    writer.write<uint64_t>(patientsOffset);
+    writer.write<uint8_t>(modelSet->trained ? 1 : 0);
+    
+    // Gene ID dictionary shared by the gene table and patient gene lists
+    std::vector<Symbol> dictionary;
+    std::unordered_map<Symbol, uint32_t> dictionaryIndex;
+    auto intern = [&](Symbol geneId) {
+        auto it = dictionaryIndex.find(geneId);
+        if (it != dictionaryIndex.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(dictionary.size());
+        dictionaryIndex.emplace(geneId, id);
+        dictionary.push_back(geneId);
+        return id;
+    };
+    
+    // Gene table ID column as dictionary indices; scores and labels are
+    // written straight from the table's columns
+    std::vector<uint32_t> geneIds;
+    geneIds.reserve(geneticData.size());
+    for (Symbol geneId : geneticData.geneIdColumn()) {
+        geneIds.push_back(intern(geneId));
+    }
+    
+    // Patient columns in insertion order. Genetic data referring to the gene
+    // table are written as row indices, owned records are flattened into
+    // parallel columns; each patient has entries in only one of the two.
+    std::vector<std::string> patientIds;
+    std::vector<std::string> patientNames;
+    std::vector<int32_t> ages;
+    std::vector<double> riskScores;
+    std::vector<int32_t> predictions;
+    std::vector<uint32_t> patientRowCounts;
+    std::vector<uint32_t> patientRows;
+    std::vector<uint32_t> patientGeneCounts;
+    std::vector<uint32_t> patientGeneIds;
+    std::vector<double> patientGeneScores;
+    std::vector<int32_t> patientGeneLabels;
+    for (const Patient& patient : patientHistory) {
+        patientIds.push_back(patient.getPatientId());
+        patientNames.emplace_back(patient.getName());
+        ages.push_back(patient.getAge());
+        riskScores.push_back(patient.getRiskScore());
+        predictions.push_back(patient.getPrediction());
+        if (patient.getGeneTable() == &geneticData) {
+            std::span<const uint32_t> rows = patient.getGeneRows();
+            patientRowCounts.push_back(static_cast<uint32_t>(rows.size()));
+            patientRows.insert(patientRows.end(), rows.begin(), rows.end());
+            patientGeneCounts.push_back(0);
+            continue;
+        }
+        GeneticDataView genes = patient.getGeneticData();
+        patientRowCounts.push_back(0);
+        patientGeneCounts.push_back(static_cast<uint32_t>(genes.size()));
+        for (const auto& data : genes) {
+            patientGeneIds.push_back(intern(data.getGeneSymbol()));
+            patientGeneScores.push_back(data.getMutationScore());
+            patientGeneLabels.push_back(data.getLabel());
+        }
+    }
+    
+    writer.write<uint64_t>(dictionary.size());
+    for (Symbol geneId : dictionary) {
+        writer.writeString(geneId.str());
+    }
+    writer.writeArray(geneIds);
+    writer.writeArray(geneticData.mutationScoreColumn());
+    writer.writeArray(geneticData.labelColumn());
+    
+    writer.write<uint64_t>(patientIds.size());
+    for (size_t i = 0; i < patientIds.size(); ++i) {
+        writer.writeString(patientIds[i]);
+        writer.writeString(patientNames[i]);
+    }
+    writer.writeArray(ages);
+    writer.writeArray(riskScores);
+    writer.writeArray(predictions);
+    writer.writeArray(patientRowCounts);
+    writer.writeArray(patientRows);
+    writer.writeArray(patientGeneCounts);
+    writer.writeArray(patientGeneIds);
+    writer.writeArray(patientGeneScores);
+    writer.writeArray(patientGeneLabels);
+    writer.writeArray(fileRows); // Store positions match the patient columns
+    
+    // Fitted preprocessing parameters and trained models
+    modelSet->preprocessor.saveState(writer);
+    modelSet->logisticModel->saveState(writer);
+    modelSet->knnModel->saveState(writer);
+    modelSet->decisionTreeModel->saveState(writer);
+    modelSet->naiveBayesModel->saveState(writer);
+    return true;
+}
+
+bool CancerDiagnosisSystem::loadSnapshot(const std::string& snapshotFile, 
+                                         const std::string& genesFile, 
+                                         const std::string& patientsFile) {
+    // Decoding happens off the state lock, like a CSV load
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    recoverDataFiles(genesFile, patientsFile);
+    
+    SnapshotReader reader;
+    std::string error;
+    if (!reader.open(snapshotFile, error)) {
+        CDS_LOG_WARN("Snapshot " << snapshotFile << " not used: " << error);
+        return false;
+    }
+    
+    // Declared first so the replaced records are released after the lock
+    LoadedData data;
+    size_t genesRestored = 0;
+    size_t patientsRestored = 0;
+    try {
+        std::string snapshotGenesFile = reader.readString();
+        std::string snapshotPatientsFile = reader.readString();
+        uint64_t genesSize = reader.read<uint64_t>();
+        int64_t genesTime = reader.read<int64_t>();
+        uint64_t patientsSize = reader.read<uint64_t>();
+        int64_t patientsTime = reader.read<int64_t>();
+        
+        if (snapshotGenesFile != genesFile || snapshotPatientsFile != patientsFile ||
+            genesSize != fileSize(genesFile) || genesTime != fileModifiedTime(genesFile) ||
+            patientsSize != fileSize(patientsFile) || patientsTime != fileModifiedTime(patientsFile)) {
+            CDS_LOG_INFO("Snapshot " << snapshotFile << " not used: source files changed");
+            return false;
+        }
+        
+        uint64_t genesOffset = reader.read<uint64_t>();
+        uint64_t patientsOffset = reader.read<uint64_t>();
+        bool trained = reader.read<uint8_t>() != 0;
+        
+        std::vector<Symbol> dictionary(reader.read<uint64_t>());
+        for (auto& geneId : dictionary) {
+            geneId = Symbol(reader.readString());
+        }
+        auto lookup = [&](uint32_t id) {
+            if (id >= dictionary.size()) {
+                throw std::runtime_error("Gene ID out of dictionary range");
+            }
+            return dictionary[id];
+        };
+        
+        std::vector<uint32_t> geneIds = reader.readArray<uint32_t>();
+        std::vector<double> geneScores = reader.readArray<double>();
+        std::vector<int32_t> geneLabels = reader.readArray<int32_t>();
+        if (geneScores.size() != geneIds.size() || geneLabels.size() != geneIds.size()) {
+            throw std::runtime_error("Gene columns have different lengths");
+        }
+        
+        std::vector<std::string> patientIds(reader.read<uint64_t>());
+        std::vector<std::string> patientNames(patientIds.size());
+        for (size_t i = 0; i < patientIds.size(); ++i) {
+            patientIds[i] = reader.readString();
+            patientNames[i] = reader.readString();
+        }
+        std::vector<int32_t> ages = reader.readArray<int32_t>();
+        std::vector<double> riskScores = reader.readArray<double>();
+        std::vector<int32_t> predictions = reader.readArray<int32_t>();
+        std::vector<uint32_t> patientRowCounts = reader.readArray<uint32_t>();
+        std::vector<uint32_t> patientRows = reader.readArray<uint32_t>();
+        std::vector<uint32_t> patientGeneCounts = reader.readArray<uint32_t>();
+        std::vector<uint32_t> patientGeneIds = reader.readArray<uint32_t>();
+        std::vector<double> patientGeneScores = reader.readArray<double>();
+        std::vector<int32_t> patientGeneLabels = reader.readArray<int32_t>();
+        std::vector<uint32_t> patientFileRows = reader.readArray<uint32_t>();
+        if (ages.size() != patientIds.size() || riskScores.size() != patientIds.size() ||
+            predictions.size() != patientIds.size() || patientRowCounts.size() != patientIds.size() ||
+            patientGeneCounts.size() != patientIds.size() ||
+            patientGeneScores.size() != patientGeneIds.size() ||
+            patientGeneLabels.size() != patientGeneIds.size()) {
+            throw std::runtime_error("Patient columns have different lengths");
+        }
+        
+        // Decode everything into fresh state before touching the live system
+        auto loadedModels = std::make_shared<ModelSet>();
+        loadedModels->preprocessor.loadState(reader);
+        loadedModels->logisticModel->loadState(reader);
+        loadedModels->knnModel->loadState(reader);
+        loadedModels->decisionTreeModel->loadState(reader);
+        loadedModels->naiveBayesModel->loadState(reader);
+        loadedModels->trained = trained;
+        
+        data.geneticData.reserve(geneIds.size());
+        data.mutationMapper.reserve(geneIds.size());
+        for (size_t i = 0; i < geneIds.size(); ++i) {
+            Symbol geneId = lookup(geneIds[i]);
+            data.geneticData.append(geneId, geneScores[i], geneLabels[i]);
+            data.mutationMapper.addMutationMapping(geneId, geneScores[i]);
+        }
+        
+        // Patients go straight into a new store (a new epoch), swapped in on commit
+        PatientStore& patients = data.patientHistory;
+        patients.reserve(patientIds.size());
+        size_t rowCursor = 0;
+        size_t geneCursor = 0;
+        for (size_t i = 0; i < patientIds.size(); ++i) {
+            Patient patient(patientIds[i], patientNames[i], ages[i], patients.get_allocator());
+            patient.setRiskScore(riskScores[i]);
+            patient.setPrediction(predictions[i]);
+            if (patientRowCounts[i] > patientRows.size() - rowCursor) {
+                throw std::runtime_error("Patient row counts exceed row column");
+            }
+            // Rows refer to the live table, which data.geneticData replaces on commit
+            for (uint32_t r = 0; r < patientRowCounts[i]; ++r, ++rowCursor) {
+                if (patientRows[rowCursor] >= data.geneticData.size()) {
+                    throw std::runtime_error("Patient gene row out of range");
+                }
+                patient.addGeneticDataRow(geneticData, patientRows[rowCursor]);
+            }
+            if (patientGeneCounts[i] > patientGeneIds.size() - geneCursor) {
+                throw std::runtime_error("Patient gene counts exceed gene columns");
+            }
+            for (uint32_t g = 0; g < patientGeneCounts[i]; ++g, ++geneCursor) {
+                patient.addGeneticData(GeneticData(lookup(patientGeneIds[geneCursor]), 
+                                                   patientGeneScores[geneCursor], 
+                                                   patientGeneLabels[geneCursor]));
+            }
+            patients.upsert(std::move(patient));
+        }
+        data.genesFileOffset = genesOffset;
+        data.patientsFileOffset = patientsOffset;
+        for (uint32_t position : patientFileRows) {
+            if (position >= patientIds.size()) {
+                throw std::runtime_error("Patient file row out of range");
+            }
+        }
+        data.patientFileRows = std::move(patientFileRows);
+        
+        // The snapshot matches the base files; changes logged since then are
+        // replayed on top, the last few under the lock
+        bool replayLog = writeAheadLog && genesFile == logGenesFile && patientsFile == logPatientsFile;
+        if (replayLog) {
+            replayWriteAheadLog(data);
+        }
+        
+        // Commit
+        std::lock_guard<std::shared_mutex> lock(stateMutex);
+        if (replayLog) {
+            replayWriteAheadLog(data);
+        }
+        genesRestored = data.geneticData.size();
+        patientsRestored = data.patientHistory.size();
+        commitLoadedData(data, std::move(loadedModels), genesFile, patientsFile);
+    } catch (const std::exception& e) {
+        CDS_LOG_WARN("Snapshot " << snapshotFile << " not used: " << e.what());
+        return false;
+    }
+    
+    CDS_LOG_INFO("Restored " << genesRestored << " genetic records and " << patientsRestored
+                 << " patients from snapshot " << snapshotFile);
+    return true;
+}
+
+bool CancerDiagnosisSystem::enableWriteAheadLog(const std::string& logFile, 
+                                                const std::string& genesFile, 
+                                                const std::string& patientsFile, 
+                                                WriteAheadLog::FsyncPolicy policy) {
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    
+    auto log = std::make_unique<WriteAheadLog>();
+    if (!log->open(logFile, policy)) {
+        return false;
+    }
+    writeAheadLog = std::move(log);
+    logGenesFile = genesFile;
+    logPatientsFile = patientsFile;
+    lastLogFold = std::chrono::steady_clock::now();
+    recoverDataFiles(genesFile, patientsFile);
+    return true;
+}
+
+void CancerDiagnosisSystem::recoverDataFiles(const std::string& genesFile, const std::string& patientsFile) {
+    DataFileCommit commit;
+    if (!readCommitRecord(genesFile, commit) || commit.patientsFile != patientsFile) {
+        return;
+    }
+    rollForwardStagedFile(genesFile, commit.genesChecksum);
+    rollForwardStagedFile(patientsFile, commit.patientsChecksum);
+    
+    // The log keeps its id until the folded records are discarded, so a
+    // match means the crash came between the rewrite and the discard
+    if (writeAheadLog && !commit.logFile.empty() && commit.logFile == writeAheadLog->getFilename() &&
+        commit.logId == writeAheadLog->getLogId()) {
+        CDS_LOG_WARN("Discarding " << commit.logBytes << " bytes of " << commit.logFile 
+                     << " already folded into " << genesFile << " and " << patientsFile);
+        writeAheadLog->discardPrefix(commit.logBytes);
+    }
+}
+
+size_t CancerDiagnosisSystem::replayWriteAheadLog(LoadedData& data) const {
+    // Records still buffered in memory have not reached the file yet
+    writeAheadLog->sync();
+    
+    size_t skip = data.logRecordsSeen;
+    size_t malformed = 0;
+    size_t seen = WriteAheadLog::replay(writeAheadLog->getFilename(), [&](std::string_view record) {
+        if (skip > 0) {
+            skip--; // Applied by an earlier pass
+            return;
+        }
+        LogFieldReader reader(record);
+        std::string_view type;
+        reader.next(type);
+        
+        if (type == "G") {
+            GeneticData gene;
+            if (!reader.nextGene(gene)) { malformed++; return; }
+            data.geneticData.append(gene);
+            data.mutationMapper.addMutationMapping(gene.getGeneSymbol(), gene.getMutationScore());
+        } else if (type == "P") {
+            std::string_view id, name;
+            int age = 0, prediction = 0;
+            double riskScore = 0.0;
+            size_t geneCount = 0;
+            if (!reader.next(id) || !reader.next(name) || !reader.nextNumber(age) ||
+                !reader.nextNumber(riskScore) || !reader.nextNumber(prediction) ||
+                !reader.nextNumber(geneCount)) {
+                malformed++;
+                return;
+            }
+            Patient patient{id, name, age, data.patientHistory.get_allocator()};
+            patient.setRiskScore(riskScore);
+            patient.setPrediction(prediction);
+            for (size_t i = 0; i < geneCount; ++i) {
+                GeneticData gene;
+                if (!reader.nextGene(gene)) { malformed++; return; }
+                patient.addGeneticData(gene);
+            }
+            data.patientHistory.upsert(std::move(patient));
+        } else {
+            malformed++;
+        }
+    });
+    
+    size_t applied = seen > data.logRecordsSeen ? seen - data.logRecordsSeen : 0;
+    data.logRecordsSeen = seen;
+    
+    if (malformed > 0) {
+        CDS_LOG_WARN("Skipped " << malformed << " malformed write-ahead log records");
+    }
+    if (applied > 0) {
+        CDS_LOG_INFO("Replayed " << applied - malformed << " write-ahead log records from "
+                     << writeAheadLog->getFilename());
+    }
+    return applied - malformed;
+}
+
+bool CancerDiagnosisSystem::syncWriteAheadLog() {
+    return !writeAheadLog || writeAheadLog->sync();
+}
+
+uint64_t CancerDiagnosisSystem::getWriteAheadLogSize() const {
+    return writeAheadLog ? writeAheadLog->size() : 0;
+}
+
+bool CancerDiagnosisSystem::foldWriteAheadLog(const std::string& snapshotFile) {
+    // Only fold the log into the base files when they are what we loaded;
+    // otherwise we would overwrite them with a partial view of the data
+    if (!writeAheadLog || loadedGenesFile != logGenesFile || loadedPatientsFile != logPatientsFile) {
+        return false;
+    }
+    
+    DataFileContents contents;
+    std::optional<EncodedSnapshot> snapshot;
+    LogCheckpoint folded;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        // Writers append to the log under the exclusive lock, so the encoded
+        // state holds exactly the log up to here. The id only changes when
+        // a fold (under loadMutex) discards records.
+        folded.logId = writeAheadLog->getLogId();
+        folded.bytes = writeAheadLog->size();
+        encodeDataFiles(contents);
+        if (!snapshotFile.empty()) {
+            // Offsets the rewritten files will end at
+            snapshot.emplace();
+            if (!encodeSnapshot(*snapshot, contents.genes.size(), contents.patients.size(), 
+                                contents.patientRows)) {
+                snapshot.reset();
+            }
+        }
+    }
+    
+    // Records appended meanwhile stay in the log. The folded ones are only
+    // discarded once both files have been durably replaced; the commit
+    // record names them, so a crash before the discard does not replay
+    // them a second time.
+    lastLogFold = std::chrono::steady_clock::now();
+    if (!writeDataFiles(logGenesFile, logPatientsFile, contents, folded)) {
+        return false;
+    }
+    if (snapshot) {
+        writeSnapshot(snapshotFile, *snapshot);
+    }
+    return writeAheadLog->discardPrefix(folded.bytes);
+}
+
+void CancerDiagnosisSystem::flushChanges() {
+    std::lock_guard<std::mutex> loadLock(loadMutex);
+    // Rewriting the CSVs invalidates a snapshot of them; refresh it so the
+    // next start is still a warm one
+    bool refreshSnapshot = !persistSnapshotFile.empty() && 
+                           loadedGenesFile == persistGenesFile && loadedPatientsFile == persistPatientsFile;
+    std::string snapshotFile = refreshSnapshot ? persistSnapshotFile : "";
+    
+    if (writeAheadLog) {
+        // Changes are already durable in the log. Folding rewrites both files
+        // in full, so it waits until the log is big or old enough.
+        uint64_t logBytes = writeAheadLog->size();
+        if (logBytes >= kLogFoldBytes || 
+            (logBytes > 0 && std::chrono::steady_clock::now() - lastLogFold >= kLogFoldAge)) {
+            foldWriteAheadLog(snapshotFile);
+        }
+        return;
+    }
+    
+    DataFileContents contents;
+    std::optional<EncodedSnapshot> snapshot;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex);
+        encodeDataFiles(contents);
+        if (refreshSnapshot) {
+            snapshot.emplace();
+            if (!encodeSnapshot(*snapshot, contents.genes.size(), contents.patients.size(), 
+                                contents.patientRows)) {
+                snapshot.reset();
+            }
+        }
+    }
+    if (writeDataFiles(persistGenesFile, persistPatientsFile, contents) && snapshot) {
+        writeSnapshot(persistSnapshotFile, *snapshot);
+    }
+}
+
+void CancerDiagnosisSystem::enableBackgroundPersistence(const std::string& genesFile, 
+                                                        const std::string& patientsFile, 
+                                                        std::chrono::milliseconds interval, 
+                                                        const std::string& snapshotFile) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    
+    persistGenesFile = genesFile;
+    persistPatientsFile = patientsFile;
+    persistSnapshotFile = snapshotFile;
+    persistenceWorker = std::make_unique<PersistenceWorker>([this]() { flushChanges(); }, interval);
 }
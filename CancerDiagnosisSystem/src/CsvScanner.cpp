@@ -0,0 +1,86 @@
+#include "../headers/CsvScanner.h"
+#include <charconv>
+#include <cstring>
+
+CsvScanner::CsvScanner(std::string_view data, size_t startOffset)
+    : data(data), position(startOffset < data.size() ? startOffset : data.size()), lineNumber(0) {}
+
+bool CsvScanner::nextLine(std::string_view& line) {
+    if (position >= data.size()) {
+        return false;
+    }
+
+    const char* begin = data.data() + position;
+    size_t remaining = data.size() - position;
+    const char* newline = static_cast<const char*>(std::memchr(begin, '\n', remaining));
+    size_t lineLength = newline ? static_cast<size_t>(newline - begin) : remaining;
+
+    position += newline ? lineLength + 1 : lineLength;
+    lineNumber++;
+
+    // Tolerate CRLF files
+    if (lineLength > 0 && begin[lineLength - 1] == '\r') {
+        lineLength--;
+    }
+    line = std::string_view(begin, lineLength);
+    return true;
+}
+
+size_t CsvScanner::offset() const {
+    return position;
+}
+
+size_t CsvScanner::getLineNumber() const {
+    return lineNumber;
+}
+
+bool CsvScanner::splitFields(std::string_view line, std::string_view* fields, size_t count) {
+    size_t start = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (start > line.size()) {
+            return false;
+        }
+        size_t comma = line.find(',', start);
+        size_t end = (comma == std::string_view::npos) ? line.size() : comma;
+        fields[i] = line.substr(start, end - start);
+        start = end + 1;
+        // Only the last requested field may run to the end of the line
+        if (comma == std::string_view::npos && i + 1 < count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view CsvScanner::trim(std::string_view field) {
+    size_t first = field.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t last = field.find_last_not_of(" \t\r\n");
+    return field.substr(first, last - first + 1);
+}
+
+bool CsvScanner::parseDouble(std::string_view field, double& out) {
+    field = trim(field);
+    if (!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+    }
+    if (field.empty()) {
+        return false;
+    }
+    auto result = std::from_chars(field.data(), field.data() + field.size(), out);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+bool CsvScanner::parseInt(std::string_view field, int& out) {
+    field = trim(field);
+    if (!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+    }
+    if (field.empty()) {
+        return false;
+    }
+    auto result = std::from_chars(field.data(), field.data() + field.size(), out);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
@@ -1,4 +1,5 @@
 #include "../headers/DataPreprocessor.h"
+#include "../headers/Snapshot.h"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
@@ -7,7 +8,7 @@
 DataPreprocessor::DataPreprocessor() 
     : mean(0.0), stdDev(0.0), minVal(0.0), maxVal(0.0), isFitted(false) {}
 
-void DataPreprocessor::fit(const std::vector<double>& data) {
+void DataPreprocessor::fit(std::span<const double> data) {
     if (data.empty()) {
         throw std::runtime_error("Cannot fit preprocessor on empty data");
     }
@@ -29,7 +30,7 @@ void DataPreprocessor::fit(const std::vector<double>& data) {
     isFitted = true;
 }
 
-std::vector<double> DataPreprocessor::normalize(const std::vector<double>& data) const {
+std::vector<double> DataPreprocessor::normalize(std::span<const double> data) const {
     if (!isFitted) {
         throw std::runtime_error("Preprocessor not fitted. Call fit() first.");
     }
@@ -37,7 +38,7 @@ std::vector<double> DataPreprocessor::normalize(const std::vector<double>& data)
     return standardize(data);
 }
 
-std::vector<double> DataPreprocessor::minMaxScale(const std::vector<double>& data) const {
+std::vector<double> DataPreprocessor::minMaxScale(std::span<const double> data) const {
     if (!isFitted) {
         throw std::runtime_error("Preprocessor not fitted. Call fit() first.");
     }
@@ -57,27 +58,31 @@ std::vector<double> DataPreprocessor::minMaxScale(const std::vector<double>& dat
     return scaled;
 }
 
-std::vector<double> DataPreprocessor::standardize(const std::vector<double>& data) const {
+std::vector<double> DataPreprocessor::standardize(std::span<const double> data) const {
+    std::vector<double> standardized(data.size());
+    standardize(data, standardized);
+    return standardized;
+}
+
+void DataPreprocessor::standardize(std::span<const double> data, std::span<double> out) const {
     if (!isFitted) {
         throw std::runtime_error("Preprocessor not fitted. Call fit() first.");
     }
+    if (out.size() != data.size()) {
+        throw std::runtime_error("Output size must match input size");
+    }
     
     if (stdDev == 0.0) {
-        return std::vector<double>(data.size(), 0.0);
+        std::fill(out.begin(), out.end(), 0.0);
+        return;
     }
     
-    std::vector<double> standardized;
-    standardized.reserve(data.size());
-    
-    for (double val : data) {
-        double stdVal = (val - mean) / stdDev;
-        standardized.push_back(stdVal);
+    for (size_t i = 0; i < data.size(); ++i) {
+        out[i] = (data[i] - mean) / stdDev;
     }
-    
-    return standardized;
 }
 
-std::vector<double> DataPreprocessor::fitTransform(const std::vector<double>& data) {
+std::vector<double> DataPreprocessor::fitTransform(std::span<const double> data) {
     fit(data);
     return standardize(data);
 }
@@ -94,3 +99,18 @@ void DataPreprocessor::reset() {
     isFitted = false;
 }
 
+void DataPreprocessor::saveState(SnapshotWriter& writer) const {
+    writer.write<double>(mean);
+    writer.write<double>(stdDev);
+    writer.write<double>(minVal);
+    writer.write<double>(maxVal);
+    writer.write<uint8_t>(isFitted ? 1 : 0);
+}
+
+void DataPreprocessor::loadState(SnapshotReader& reader) {
+    mean = reader.read<double>();
+    stdDev = reader.read<double>();
+    minVal = reader.read<double>();
+    maxVal = reader.read<double>();
+    isFitted = reader.read<uint8_t>() != 0;
+}
@@ -1,4 +1,5 @@
 #include "../headers/DecisionTreeClassifier.h"
+#include "../headers/Snapshot.h"
 #include <cmath>
 #include <algorithm>
 #include <stdexcept>
@@ -8,30 +9,24 @@
 DecisionTreeClassifier::DecisionTreeClassifier(int maxDepth, int minSamplesSplit) 
     : maxDepth(maxDepth), minSamplesSplit(minSamplesSplit), root(nullptr) {}
 
-double DecisionTreeClassifier::calculateGini(const std::vector<std::vector<double>>& X, 
-                                             const std::vector<int>& y) const {
-    if (y.empty()) return 1.0;
-    
-    std::map<int, int> classCounts;
-    for (int label : y) {
-        classCounts[label]++;
-    }
+double DecisionTreeClassifier::calculateGini(std::span<const size_t> classCounts, size_t total) const {
+    if (total == 0) return 1.0;
     
     double gini = 1.0;
-    double n = static_cast<double>(y.size());
+    double n = static_cast<double>(total);
     
-    for (const auto& pair : classCounts) {
-        double p = static_cast<double>(pair.second) / n;
+    for (size_t count : classCounts) {
+        double p = static_cast<double>(count) / n;
         gini -= p * p;
     }
     
     return gini;
 }
 
-std::pair<int, double> DecisionTreeClassifier::findBestSplit(
-    const std::vector<std::vector<double>>& X, 
-    const std::vector<int>& y) const {
-    if (X.empty() || X[0].empty()) {
+std::pair<int, double> DecisionTreeClassifier::findBestSplit(const FeatureMatrix& X, 
+                                                             std::span<const int> y, 
+                                                             std::span<const size_t> rows) const {
+    if (rows.empty() || X.cols() == 0) {
         return {-1, 0.0};
     }
     
@@ -39,43 +34,65 @@ std::pair<int, double> DecisionTreeClassifier::findBestSplit(
     double bestThreshold = 0.0;
     double bestGini = 1.0;
     
-    int nFeatures = static_cast<int>(X[0].size());
+    // Dense class indices (in ascending label order) for the rows at this node
+    std::vector<int> classes;
+    classes.reserve(rows.size());
+    for (size_t row : rows) {
+        classes.push_back(y[row]);
+    }
+    std::sort(classes.begin(), classes.end());
+    classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+    auto classIndex = [&](int label) {
+        return static_cast<size_t>(std::lower_bound(classes.begin(), classes.end(), label) - classes.begin());
+    };
+    
+    std::vector<size_t> totalCounts(classes.size(), 0);
+    for (size_t row : rows) {
+        totalCounts[classIndex(y[row])]++;
+    }
+    
+    std::vector<std::pair<double, size_t>> samples(rows.size()); // (value, class index)
+    std::vector<size_t> leftCounts(classes.size());
+    std::vector<size_t> rightCounts(classes.size());
+    size_t n = rows.size();
+    
+    int nFeatures = static_cast<int>(X.cols());
     
     for (int feature = 0; feature < nFeatures; ++feature) {
-        // Get unique values for this feature
-        std::vector<double> values;
-        for (const auto& sample : X) {
-            values.push_back(sample[feature]);
+        // Sort this feature's values once and sweep the thresholds in order,
+        // moving samples to the left side as the threshold passes them
+        for (size_t j = 0; j < n; ++j) {
+            samples[j] = {X.at(rows[j], feature), classIndex(y[rows[j]])};
         }
-        std::sort(values.begin(), values.end());
-        values.erase(std::unique(values.begin(), values.end()), values.end());
+        std::sort(samples.begin(), samples.end());
+        std::fill(leftCounts.begin(), leftCounts.end(), 0);
+        size_t leftSize = 0;
         
-        // Try each threshold
-        for (size_t i = 0; i < values.size() - 1; ++i) {
-            double threshold = (values[i] + values[i + 1]) / 2.0;
+        for (size_t i = 0; i < n; ) {
+            // Next distinct value after samples[i]
+            size_t next = i;
+            while (next < n && samples[next].first == samples[i].first) ++next;
+            if (next == n) break;
             
-            // Split data
-            std::vector<std::vector<double>> XLeft, XRight;
-            std::vector<int> yLeft, yRight;
-            
-            for (size_t j = 0; j < X.size(); ++j) {
-                if (X[j][feature] <= threshold) {
-                    XLeft.push_back(X[j]);
-                    yLeft.push_back(y[j]);
-                } else {
-                    XRight.push_back(X[j]);
-                    yRight.push_back(y[j]);
-                }
+            double threshold = (samples[i].first + samples[next].first) / 2.0;
+            while (leftSize < n && samples[leftSize].first <= threshold) {
+                leftCounts[samples[leftSize].second]++;
+                leftSize++;
             }
+            i = next;
             
-            if (XLeft.empty() || XRight.empty()) continue;
+            size_t rightSize = n - leftSize;
+            if (leftSize == 0 || rightSize == 0) continue;
+            for (size_t c = 0; c < classes.size(); ++c) {
+                rightCounts[c] = totalCounts[c] - leftCounts[c];
+            }
             
             // Calculate weighted Gini
-            double giniLeft = calculateGini(XLeft, yLeft);
-            double giniRight = calculateGini(XRight, yRight);
+            double giniLeft = calculateGini(leftCounts, leftSize);
+            double giniRight = calculateGini(rightCounts, rightSize);
             
-            double weightedGini = (static_cast<double>(yLeft.size()) / y.size()) * giniLeft +
-                                  (static_cast<double>(yRight.size()) / y.size()) * giniRight;
+            double weightedGini = (static_cast<double>(leftSize) / n) * giniLeft +
+                                  (static_cast<double>(rightSize) / n) * giniRight;
             
             if (weightedGini < bestGini) {
                 bestGini = weightedGini;
@@ -88,12 +105,13 @@ std::pair<int, double> DecisionTreeClassifier::findBestSplit(
     return {bestFeature, bestThreshold};
 }
 
-int DecisionTreeClassifier::getMajorityClass(const std::vector<int>& y) const {
-    if (y.empty()) return 0;
+int DecisionTreeClassifier::getMajorityClass(std::span<const int> y, 
+                                             std::span<const size_t> rows) const {
+    if (rows.empty()) return 0;
     
     std::map<int, int> counts;
-    for (int label : y) {
-        counts[label]++;
+    for (size_t row : rows) {
+        counts[y[row]]++;
     }
     
     int maxCount = 0;
@@ -108,83 +126,79 @@ int DecisionTreeClassifier::getMajorityClass(const std::vector<int>& y) const {
     return majority;
 }
 
-std::shared_ptr<TreeNode> DecisionTreeClassifier::buildTree(
-    const std::vector<std::vector<double>>& X, 
-    const std::vector<int>& y, 
-    int depth) const {
+std::shared_ptr<TreeNode> DecisionTreeClassifier::buildTree(const FeatureMatrix& X, 
+                                                            std::span<const int> y, 
+                                                            std::span<size_t> rows, 
+                                                            int depth) const {
     
     auto node = std::make_shared<TreeNode>();
     
     // Stopping conditions
-    if (depth >= maxDepth || static_cast<int>(y.size()) < minSamplesSplit) {
-        node->prediction = getMajorityClass(y);
+    if (depth >= maxDepth || static_cast<int>(rows.size()) < minSamplesSplit) {
+        node->prediction = getMajorityClass(y, rows);
         return node;
     }
     
     // Check if all labels are the same
     bool allSame = true;
-    for (size_t i = 1; i < y.size(); ++i) {
-        if (y[i] != y[0]) {
+    for (size_t i = 1; i < rows.size(); ++i) {
+        if (y[rows[i]] != y[rows[0]]) {
             allSame = false;
             break;
         }
     }
     if (allSame) {
-        node->prediction = y[0];
+        node->prediction = rows.empty() ? 0 : y[rows[0]];
         return node;
     }
     
     // Find best split
-    auto [feature, threshold] = findBestSplit(X, y);
+    auto [feature, threshold] = findBestSplit(X, y, rows);
     
     if (feature == -1) {
-        node->prediction = getMajorityClass(y);
+        node->prediction = getMajorityClass(y, rows);
         return node;
     }
     
-    // Split data
-    std::vector<std::vector<double>> XLeft, XRight;
-    std::vector<int> yLeft, yRight;
-    
-    for (size_t i = 0; i < X.size(); ++i) {
-        if (X[i][feature] <= threshold) {
-            XLeft.push_back(X[i]);
-            yLeft.push_back(y[i]);
-        } else {
-            XRight.push_back(X[i]);
-            yRight.push_back(y[i]);
-        }
-    }
+    // Split data: rows going left are moved to the front of the span
+    auto middle = std::partition(rows.begin(), rows.end(), [&](size_t row) {
+        return X.at(row, feature) <= threshold;
+    });
+    std::span<size_t> leftRows = rows.first(middle - rows.begin());
+    std::span<size_t> rightRows = rows.subspan(leftRows.size());
     
-    if (XLeft.empty() || XRight.empty()) {
-        node->prediction = getMajorityClass(y);
+    if (leftRows.empty() || rightRows.empty()) {
+        node->prediction = getMajorityClass(y, rows);
         return node;
     }
     
     // Build left and right subtrees
     node->featureIndex = feature;
     node->threshold = threshold;
-    node->left = buildTree(XLeft, yLeft, depth + 1);
-    node->right = buildTree(XRight, yRight, depth + 1);
+    node->left = buildTree(X, y, leftRows, depth + 1);
+    node->right = buildTree(X, y, rightRows, depth + 1);
     
     return node;
 }
 
-void DecisionTreeClassifier::fit(const std::vector<std::vector<double>>& X, 
-                                 const std::vector<int>& y) {
+void DecisionTreeClassifier::fit(const FeatureMatrix& X, std::span<const int> y) {
     if (X.empty() || y.empty()) {
         throw std::runtime_error("Training data is empty");
     }
     
-    if (X.size() != y.size()) {
+    if (X.rows() != y.size()) {
         throw std::runtime_error("X and y must have the same size");
     }
     
-    root = buildTree(X, y, 0);
+    std::vector<size_t> rows(X.rows());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i] = i;
+    }
+    root = buildTree(X, y, rows, 0);
 }
 
-int DecisionTreeClassifier::predictSample(const std::vector<double>& sample, 
-                                          std::shared_ptr<TreeNode> node) const {
+int DecisionTreeClassifier::predictSample(std::span<const double> sample, 
+                                          const std::shared_ptr<TreeNode>& node) const {
     if (!node) {
         return 0; // Default prediction
     }
@@ -202,23 +216,22 @@ int DecisionTreeClassifier::predictSample(const std::vector<double>& sample,
     }
 }
 
-std::vector<int> DecisionTreeClassifier::predict(
-    const std::vector<std::vector<double>>& X) const {
+std::vector<int> DecisionTreeClassifier::predict(const FeatureMatrix& X) const {
     if (!root) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
     
     std::vector<int> predictions;
-    predictions.reserve(X.size());
+    predictions.reserve(X.rows());
     
-    for (const auto& sample : X) {
-        predictions.push_back(predictSample(sample, root));
+    for (size_t i = 0; i < X.rows(); ++i) {
+        predictions.push_back(predictSample(X.row(i), root));
     }
     
     return predictions;
 }
 
-int DecisionTreeClassifier::predictSingle(const std::vector<double>& sample) const {
+int DecisionTreeClassifier::predictSingle(std::span<const double> sample) const {
     if (!root) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
@@ -255,3 +268,44 @@ std::shared_ptr<TreeNode> DecisionTreeClassifier::getRoot() const {
     return root;
 }
 
+void DecisionTreeClassifier::saveNode(SnapshotWriter& writer, 
+                                      const std::shared_ptr<TreeNode>& node) const {
+    // Pre-order with a presence flag per child slot
+    writer.write<uint8_t>(node ? 1 : 0);
+    if (!node) return;
+    
+    writer.write<int32_t>(node->featureIndex);
+    writer.write<double>(node->threshold);
+    writer.write<int32_t>(node->prediction);
+    saveNode(writer, node->left);
+    saveNode(writer, node->right);
+}
+
+std::shared_ptr<TreeNode> DecisionTreeClassifier::loadNode(SnapshotReader& reader, int depth) {
+    if (reader.read<uint8_t>() == 0) {
+        return nullptr;
+    }
+    if (depth > maxDepth + 1) {
+        throw std::runtime_error("Corrupt decision tree snapshot state");
+    }
+    
+    auto node = std::make_shared<TreeNode>();
+    node->featureIndex = reader.read<int32_t>();
+    node->threshold = reader.read<double>();
+    node->prediction = reader.read<int32_t>();
+    node->left = loadNode(reader, depth + 1);
+    node->right = loadNode(reader, depth + 1);
+    return node;
+}
+
+void DecisionTreeClassifier::saveState(SnapshotWriter& writer) const {
+    writer.write<int32_t>(maxDepth);
+    writer.write<int32_t>(minSamplesSplit);
+    saveNode(writer, root);
+}
+
+void DecisionTreeClassifier::loadState(SnapshotReader& reader) {
+    maxDepth = reader.read<int32_t>();
+    minSamplesSplit = reader.read<int32_t>();
+    root = loadNode(reader, 0);
+}
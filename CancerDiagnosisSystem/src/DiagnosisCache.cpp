@@ -0,0 +1,67 @@
+#include "../headers/DiagnosisCache.h"
+#include <algorithm>
+#include <functional>
+
+DiagnosisCache::DiagnosisCache(size_t capacity, size_t shardCount)
+    : shardCapacity(std::max<size_t>(1, (capacity + shardCount - 1) / shardCount)), hits(0), misses(0) {
+    shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+DiagnosisCache::Shard& DiagnosisCache::shardFor(const Key& key) const {
+    return *shards[std::hash<Symbol>()(key.patientId) % shards.size()];
+}
+
+bool DiagnosisCache::find(const Key& key, double& riskScore) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.slots.find(slotKey(key));
+    if (it == shard.slots.end() || it->second->key.patientRevision != key.patientRevision ||
+        it->second->key.tableVersion != key.tableVersion || it->second->key.modelVersion != key.modelVersion) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    shard.recency.splice(shard.recency.begin(), shard.recency, it->second);
+    riskScore = it->second->riskScore;
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void DiagnosisCache::store(const Key& key, double riskScore) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.slots.find(slotKey(key));
+    if (it != shard.slots.end()) {
+        // Replaces the score of older versions (or of a racing diagnosis)
+        it->second->key = key;
+        it->second->riskScore = riskScore;
+        shard.recency.splice(shard.recency.begin(), shard.recency, it->second);
+        return;
+    }
+    if (shard.slots.size() >= shardCapacity) {
+        shard.slots.erase(slotKey(shard.recency.back().key));
+        shard.recency.pop_back();
+    }
+    shard.recency.push_front({key, riskScore});
+    shard.slots.emplace(slotKey(key), shard.recency.begin());
+}
+
+void DiagnosisCache::clear() {
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->slots.clear();
+        shard->recency.clear();
+    }
+}
+
+DiagnosisCache::Stats DiagnosisCache::getStats() const {
+    Stats stats{hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed), 0,
+                shardCapacity * shards.size()};
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.entries += shard->slots.size();
+    }
+    return stats;
+}
@@ -0,0 +1,46 @@
+#include "../headers/DiagnosisWorkerPool.h"
+
+DiagnosisWorkerPool::DiagnosisWorkerPool(size_t workerCount, std::function<bool()> processNext)
+    : processNext(std::move(processNext)), signal(0), stopping(false) {
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&DiagnosisWorkerPool::run, this);
+    }
+}
+
+DiagnosisWorkerPool::~DiagnosisWorkerPool() {
+    stop();
+}
+
+void DiagnosisWorkerPool::notify() {
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+}
+
+void DiagnosisWorkerPool::stop() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void DiagnosisWorkerPool::run() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        // Read the signal before looking for work, so an item queued after
+        // the check below changes it and the wait returns immediately
+        uint64_t seen = signal.load(std::memory_order_acquire);
+        if (processNext()) {
+            continue;
+        }
+        if (stopping.load(std::memory_order_acquire)) {
+            break;
+        }
+        signal.wait(seen, std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,63 @@
+#include "../headers/GeneticColumnEncoder.h"
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+template <typename T>
+void appendRaw(std::string& out, const T* values, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "Encoded values must be trivially copyable");
+    out.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+void padToAlignment(std::string& out) {
+    out.resize((out.size() + 7) & ~size_t(7), '\0');
+}
+
+} // namespace
+
+void GeneticColumnEncoder::encode(const GeneticDataTable& table, std::string& out) {
+    std::span<const Symbol> geneIds = table.geneIdColumn();
+    std::span<const double> scores = table.mutationScoreColumn();
+    std::span<const int> labels = table.labelColumn();
+    size_t rows = table.size();
+
+    // Dictionary of distinct IDs in order of first appearance
+    std::vector<Symbol> dictionary;
+    std::vector<uint32_t> geneIndex(rows);
+    std::unordered_map<Symbol, uint32_t> indexBySymbol;
+    size_t dictionaryBytes = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        auto inserted = indexBySymbol.try_emplace(geneIds[i], static_cast<uint32_t>(dictionary.size()));
+        if (inserted.second) {
+            dictionary.push_back(geneIds[i]);
+            dictionaryBytes += sizeof(uint32_t) + geneIds[i].str().size();
+        }
+        geneIndex[i] = inserted.first->second;
+    }
+
+    GeneticColumnsHeader header;
+    std::memcpy(header.magic, "CDSG", 4);
+    header.version = kVersion;
+    header.rowCount = rows;
+    header.dictionarySize = static_cast<uint32_t>(dictionary.size());
+    header.reserved = 0;
+
+    out.clear();
+    out.reserve(sizeof(header) + dictionaryBytes + 8 + rows * (sizeof(uint32_t) + sizeof(double) + sizeof(int32_t)) + 16);
+    appendRaw(out, &header, 1);
+    for (Symbol symbol : dictionary) {
+        const std::string& id = symbol.str();
+        uint32_t length = static_cast<uint32_t>(id.size());
+        appendRaw(out, &length, 1);
+        out.append(id);
+    }
+    padToAlignment(out);
+    appendRaw(out, geneIndex.data(), rows);
+    padToAlignment(out);
+    appendRaw(out, scores.data(), rows);
+    static_assert(sizeof(int) == sizeof(int32_t), "Labels are encoded as int32");
+    appendRaw(out, labels.data(), rows);
+}
@@ -2,12 +2,19 @@
 #include <iostream>
 #include <iomanip>
 
-GeneticData::GeneticData() : geneId(""), mutationScore(0.0), label(0) {}
+GeneticData::GeneticData() : geneId(), mutationScore(0.0), label(0) {}
 
-GeneticData::GeneticData(const std::string& id, double score, int lbl) 
+GeneticData::GeneticData(std::string_view id, double score, int lbl) 
     : geneId(id), mutationScore(score), label(lbl) {}
 
-std::string GeneticData::getGeneId() const {
+GeneticData::GeneticData(Symbol id, double score, int lbl) 
+    : geneId(id), mutationScore(score), label(lbl) {}
+
+const std::string& GeneticData::getGeneId() const {
+    return geneId.str();
+}
+
+Symbol GeneticData::getGeneSymbol() const {
     return geneId;
 }
 
@@ -19,8 +26,8 @@ int GeneticData::getLabel() const {
     return label;
 }
 
-void GeneticData::setGeneId(const std::string& id) {
-    geneId = id;
+void GeneticData::setGeneId(std::string_view id) {
+    geneId = Symbol(id);
 }
 
 void GeneticData::setMutationScore(double score) {
@@ -32,7 +39,7 @@ void GeneticData::setLabel(int lbl) {
 }
 
 void GeneticData::display() const {
-    std::cout << "Gene ID: " << geneId 
+    std::cout << "Gene ID: " << geneId.str() 
               << ", Mutation Score: " << std::fixed << std::setprecision(4) << mutationScore
               << ", Label: " << (label == 1 ? "Cancerous" : "Non-Cancerous") << std::endl;
 }
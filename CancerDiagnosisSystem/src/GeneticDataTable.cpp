@@ -0,0 +1,28 @@
+#include "../headers/GeneticDataTable.h"
+
+size_t GeneticDataTable::append(Symbol geneId, double mutationScore, int label) {
+    geneIds.push_back(geneId);
+    mutationScores.push_back(mutationScore);
+    labels.push_back(label);
+    return mutationScores.size() - 1;
+}
+
+size_t GeneticDataTable::append(const GeneticData& data) {
+    return append(data.getGeneSymbol(), data.getMutationScore(), data.getLabel());
+}
+
+GeneticData GeneticDataTable::getRow(size_t index) const {
+    return GeneticData(geneIds[index], mutationScores[index], labels[index]);
+}
+
+void GeneticDataTable::reserve(size_t count) {
+    geneIds.reserve(count);
+    mutationScores.reserve(count);
+    labels.reserve(count);
+}
+
+void GeneticDataTable::clear() {
+    geneIds.clear();
+    mutationScores.clear();
+    labels.clear();
+}
@@ -1,6 +1,20 @@
 #include "../headers/HashMapper.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kMinSlots = 16;
+
+// Symbol IDs are dense, so mix them before taking the low bits as the slot
+uint64_t hashMutation(Symbol mutation) {
+    uint64_t h = mutation.id() * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 32);
+}
+
+} // namespace
 
 HashMapper::HashMapper() {
     // Initialize default label mappings
@@ -8,20 +22,92 @@ HashMapper::HashMapper() {
     labelToCategoryMap[1] = "Cancerous";
 }
 
-void HashMapper::addMutationMapping(const std::string& mutation, double riskScore) {
-    mutationToRiskMap[mutation] = riskScore;
+HashMapper::MutationId HashMapper::find(Symbol mutation) const {
+    if (slots.empty()) {
+        return kNoMutation;
+    }
+    size_t mask = slots.size() - 1;
+    for (size_t pos = hashMutation(mutation) & mask; ; pos = (pos + 1) & mask) {
+        const Slot& slot = slots[pos];
+        if (slot.id == kNoMutation) {
+            return kNoMutation;
+        }
+        if (slot.mutation == mutation) {
+            return slot.id;
+        }
+    }
 }
 
-double HashMapper::getRiskScore(const std::string& mutation) const {
-    auto it = mutationToRiskMap.find(mutation);
-    if (it != mutationToRiskMap.end()) {
-        return it->second;
+void HashMapper::insertSlot(MutationId id) {
+    size_t mask = slots.size() - 1;
+    size_t pos = hashMutation(mutationKeys[id]) & mask;
+    while (slots[pos].id != kNoMutation) {
+        pos = (pos + 1) & mask;
     }
-    return 0.0; // Default risk score if mutation not found
+    slots[pos] = Slot{mutationKeys[id], id};
+}
+
+void HashMapper::rehash(size_t slotCount) {
+    slots.assign(slotCount, Slot{Symbol(), kNoMutation});
+    for (MutationId id = 0; id < mutationRiskScores.size(); ++id) {
+        insertSlot(id);
+    }
+}
+
+HashMapper::MutationId HashMapper::addMutationMapping(std::string_view mutation, double riskScore) {
+    return addMutationMapping(Symbol(mutation), riskScore);
+}
+
+HashMapper::MutationId HashMapper::addMutationMapping(Symbol mutation, double riskScore) {
+    MutationId id = find(mutation);
+    if (id != kNoMutation) {
+        mutationRiskScores[id] = riskScore;
+        return id;
+    }
+
+    // Keep the load factor at or below 3/4 so probe sequences stay short
+    if ((mutationRiskScores.size() + 1) * 4 > slots.size() * 3) {
+        rehash(std::max(kMinSlots, slots.size() * 2));
+    }
+
+    id = static_cast<MutationId>(mutationRiskScores.size());
+    mutationKeys.push_back(mutation);
+    mutationRiskScores.push_back(riskScore);
+    insertSlot(id);
+    return id;
 }
 
-bool HashMapper::hasMutation(const std::string& mutation) const {
-    return mutationToRiskMap.find(mutation) != mutationToRiskMap.end();
+double HashMapper::getRiskScore(std::string_view mutation) const {
+    return getRiskScore(getMutationId(mutation)); // 0.0 if mutation not found
+}
+
+bool HashMapper::hasMutation(std::string_view mutation) const {
+    return getMutationId(mutation) != kNoMutation;
+}
+
+HashMapper::MutationId HashMapper::getMutationId(std::string_view mutation) const {
+    // Strings that were never interned cannot be mapped
+    Symbol symbol;
+    return StringInterner::global().find(mutation, symbol) ? find(symbol) : kNoMutation;
+}
+
+HashMapper::MutationId HashMapper::getMutationId(Symbol mutation) const {
+    return find(mutation);
+}
+
+double HashMapper::getRiskScore(MutationId id) const {
+    return id < mutationRiskScores.size() ? mutationRiskScores[id] : 0.0;
+}
+
+void HashMapper::getRiskScores(std::span<const MutationId> ids, std::span<double> out) const {
+    if (ids.size() != out.size()) {
+        throw std::runtime_error("Mutation IDs and output must have the same size");
+    }
+    const double* scores = mutationRiskScores.data();
+    size_t count = mutationRiskScores.size();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        out[i] = ids[i] < count ? scores[ids[i]] : 0.0;
+    }
 }
 
 void HashMapper::setLabelCategory(int label, const std::string& category) {
@@ -36,22 +122,43 @@ std::string HashMapper::getCategory(int label) const {
     return "Unknown";
 }
 
-void HashMapper::buildMutationMap(const std::vector<std::string>& mutations, 
+void HashMapper::buildMutationMap(const std::vector<std::string>& mutations,
                                   const std::vector<double>& riskScores) {
     if (mutations.size() != riskScores.size()) {
         throw std::runtime_error("Mutations and risk scores must have the same size");
     }
-    
+
+    reserve(size() + mutations.size());
     for (size_t i = 0; i < mutations.size(); ++i) {
-        mutationToRiskMap[mutations[i]] = riskScores[i];
+        addMutationMapping(mutations[i], riskScores[i]);
     }
 }
 
+void HashMapper::reserve(size_t mutationCount) {
+    size_t slotCount = kMinSlots;
+    while (mutationCount * 4 > slotCount * 3) {
+        slotCount *= 2;
+    }
+    if (slotCount > slots.size()) {
+        rehash(slotCount);
+    }
+    mutationKeys.reserve(mutationCount);
+    mutationRiskScores.reserve(mutationCount);
+}
+
 void HashMapper::displayMappings() const {
     std::cout << "\n=== Mutation to Risk Mappings ===" << std::endl;
-    for (const auto& pair : mutationToRiskMap) {
-        std::cout << "Mutation: " << std::setw(15) << pair.first 
-                  << " -> Risk Score: " << std::fixed << std::setprecision(4) << pair.second << std::endl;
+    // Listed in key order
+    std::vector<MutationId> order(mutationRiskScores.size());
+    for (MutationId id = 0; id < order.size(); ++id) {
+        order[id] = id;
+    }
+    std::sort(order.begin(), order.end(), [this](MutationId a, MutationId b) {
+        return mutationKeys[a].str() < mutationKeys[b].str();
+    });
+    for (MutationId id : order) {
+        std::cout << "Mutation: " << std::setw(15) << mutationKeys[id].str()
+                  << " -> Risk Score: " << std::fixed << std::setprecision(4) << mutationRiskScores[id] << std::endl;
     }
     std::cout << "\n=== Label to Category Mappings ===" << std::endl;
     for (const auto& pair : labelToCategoryMap) {
@@ -61,6 +168,5 @@ void HashMapper::displayMappings() const {
 }
 
 size_t HashMapper::size() const {
-    return mutationToRiskMap.size();
+    return mutationRiskScores.size();
 }
-
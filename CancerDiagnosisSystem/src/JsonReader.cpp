@@ -0,0 +1,376 @@
+#include "../headers/JsonReader.h"
+#include "../headers/CsvScanner.h"
+#include <charconv>
+#include <climits>
+#include <cmath>
+
+namespace {
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool readHex4(std::string_view raw, size_t at, uint32_t& out) {
+    if (at + 4 > raw.size()) {
+        return false;
+    }
+    out = 0;
+    for (size_t i = at; i < at + 4; ++i) {
+        int digit = hexValue(raw[i]);
+        if (digit < 0) {
+            return false;
+        }
+        out = (out << 4) | static_cast<uint32_t>(digit);
+    }
+    return true;
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+} // namespace
+
+JsonReader::JsonReader(std::string_view text) : text(text), position(0), depth(0) {}
+
+void JsonReader::skipWhitespace() {
+    while (position < text.size()) {
+        char c = text[position];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            break;
+        }
+        position++;
+    }
+}
+
+bool JsonReader::fail(const char* message) {
+    // Keep the first (innermost) error
+    if (error.empty()) {
+        error = std::string(message) + " at offset " + std::to_string(position);
+    }
+    return false;
+}
+
+bool JsonReader::consume(char expected) {
+    if (!ok()) {
+        return false;
+    }
+    skipWhitespace();
+    if (position >= text.size() || text[position] != expected) {
+        std::string message = "Expected '";
+        message += expected;
+        message += "'";
+        return fail(message.c_str());
+    }
+    position++;
+    return true;
+}
+
+bool JsonReader::consumeLiteral(std::string_view literal) {
+    if (text.substr(position, literal.size()) != literal) {
+        return fail("Invalid literal");
+    }
+    position += literal.size();
+    return true;
+}
+
+bool JsonReader::enter() {
+    if (++depth > kMaxDepth) {
+        return fail("Nesting too deep");
+    }
+    return true;
+}
+
+JsonReader::Type JsonReader::peek() {
+    if (!ok()) {
+        return Type::NONE;
+    }
+    skipWhitespace();
+    if (position >= text.size()) {
+        return Type::NONE;
+    }
+    char c = text[position];
+    switch (c) {
+        case '{': return Type::OBJECT;
+        case '[': return Type::ARRAY;
+        case '"': return Type::STRING;
+        case 't':
+        case 'f': return Type::BOOLEAN;
+        case 'n': return Type::NULL_VALUE;
+        default:
+            return (c == '-' || isDigit(c)) ? Type::NUMBER : Type::NONE;
+    }
+}
+
+bool JsonReader::scanString(std::string_view& raw, bool& escaped) {
+    if (!consume('"')) {
+        return false;
+    }
+    size_t start = position;
+    escaped = false;
+    while (position < text.size()) {
+        char c = text[position];
+        if (c == '"') {
+            raw = text.substr(start, position - start);
+            position++;
+            return true;
+        }
+        if (c == '\\') {
+            escaped = true;
+            position++; // The escaped character is checked by unescape()
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            return fail("Control character in string");
+        }
+        position++;
+    }
+    return fail("Unterminated string");
+}
+
+bool JsonReader::scanNumber(std::string_view& literal) {
+    skipWhitespace();
+    size_t start = position;
+    if (position < text.size() && text[position] == '-') {
+        position++;
+    }
+    // Integer part: 0, or a digit sequence not starting with 0
+    if (position < text.size() && text[position] == '0') {
+        position++;
+    } else if (position < text.size() && isDigit(text[position])) {
+        while (position < text.size() && isDigit(text[position])) position++;
+    } else {
+        return fail("Invalid number");
+    }
+    if (position < text.size() && text[position] == '.') {
+        position++;
+        if (position >= text.size() || !isDigit(text[position])) {
+            return fail("Invalid number");
+        }
+        while (position < text.size() && isDigit(text[position])) position++;
+    }
+    if (position < text.size() && (text[position] == 'e' || text[position] == 'E')) {
+        position++;
+        if (position < text.size() && (text[position] == '+' || text[position] == '-')) {
+            position++;
+        }
+        if (position >= text.size() || !isDigit(text[position])) {
+            return fail("Invalid number");
+        }
+        while (position < text.size() && isDigit(text[position])) position++;
+    }
+    literal = text.substr(start, position - start);
+    return true;
+}
+
+bool JsonReader::readKey(std::string_view& key) {
+    bool escaped = false;
+    if (!scanString(key, escaped) || !consume(':')) {
+        return false;
+    }
+    if (escaped) {
+        if (!unescape(key, keyScratch)) {
+            return fail("Invalid escape in key");
+        }
+        key = keyScratch;
+    }
+    return true;
+}
+
+bool JsonReader::nextInContainer(char close, bool first, bool& done) {
+    if (!ok()) {
+        return false;
+    }
+    skipWhitespace();
+    if (position < text.size() && text[position] == close) {
+        position++;
+        done = true;
+        return true;
+    }
+    done = false;
+    return first || consume(',');
+}
+
+bool JsonReader::readString(std::string_view& out, std::string& scratch) {
+    std::string_view raw;
+    bool escaped = false;
+    if (peek() != Type::STRING) {
+        return fail("Expected a string");
+    }
+    if (!scanString(raw, escaped)) {
+        return false;
+    }
+    if (!escaped) {
+        out = raw;
+        return true;
+    }
+    if (!unescape(raw, scratch)) {
+        return fail("Invalid escape in string");
+    }
+    out = scratch;
+    return true;
+}
+
+bool JsonReader::readString(std::string& out) {
+    std::string_view view;
+    std::string scratch;
+    if (!readString(view, scratch)) {
+        return false;
+    }
+    out.assign(view);
+    return true;
+}
+
+bool JsonReader::readNumber(double& out) {
+    Type type = peek();
+    if (type == Type::STRING) {
+        std::string_view view;
+        std::string scratch;
+        // The CSV parser also takes "nan" and "inf", which JSON numbers cannot express
+        if (!readString(view, scratch) || !CsvScanner::parseDouble(view, out) || !std::isfinite(out)) {
+            return fail("Expected a number");
+        }
+        return true;
+    }
+    if (type != Type::NUMBER) {
+        return fail("Expected a number");
+    }
+    std::string_view literal;
+    if (!scanNumber(literal)) {
+        return false;
+    }
+    auto result = std::from_chars(literal.data(), literal.data() + literal.size(), out);
+    if (result.ec != std::errc()) {
+        return fail("Number out of range");
+    }
+    return true;
+}
+
+bool JsonReader::readInt(int& out) {
+    double value = 0.0;
+    if (!readNumber(value)) {
+        return false;
+    }
+    if (value != std::floor(value) || value < INT_MIN || value > INT_MAX) {
+        return fail("Expected a whole number");
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+bool JsonReader::readBool(bool& out) {
+    if (peek() != Type::BOOLEAN) {
+        return fail("Expected true or false");
+    }
+    out = text[position] == 't';
+    return consumeLiteral(out ? "true" : "false");
+}
+
+bool JsonReader::readNull() {
+    if (peek() != Type::NULL_VALUE) {
+        return fail("Expected null");
+    }
+    return consumeLiteral("null");
+}
+
+bool JsonReader::skipValue() {
+    std::string_view ignored;
+    bool escaped = false;
+    bool flag = false;
+    switch (peek()) {
+        case Type::OBJECT:
+            return readObject([&](std::string_view) { return skipValue(); });
+        case Type::ARRAY:
+            return readArray([&] { return skipValue(); });
+        case Type::STRING:
+            // Escapes are not validated in skipped strings
+            return scanString(ignored, escaped);
+        case Type::NUMBER:
+            return scanNumber(ignored);
+        case Type::BOOLEAN:
+            return readBool(flag);
+        case Type::NULL_VALUE:
+            return readNull();
+        default:
+            return fail("Expected a value");
+    }
+}
+
+bool JsonReader::finish() {
+    if (!ok()) {
+        return false;
+    }
+    skipWhitespace();
+    if (position != text.size()) {
+        return fail("Unexpected data after the value");
+    }
+    return true;
+}
+
+bool JsonReader::unescape(std::string_view raw, std::string& out) {
+    out.clear();
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char c = raw[i];
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (++i >= raw.size()) {
+            return false;
+        }
+        switch (raw[i]) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!readHex4(raw, i + 1, codePoint)) {
+                    return false;
+                }
+                i += 4;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    // High surrogate; must be followed by an escaped low surrogate
+                    uint32_t low = 0;
+                    if (i + 2 >= raw.size() || raw[i + 1] != '\\' || raw[i + 2] != 'u' ||
+                        !readHex4(raw, i + 3, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    i += 6;
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return false;
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
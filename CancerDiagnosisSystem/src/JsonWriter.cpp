@@ -0,0 +1,132 @@
+#include "../headers/JsonWriter.h"
+#include <charconv>
+#include <cmath>
+
+JsonWriter::JsonWriter() : afterKey(false) {}
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false; // The value completes a member; its comma came before the key
+        return;
+    }
+    if (!hasValue.empty()) {
+        if (hasValue.back()) {
+            buffer.push_back(',');
+        }
+        hasValue.back() = true;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    buffer.push_back('{');
+    hasValue.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    buffer.push_back('}');
+    hasValue.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    buffer.push_back('[');
+    hasValue.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    buffer.push_back(']');
+    hasValue.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    buffer.push_back('"');
+    appendEscaped(buffer, name);
+    buffer += "\":";
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    buffer.push_back('"');
+    appendEscaped(buffer, text);
+    buffer.push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int number) {
+    return value(static_cast<int64_t>(number));
+}
+
+JsonWriter& JsonWriter::value(int64_t number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(uint64_t number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    if (!std::isfinite(number)) {
+        return null(); // JSON has no NaN or infinity
+    }
+    separate();
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    buffer += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    buffer += "null";
+    return *this;
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view text) {
+    static const char kHex[] = "0123456789abcdef";
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // Copy the plain run before this character in one go
+        out.append(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out.push_back(kHex[c >> 4]);
+                out.push_back(kHex[c & 0xF]);
+        }
+    }
+    out.append(text.data() + runStart, text.size() - runStart);
+}
@@ -1,17 +1,17 @@
 #include "../headers/KNNClassifier.h"
+#include "../headers/Snapshot.h"
 #include <cmath>
 #include <algorithm>
 #include <stdexcept>
 #include <map>
 
-KNNClassifier::KNNClassifier(int k) : k(k), isTrained(false) {
+KNNClassifier::KNNClassifier(int k) : featureCount(0), k(k), isTrained(false) {
     if (k <= 0) {
         throw std::runtime_error("K must be positive");
     }
 }
 
-double KNNClassifier::euclideanDistance(const std::vector<double>& a, 
-                                        const std::vector<double>& b) const {
+double KNNClassifier::euclideanDistance(std::span<const double> a, std::span<const double> b) const {
     if (a.size() != b.size()) {
         throw std::runtime_error("Feature vectors must have the same size");
     }
@@ -26,17 +26,18 @@ double KNNClassifier::euclideanDistance(const std::vector<double>& a,
 }
 
 std::vector<std::pair<double, int>> KNNClassifier::findKNearest(
-    const std::vector<double>& sample) const {
+    std::span<const double> sample) const {
     if (!isTrained) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
     
+    FeatureMatrix training(X_train, featureCount);
     std::vector<std::pair<double, int>> distances;
-    distances.reserve(X_train.size());
+    distances.reserve(y_train.size());
     
     // Calculate distances to all training samples
-    for (size_t i = 0; i < X_train.size(); ++i) {
-        double dist = euclideanDistance(sample, X_train[i]);
+    for (size_t i = 0; i < y_train.size(); ++i) {
+        double dist = euclideanDistance(sample, training.row(i));
         distances.push_back({dist, y_train[i]});
     }
     
@@ -75,61 +76,63 @@ int KNNClassifier::majorityVote(const std::vector<std::pair<double, int>>& neigh
     return predictedLabel;
 }
 
-void KNNClassifier::fit(const std::vector<std::vector<double>>& X, 
-                       const std::vector<int>& y) {
+void KNNClassifier::fit(const FeatureMatrix& X, std::span<const int> y) {
     if (X.empty() || y.empty()) {
         throw std::runtime_error("Training data is empty");
     }
     
-    if (X.size() != y.size()) {
+    if (X.rows() != y.size()) {
         throw std::runtime_error("X and y must have the same size");
     }
     
-    X_train = X;
-    y_train = y;
+    // KNN keeps its own copy of the samples, as one flat block
+    X_train.assign(X.data().begin(), X.data().end());
+    y_train.assign(y.begin(), y.end());
+    featureCount = X.cols();
     isTrained = true;
 }
 
-std::vector<int> KNNClassifier::predict(const std::vector<std::vector<double>>& X) const {
+std::vector<int> KNNClassifier::predict(const FeatureMatrix& X) const {
     std::vector<int> predictions;
-    predictions.reserve(X.size());
+    predictions.reserve(X.rows());
     
-    for (const auto& sample : X) {
-        auto neighbors = findKNearest(sample);
-        predictions.push_back(majorityVote(neighbors));
+    for (size_t i = 0; i < X.rows(); ++i) {
+        predictions.push_back(predictSingle(X.row(i)));
     }
     
     return predictions;
 }
 
-int KNNClassifier::predictSingle(const std::vector<double>& sample) const {
+int KNNClassifier::predictSingle(std::span<const double> sample) const {
     auto neighbors = findKNearest(sample);
     return majorityVote(neighbors);
 }
 
-std::vector<double> KNNClassifier::predictProbability(
-    const std::vector<std::vector<double>>& X) const {
+std::vector<double> KNNClassifier::predictProbability(const FeatureMatrix& X) const {
     std::vector<double> probabilities;
-    probabilities.reserve(X.size());
-    
-    for (const auto& sample : X) {
-        auto neighbors = findKNearest(sample);
-        
-        // Calculate probability as proportion of positive neighbors
-        int positiveCount = 0;
-        for (const auto& neighbor : neighbors) {
-            if (neighbor.second == 1) {
-                positiveCount++;
-            }
-        }
-        
-        double prob = static_cast<double>(positiveCount) / neighbors.size();
-        probabilities.push_back(prob);
+    probabilities.reserve(X.rows());
+    
+    for (size_t i = 0; i < X.rows(); ++i) {
+        probabilities.push_back(predictProbabilitySingle(X.row(i)));
     }
     
     return probabilities;
 }
 
+double KNNClassifier::predictProbabilitySingle(std::span<const double> sample) const {
+    auto neighbors = findKNearest(sample);
+    
+    // Calculate probability as proportion of positive neighbors
+    int positiveCount = 0;
+    for (const auto& neighbor : neighbors) {
+        if (neighbor.second == 1) {
+            positiveCount++;
+        }
+    }
+    
+    return static_cast<double>(positiveCount) / neighbors.size();
+}
+
 void KNNClassifier::setK(int k) {
     if (k <= 0) {
         throw std::runtime_error("K must be positive");
@@ -145,3 +148,25 @@ bool KNNClassifier::getIsTrained() const {
     return isTrained;
 }
 
+void KNNClassifier::saveState(SnapshotWriter& writer) const {
+    writer.write<int32_t>(k);
+    writer.write<uint8_t>(isTrained ? 1 : 0);
+    
+    // Training rows are stored as one flattened row-major block
+    writer.write<uint64_t>(featureCount);
+    writer.writeArray(X_train);
+    writer.writeArray(y_train);
+}
+
+void KNNClassifier::loadState(SnapshotReader& reader) {
+    k = reader.read<int32_t>();
+    isTrained = reader.read<uint8_t>() != 0;
+    
+    featureCount = reader.read<uint64_t>();
+    X_train = reader.readArray<double>();
+    y_train = reader.readArray<int>();
+    if (k <= 0 || (featureCount == 0 && !X_train.empty()) ||
+        (featureCount != 0 && X_train.size() != y_train.size() * featureCount)) {
+        throw std::runtime_error("Corrupt KNN snapshot state");
+    }
+}
@@ -0,0 +1,203 @@
+#include "../headers/Logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+// How often the drain thread writes out buffered messages
+constexpr std::chrono::milliseconds kDrainInterval(20);
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO ";
+        case LogLevel::WARN: return "WARN ";
+        default: return "ERROR";
+    }
+}
+
+// 2026-01-31T09:15:02.417Z
+void appendTimestamp(std::string& out, int64_t timeNanos) {
+    std::time_t seconds = static_cast<std::time_t>(timeNanos / 1000000000);
+    int millis = static_cast<int>(timeNanos / 1000000 % 1000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", utc.tm_year + 1900,
+                               utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, millis);
+    out.append(text, std::min<size_t>(length, sizeof(text) - 1));
+}
+
+} // namespace
+
+Logger::Logger() : level(LogLevel::INFO), nextThreadNumber(1), stopping(false) {
+    drainThread = std::thread([this] { drainLoop(); });
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    drainThread.join();
+    flush();
+}
+
+Logger& Logger::global() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::ThreadRing::~ThreadRing() {
+    if (ring) {
+        ring->retired.store(true, std::memory_order_release);
+    }
+}
+
+Logger::Ring& Logger::threadRing() {
+    thread_local ThreadRing current;
+    if (!current.ring) {
+        auto ring = std::make_unique<Ring>();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        ring->threadNumber = nextThreadNumber++;
+        current.ring = ring.get();
+        rings.push_back(std::move(ring));
+    }
+    return *current.ring;
+}
+
+void Logger::log(LogLevel messageLevel, std::string_view message, bool truncated) {
+    Ring& ring = threadRing();
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t used = tail - ring.head.load(std::memory_order_acquire);
+    if (used == Ring::kCapacity) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Record& record = ring.records[tail % Ring::kCapacity];
+    record.timeNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.level = messageLevel;
+    record.truncated = truncated || message.size() > kMaxMessageLength;
+    record.length = static_cast<uint16_t>(std::min(message.size(), kMaxMessageLength));
+    std::memcpy(record.text, message.data(), record.length);
+    ring.tail.store(tail + 1, std::memory_order_release);
+    // Don't wait for the next interval if the ring is filling up, or for errors
+    if (used + 1 == Ring::kCapacity / 2 || messageLevel >= LogLevel::ERROR) {
+        wake.notify_one();
+    }
+}
+
+void Logger::flush() {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    drain();
+}
+
+void Logger::drainLoop() {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (!stopping) {
+        wake.wait_for(lock, kDrainInterval);
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> drainLock(drainMutex);
+            drain();
+        }
+        lock.lock();
+    }
+}
+
+void Logger::drain() {
+    std::vector<Ring*> pending;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        pending.reserve(rings.size());
+        for (const auto& ring : rings) {
+            pending.push_back(ring.get());
+        }
+    }
+
+    std::string out;
+    std::vector<Ring*> finished; // Retired and empty
+    for (Ring* ring : pending) {
+        // Read before the records, so a ring seen retired here is drained in full below
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        uint64_t tail = ring->tail.load(std::memory_order_acquire);
+        for (; head < tail; ++head) {
+            const Record& record = ring->records[head % Ring::kCapacity];
+            appendTimestamp(out, record.timeNanos);
+            out += ' ';
+            out += levelName(record.level);
+            out += " [t";
+            out += std::to_string(ring->threadNumber);
+            out += "] ";
+            out.append(record.text, record.length);
+            if (record.truncated) {
+                out += "...";
+            }
+            out += '\n';
+        }
+        ring->head.store(head, std::memory_order_release);
+        uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            out += "(" + std::to_string(dropped) + " log messages dropped by thread t" +
+                   std::to_string(ring->threadNumber) + ")\n";
+        }
+        if (retired) {
+            finished.push_back(ring);
+        }
+    }
+
+    if (!out.empty()) {
+        std::fwrite(out.data(), 1, out.size(), stderr);
+        std::fflush(stderr);
+    }
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.erase(std::remove_if(rings.begin(), rings.end(), [&](const std::unique_ptr<Ring>& ring) {
+            return std::find(finished.begin(), finished.end(), ring.get()) != finished.end();
+        }), rings.end());
+    }
+}
+
+bool Logger::parseLevel(std::string_view name, LogLevel& out) {
+    if (name == "debug") out = LogLevel::DEBUG;
+    else if (name == "info") out = LogLevel::INFO;
+    else if (name == "warn") out = LogLevel::WARN;
+    else if (name == "error") out = LogLevel::ERROR;
+    else if (name == "off") out = LogLevel::OFF;
+    else return false;
+    return true;
+}
+
+void LogLine::append(std::string_view part) {
+    size_t room = Logger::kMaxMessageLength - length;
+    if (part.size() > room) {
+        truncated = true;
+        part = part.substr(0, room);
+    }
+    std::memcpy(text + length, part.data(), part.size());
+    length += part.size();
+}
+
+LogLine::~LogLine() {
+    Logger::global().log(level, std::string_view(text, length), truncated);
+}
+
+bool LogRateLimiter::allow(uint64_t& suppressedBefore) {
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t start = windowStart.load(std::memory_order_relaxed);
+    if (now != start && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        inWindow.store(0, std::memory_order_relaxed);
+    }
+    if (inWindow.fetch_add(1, std::memory_order_relaxed) >= perSecond) {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressedBefore = suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
@@ -1,4 +1,5 @@
 #include "../headers/LogisticRegressionModel.h"
+#include "../headers/Snapshot.h"
 #include <cmath>
 #include <stdexcept>
 #include <iostream>
@@ -13,7 +14,7 @@ double LogisticRegressionModel::sigmoid(double z) const {
     return 1.0 / (1.0 + std::exp(-z));
 }
 
-double LogisticRegressionModel::rawPredictProbability(const std::vector<double>& features) const {
+double LogisticRegressionModel::rawPredictProbability(std::span<const double> features) const {
     if (features.size() != weights.size()) {
         throw std::runtime_error("Feature size mismatch");
     }
@@ -26,7 +27,7 @@ double LogisticRegressionModel::rawPredictProbability(const std::vector<double>&
     return sigmoid(z);
 }
 
-double LogisticRegressionModel::predictProbability(const std::vector<double>& features) const {
+double LogisticRegressionModel::predictProbability(std::span<const double> features) const {
     if (!isTrained) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
@@ -34,13 +35,12 @@ double LogisticRegressionModel::predictProbability(const std::vector<double>& fe
     return rawPredictProbability(features);
 }
 
-double LogisticRegressionModel::computeLoss(const std::vector<std::vector<double>>& X, 
-                                           const std::vector<int>& y) const {
+double LogisticRegressionModel::computeLoss(const FeatureMatrix& X, std::span<const int> y) const {
     double loss = 0.0;
-    size_t n = X.size();
+    size_t n = X.rows();
     
     for (size_t i = 0; i < n; ++i) {
-        double prob = rawPredictProbability(X[i]);
+        double prob = rawPredictProbability(X.row(i));
         // Log loss with numerical stability
         double y_val = static_cast<double>(y[i]);
         loss -= y_val * std::log(prob + 1e-15) + (1.0 - y_val) * std::log(1.0 - prob + 1e-15);
@@ -49,10 +49,9 @@ double LogisticRegressionModel::computeLoss(const std::vector<std::vector<double
     return loss / n;
 }
 
-void LogisticRegressionModel::gradientDescent(const std::vector<std::vector<double>>& X, 
-                                              const std::vector<int>& y) {
-    size_t n = X.size();
-    size_t nFeatures = X[0].size();
+void LogisticRegressionModel::gradientDescent(const FeatureMatrix& X, std::span<const int> y) {
+    size_t n = X.rows();
+    size_t nFeatures = X.cols();
     
     // Initialize weights if not already initialized
     if (weights.empty()) {
@@ -66,12 +65,13 @@ void LogisticRegressionModel::gradientDescent(const std::vector<std::vector<doub
         double biasGradient = 0.0;
         
         for (size_t i = 0; i < n; ++i) {
-            double prediction = rawPredictProbability(X[i]);
+            std::span<const double> sample = X.row(i);
+            double prediction = rawPredictProbability(sample);
             double error = prediction - static_cast<double>(y[i]);
             
             // Update gradients
             for (size_t j = 0; j < nFeatures; ++j) {
-                weightGradients[j] += error * X[i][j];
+                weightGradients[j] += error * sample[j];
             }
             biasGradient += error;
         }
@@ -91,22 +91,17 @@ void LogisticRegressionModel::gradientDescent(const std::vector<std::vector<doub
     }
 }
 
-void LogisticRegressionModel::fit(const std::vector<std::vector<double>>& X, 
-                                  const std::vector<int>& y) {
+void LogisticRegressionModel::fit(const FeatureMatrix& X, std::span<const int> y) {
     if (X.empty() || y.empty()) {
         throw std::runtime_error("Training data is empty");
     }
     
-    if (X.size() != y.size()) {
+    if (X.rows() != y.size()) {
         throw std::runtime_error("X and y must have the same size");
     }
     
-    size_t nFeatures = X[0].size();
-    for (const auto& sample : X) {
-        if (sample.size() != nFeatures) {
-            throw std::runtime_error("All samples must have the same number of features");
-        }
-    }
+    // Rows of a FeatureMatrix all have the same number of features
+    size_t nFeatures = X.cols();
     
     // Initialize weights
     weights.resize(nFeatures, 0.0);
@@ -118,36 +113,35 @@ void LogisticRegressionModel::fit(const std::vector<std::vector<double>>& X,
     isTrained = true;
 }
 
-std::vector<int> LogisticRegressionModel::predict(const std::vector<std::vector<double>>& X) const {
+std::vector<int> LogisticRegressionModel::predict(const FeatureMatrix& X) const {
     std::vector<int> predictions;
-    predictions.reserve(X.size());
+    predictions.reserve(X.rows());
     
-    for (const auto& sample : X) {
-        double prob = predictProbability(sample);
+    for (size_t i = 0; i < X.rows(); ++i) {
+        double prob = predictProbability(X.row(i));
         predictions.push_back(prob >= 0.5 ? 1 : 0);
     }
     
     return predictions;
 }
 
-int LogisticRegressionModel::predictSingle(const std::vector<double>& features) const {
+int LogisticRegressionModel::predictSingle(std::span<const double> features) const {
     double prob = predictProbability(features);
     return prob >= 0.5 ? 1 : 0;
 }
 
-std::vector<double> LogisticRegressionModel::predictProbabilityBatch(
-    const std::vector<std::vector<double>>& X) const {
+std::vector<double> LogisticRegressionModel::predictProbabilityBatch(const FeatureMatrix& X) const {
     std::vector<double> probabilities;
-    probabilities.reserve(X.size());
+    probabilities.reserve(X.rows());
     
-    for (const auto& sample : X) {
-        probabilities.push_back(predictProbability(sample));
+    for (size_t i = 0; i < X.rows(); ++i) {
+        probabilities.push_back(predictProbability(X.row(i)));
     }
     
     return probabilities;
 }
 
-double LogisticRegressionModel::predictProbabilitySingle(const std::vector<double>& features) const {
+double LogisticRegressionModel::predictProbabilitySingle(std::span<const double> features) const {
     return predictProbability(features);
 }
 
@@ -171,3 +165,18 @@ bool LogisticRegressionModel::getIsTrained() const {
     return isTrained;
 }
 
+void LogisticRegressionModel::saveState(SnapshotWriter& writer) const {
+    writer.write<double>(learningRate);
+    writer.write<int32_t>(maxIterations);
+    writer.write<double>(bias);
+    writer.write<uint8_t>(isTrained ? 1 : 0);
+    writer.writeArray(weights);
+}
+
+void LogisticRegressionModel::loadState(SnapshotReader& reader) {
+    learningRate = reader.read<double>();
+    maxIterations = reader.read<int32_t>();
+    bias = reader.read<double>();
+    isTrained = reader.read<uint8_t>() != 0;
+    weights = reader.readArray<double>();
+}
@@ -0,0 +1,142 @@
+#include "../headers/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : data(nullptr), length(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+
+    // Empty files cannot be mapped; expose them as an empty view
+    if (length == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+    }
+    data = nullptr;
+    length = 0;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+}
+
+bool MappedFile::isOpen() const {
+    return fileHandle != INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile() : data(nullptr), length(0), fd(-1) {}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    // Empty files cannot be mapped; expose them as an empty view
+    if (length == 0) {
+        return true;
+    }
+
+    void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data = static_cast<const char*>(addr);
+
+    // The loaders scan front to back exactly once
+    madvise(addr, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), length);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    data = nullptr;
+    length = 0;
+    fd = -1;
+}
+
+bool MappedFile::isOpen() const {
+    return fd >= 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+std::string_view MappedFile::view() const {
+    if (data == nullptr) {
+        return std::string_view();
+    }
+    return std::string_view(data, length);
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
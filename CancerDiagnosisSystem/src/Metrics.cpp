@@ -0,0 +1,277 @@
+#include "../headers/Metrics.h"
+#include <bit>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+std::atomic<size_t> nextStripe(0);
+
+// Nominal upper bounds of the reported histogram buckets, in microseconds.
+// Each is reported as the end of the recorded bucket it falls in, so that
+// every `le` bucket counts exactly the durations below its bound.
+constexpr uint64_t kReportedLimitsMicros[] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 30000000, 60000000
+};
+
+const char* typeName(Metrics::Type type) {
+    switch (type) {
+        case Metrics::Type::COUNTER: return "counter";
+        case Metrics::Type::GAUGE: return "gauge";
+        default: return "histogram";
+    }
+}
+
+void appendNumber(std::string& out, double value) {
+    if (std::isnan(value)) {
+        out += "NaN";
+        return;
+    }
+    if (std::isinf(value)) {
+        out += value > 0 ? "+Inf" : "-Inf";
+        return;
+    }
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void appendNumber(std::string& out, uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// name{labels,extra} or name{extra} or name
+void appendSeries(std::string& out, std::string_view name, std::string_view suffix, std::string_view labels,
+                  std::string_view extra = {}) {
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) {
+            out += ',';
+        }
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+}
+
+void appendHelp(std::string& out, std::string_view help) {
+    for (char c : help) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+}
+
+} // namespace
+
+size_t metricStripe() {
+    thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % kMetricStripes;
+    return stripe;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const Cell& cell : cells) {
+        total += cell.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+LatencyHistogram::LatencyHistogram() : cells(new Cell[kMetricStripes]) {}
+
+size_t LatencyHistogram::bucketFor(uint64_t micros) {
+    if (micros < kSubBuckets) {
+        return static_cast<size_t>(micros);
+    }
+    size_t exponent = 63 - std::countl_zero(micros);
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    size_t shift = exponent - 3; // Keep the 3 bits below the leading one
+    return (exponent - 2) * kSubBuckets + ((micros >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::bucketLimitMicros(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket + 1;
+    }
+    size_t shift = bucket / kSubBuckets - 1;
+    return (kSubBuckets + bucket % kSubBuckets + 1) << shift;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds elapsed) {
+    uint64_t nanos = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+    Cell& cell = cells[metricStripe()];
+    cell.buckets[bucketFor(nanos / 1000)].fetch_add(1, std::memory_order_relaxed);
+    cell.sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot{std::vector<uint64_t>(kBucketCount, 0), 0, 0};
+    for (size_t stripe = 0; stripe < kMetricStripes; ++stripe) {
+        const Cell& cell = cells[stripe];
+        for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+            snapshot.buckets[bucket] += cell.buckets[bucket].load(std::memory_order_relaxed);
+        }
+        snapshot.sumNanos += cell.sumNanos.load(std::memory_order_relaxed);
+    }
+    // Counted from the buckets, so the two always agree
+    for (uint64_t count : snapshot.buckets) {
+        snapshot.count += count;
+    }
+    return snapshot;
+}
+
+ScopedTimer::~ScopedTimer() {
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    if (histogram) {
+        histogram->record(elapsed);
+    } else {
+        gauge->set(std::chrono::duration<double>(elapsed).count());
+    }
+}
+
+Metrics& Metrics::global() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Series& Metrics::findOrAdd(std::string_view name, std::string_view labels, std::string_view help,
+                                    Type type) {
+    auto it = families.find(name);
+    if (it == families.end()) {
+        it = families.emplace(std::string(name), Family{std::string(help), type, {}}).first;
+    }
+    for (const auto& series : it->second.series) {
+        if (series->labels == labels) {
+            return *series;
+        }
+    }
+    it->second.series.push_back(std::make_unique<Series>());
+    Series& series = *it->second.series.back();
+    series.labels = labels;
+    return series;
+}
+
+Counter& Metrics::counter(std::string_view name, std::string_view labels, std::string_view help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& series = findOrAdd(name, labels, help, Type::COUNTER);
+    if (!series.counter) {
+        series.counter = std::make_unique<Counter>();
+    }
+    return *series.counter;
+}
+
+Gauge& Metrics::gauge(std::string_view name, std::string_view labels, std::string_view help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& series = findOrAdd(name, labels, help, Type::GAUGE);
+    if (!series.gauge) {
+        series.gauge = std::make_unique<Gauge>();
+    }
+    return *series.gauge;
+}
+
+LatencyHistogram& Metrics::histogram(std::string_view name, std::string_view labels, std::string_view help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& series = findOrAdd(name, labels, help, Type::HISTOGRAM);
+    if (!series.histogram) {
+        series.histogram = std::make_unique<LatencyHistogram>();
+    }
+    return *series.histogram;
+}
+
+void Metrics::counter(std::string_view name, std::string_view labels, std::string_view help,
+                      std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex);
+    findOrAdd(name, labels, help, Type::COUNTER).read = std::move(read);
+}
+
+void Metrics::gauge(std::string_view name, std::string_view labels, std::string_view help,
+                    std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex);
+    findOrAdd(name, labels, help, Type::GAUGE).read = std::move(read);
+}
+
+void Metrics::render(std::string& out) const {
+    // Collect the series under the lock but read them after releasing it,
+    // so callbacks may take other locks (and register metrics) freely
+    struct Row {
+        const std::string* name;
+        const Family* family; // Help and type never change
+        const std::string* labels;
+        const Counter* counter;
+        const Gauge* gauge;
+        const LatencyHistogram* histogram;
+        std::function<double()> read;
+    };
+    std::vector<Row> rows;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [name, family] : families) {
+            for (const auto& series : family.series) {
+                rows.push_back({&name, &family, &series->labels, series->counter.get(), series->gauge.get(),
+                                series->histogram.get(), series->read});
+            }
+        }
+    }
+
+    const std::string* previous = nullptr;
+    for (const Row& row : rows) {
+        const std::string& name = *row.name;
+        if (row.name != previous) {
+            previous = row.name;
+            out += "# HELP ";
+            out += name;
+            out += ' ';
+            appendHelp(out, row.family->help);
+            out += "\n# TYPE ";
+            out += name;
+            out += ' ';
+            out += typeName(row.family->type);
+            out += '\n';
+        }
+
+        if (row.histogram) {
+            LatencyHistogram::Snapshot snapshot = row.histogram->snapshot();
+            uint64_t cumulative = 0;
+            size_t bucket = 0;
+            uint64_t reached = 0; // End of the buckets added up so far
+            for (uint64_t limit : kReportedLimitsMicros) {
+                // Buckets that start at or below the limit
+                while (bucket < LatencyHistogram::kBucketCount && reached <= limit) {
+                    cumulative += snapshot.buckets[bucket];
+                    reached = LatencyHistogram::bucketLimitMicros(bucket++);
+                }
+                std::string le = "le=\"";
+                appendNumber(le, reached / 1e6);
+                le += '"';
+                appendSeries(out, name, "_bucket", *row.labels, le);
+                appendNumber(out, cumulative);
+                out += '\n';
+            }
+            appendSeries(out, name, "_bucket", *row.labels, "le=\"+Inf\"");
+            appendNumber(out, snapshot.count);
+            out += '\n';
+            appendSeries(out, name, "_sum", *row.labels);
+            appendNumber(out, snapshot.sumNanos / 1e9);
+            out += '\n';
+            appendSeries(out, name, "_count", *row.labels);
+            appendNumber(out, snapshot.count);
+            out += '\n';
+            continue;
+        }
+
+        appendSeries(out, name, "", *row.labels);
+        if (row.read) appendNumber(out, row.read());
+        else if (row.counter) appendNumber(out, row.counter->value());
+        else if (row.gauge) appendNumber(out, row.gauge->value());
+        else appendNumber(out, uint64_t(0));
+        out += '\n';
+    }
+}
@@ -1,4 +1,5 @@
 #include "../headers/NaiveBayesClassifier.h"
+#include "../headers/Snapshot.h"
 #include <cmath>
 #include <algorithm>
 #include <stdexcept>
@@ -6,9 +7,7 @@
 
 NaiveBayesClassifier::NaiveBayesClassifier() : isTrained(false) {}
 
-void NaiveBayesClassifier::calculateClassStatistics(
-    const std::vector<std::vector<double>>& X, 
-    const std::vector<int>& y) {
+void NaiveBayesClassifier::calculateClassStatistics(const FeatureMatrix& X, std::span<const int> y) {
     
     // Find unique classes
     std::map<int, bool> classMap;
@@ -22,7 +21,7 @@ void NaiveBayesClassifier::calculateClassStatistics(
     }
     
     if (X.empty()) return;
-    size_t nFeatures = X[0].size();
+    size_t nFeatures = X.cols();
     
     // Initialize statistics for each class
     for (int cls : uniqueClasses) {
@@ -46,8 +45,9 @@ void NaiveBayesClassifier::calculateClassStatistics(
         int label = y[i];
         classCounts[label]++;
         
+        std::span<const double> sample = X.row(i);
         for (size_t j = 0; j < nFeatures; ++j) {
-            classMean[label][j] += X[i][j];
+            classMean[label][j] += sample[j];
         }
     }
     
@@ -68,8 +68,9 @@ void NaiveBayesClassifier::calculateClassStatistics(
         std::vector<double> variance(nFeatures, 0.0);
         for (size_t i = 0; i < n; ++i) {
             if (y[i] == cls) {
+                std::span<const double> sample = X.row(i);
                 for (size_t j = 0; j < nFeatures; ++j) {
-                    double diff = X[i][j] - classMean[cls][j];
+                    double diff = sample[j] - classMean[cls][j];
                     variance[j] += diff * diff;
                 }
             }
@@ -93,7 +94,7 @@ double NaiveBayesClassifier::calculateProbability(double x, double mean, double
 }
 
 double NaiveBayesClassifier::calculateClassProbability(
-    const std::vector<double>& features, int classLabel) const {
+    std::span<const double> features, int classLabel) const {
     
     // Start with class prior
     double probability = std::log(classPrior.at(classLabel) + 1e-10);
@@ -110,13 +111,12 @@ double NaiveBayesClassifier::calculateClassProbability(
     return probability;
 }
 
-void NaiveBayesClassifier::fit(const std::vector<std::vector<double>>& X, 
-                               const std::vector<int>& y) {
+void NaiveBayesClassifier::fit(const FeatureMatrix& X, std::span<const int> y) {
     if (X.empty() || y.empty()) {
         throw std::runtime_error("Training data is empty");
     }
     
-    if (X.size() != y.size()) {
+    if (X.rows() != y.size()) {
         throw std::runtime_error("X and y must have the same size");
     }
     
@@ -124,23 +124,22 @@ void NaiveBayesClassifier::fit(const std::vector<std::vector<double>>& X,
     isTrained = true;
 }
 
-std::vector<int> NaiveBayesClassifier::predict(
-    const std::vector<std::vector<double>>& X) const {
+std::vector<int> NaiveBayesClassifier::predict(const FeatureMatrix& X) const {
     if (!isTrained) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
     
     std::vector<int> predictions;
-    predictions.reserve(X.size());
+    predictions.reserve(X.rows());
     
-    for (const auto& sample : X) {
-        predictions.push_back(predictSingle(sample));
+    for (size_t i = 0; i < X.rows(); ++i) {
+        predictions.push_back(predictSingle(X.row(i)));
     }
     
     return predictions;
 }
 
-int NaiveBayesClassifier::predictSingle(const std::vector<double>& features) const {
+int NaiveBayesClassifier::predictSingle(std::span<const double> features) const {
     if (!isTrained) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
@@ -161,24 +160,23 @@ int NaiveBayesClassifier::predictSingle(const std::vector<double>& features) con
     return bestClass;
 }
 
-std::vector<double> NaiveBayesClassifier::predictProbability(
-    const std::vector<std::vector<double>>& X) const {
+std::vector<double> NaiveBayesClassifier::predictProbability(const FeatureMatrix& X) const {
     if (!isTrained) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
     
     std::vector<double> probabilities;
-    probabilities.reserve(X.size());
+    probabilities.reserve(X.rows());
     
-    for (const auto& sample : X) {
-        probabilities.push_back(predictProbabilitySingle(sample));
+    for (size_t i = 0; i < X.rows(); ++i) {
+        probabilities.push_back(predictProbabilitySingle(X.row(i)));
     }
     
     return probabilities;
 }
 
 double NaiveBayesClassifier::predictProbabilitySingle(
-    const std::vector<double>& features) const {
+    std::span<const double> features) const {
     if (!isTrained) {
         throw std::runtime_error("Model not trained. Call fit() first.");
     }
@@ -220,3 +218,25 @@ std::map<int, double> NaiveBayesClassifier::getClassPrior() const {
     return classPrior;
 }
 
+void NaiveBayesClassifier::saveState(SnapshotWriter& writer) const {
+    writer.write<uint8_t>(isTrained ? 1 : 0);
+    writer.writeArray(uniqueClasses);
+    for (int classLabel : uniqueClasses) {
+        writer.write<double>(classPrior.at(classLabel));
+        writer.writeArray(classMean.at(classLabel));
+        writer.writeArray(classStd.at(classLabel));
+    }
+}
+
+void NaiveBayesClassifier::loadState(SnapshotReader& reader) {
+    isTrained = reader.read<uint8_t>() != 0;
+    uniqueClasses = reader.readArray<int>();
+    classPrior.clear();
+    classMean.clear();
+    classStd.clear();
+    for (int classLabel : uniqueClasses) {
+        classPrior[classLabel] = reader.read<double>();
+        classMean[classLabel] = reader.readArray<double>();
+        classStd[classLabel] = reader.readArray<double>();
+    }
+}
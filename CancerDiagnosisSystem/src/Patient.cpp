@@ -1,17 +1,67 @@
 #include "../headers/Patient.h"
 #include <iostream>
 #include <iomanip>
+#include <utility>
 
-Patient::Patient() : patientId(""), name(""), age(0), riskScore(0.0), prediction(0) {}
+Patient::Patient() : Patient(allocator_type()) {}
 
-Patient::Patient(const std::string& id, const std::string& name, int age) 
-    : patientId(id), name(name), age(age), riskScore(0.0), prediction(0) {}
+Patient::Patient(const allocator_type& alloc) 
+    : patientId(), name(alloc), age(0), geneTable(nullptr), geneRows(alloc), geneticData(alloc), 
+      riskScore(0.0), prediction(0) {}
 
-std::string Patient::getPatientId() const {
+Patient::Patient(std::string_view id, std::string_view name, int age, const allocator_type& alloc) 
+    : patientId(id), name(name, alloc), age(age), geneTable(nullptr), geneRows(alloc), 
+      geneticData(alloc), riskScore(0.0), prediction(0) {}
+
+Patient::Patient(const Patient& other) 
+    : patientId(other.patientId), name(other.name), age(other.age), geneTable(nullptr), 
+      riskScore(other.riskScore), prediction(other.prediction) {
+    GeneticDataView genes = other.getGeneticData();
+    geneticData.reserve(genes.size());
+    geneticData.assign(genes.begin(), genes.end());
+}
+
+Patient::Patient(const Patient& other, const allocator_type& alloc) 
+    : patientId(other.patientId), name(other.name, alloc), age(other.age), 
+      geneTable(other.geneTable), geneRows(other.geneRows, alloc), 
+      geneticData(other.geneticData, alloc), 
+      riskScore(other.riskScore), prediction(other.prediction) {}
+
+Patient::Patient(Patient&& other, const allocator_type& alloc) 
+    : patientId(other.patientId), name(std::move(other.name), alloc), age(other.age), 
+      geneTable(other.geneTable), geneRows(std::move(other.geneRows), alloc), 
+      geneticData(std::move(other.geneticData), alloc), 
+      riskScore(other.riskScore), prediction(other.prediction) {}
+
+Patient& Patient::operator=(const Patient& other) {
+    if (this != &other) {
+        patientId = other.patientId;
+        name = other.name;
+        age = other.age;
+        GeneticDataView genes = other.getGeneticData();
+        geneTable = nullptr;
+        geneRows.clear();
+        geneticData.reserve(genes.size());
+        geneticData.assign(genes.begin(), genes.end());
+        riskScore = other.riskScore;
+        prediction = other.prediction;
+    }
+    return *this;
+}
+
+Patient::allocator_type Patient::get_allocator() const {
+    return name.get_allocator();
+}
+
+const std::string& Patient::getPatientId() const {
+    return patientId.str();
+}
+
+Symbol Patient::getPatientSymbol() const {
     return patientId;
 }
 
-std::string Patient::getName() const {
+std::string_view Patient::getName() const {
     return name;
 }
 
@@ -19,8 +69,19 @@ int Patient::getAge() const {
     return age;
 }
 
-std::vector<GeneticData> Patient::getGeneticData() const {
-    return geneticData;
+GeneticDataView Patient::getGeneticData() const {
+    if (geneTable) {
+        return GeneticDataView(*geneTable, geneRows);
+    }
+    return GeneticDataView(geneticData);
+}
+
+const GeneticDataTable* Patient::getGeneTable() const {
+    return geneTable;
+}
+
+std::span<const uint32_t> Patient::getGeneRows() const {
+    return geneRows;
 }
 
 double Patient::getRiskScore() const {
@@ -31,11 +92,11 @@ int Patient::getPrediction() const {
     return prediction;
 }
 
-void Patient::setPatientId(const std::string& id) {
-    patientId = id;
+void Patient::setPatientId(std::string_view id) {
+    patientId = Symbol(id);
 }
 
-void Patient::setName(const std::string& name) {
+void Patient::setName(std::string_view name) {
     this->name = name;
 }
 
@@ -52,28 +113,40 @@ void Patient::setPrediction(int pred) {
 }
 
 void Patient::addGeneticData(const GeneticData& data) {
+    if (geneTable) {
+        // Switch to owned records
+        for (uint32_t row : geneRows) {
+            geneticData.push_back(geneTable->getRow(row));
+        }
+        geneTable = nullptr;
+        geneRows.clear();
+    }
     geneticData.push_back(data);
 }
 
-std::vector<double> Patient::getMutationScores() const {
-    std::vector<double> scores;
-    for (const auto& data : geneticData) {
-        scores.push_back(data.getMutationScore());
+void Patient::addGeneticDataRow(const GeneticDataTable& table, size_t row) {
+    bool canRefer = geneticData.empty() && (geneTable == nullptr || geneTable == &table) && 
+                    row <= UINT32_MAX;
+    if (!canRefer) {
+        addGeneticData(table.getRow(row));
+        return;
     }
-    return scores;
+    geneTable = &table;
+    geneRows.push_back(static_cast<uint32_t>(row));
 }
 
 void Patient::display() const {
     std::cout << "\n=== Patient Information ===" << std::endl;
-    std::cout << "Patient ID: " << patientId << std::endl;
+    std::cout << "Patient ID: " << patientId.str() << std::endl;
     std::cout << "Name: " << name << std::endl;
     std::cout << "Age: " << age << std::endl;
     std::cout << "Risk Score: " << std::fixed << std::setprecision(4) << riskScore << std::endl;
     std::cout << "Prediction: " << (prediction == 1 ? "Cancerous" : "Non-Cancerous") << std::endl;
-    std::cout << "Genetic Data Count: " << geneticData.size() << std::endl;
-    if (!geneticData.empty()) {
+    GeneticDataView genes = getGeneticData();
+    std::cout << "Genetic Data Count: " << genes.size() << std::endl;
+    if (!genes.empty()) {
         std::cout << "\nGenetic Data:" << std::endl;
-        for (const auto& data : geneticData) {
+        for (const auto& data : genes) {
             std::cout << "  ";
             data.display();
         }
@@ -0,0 +1,105 @@
+#include "../headers/PatientStore.h"
+#include <atomic>
+#include <utility>
+
+namespace {
+
+// Revisions are unique in the process, so a record in one store never
+// takes the revision of a record it replaces in another
+std::atomic<uint64_t> nextRevision(1);
+
+} // namespace
+
+PatientStore::Epoch::Epoch() {
+    arenas.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+    indexById = std::pmr::unordered_map<Symbol, size_t>(arenas[0].get());
+}
+
+PatientStore::PatientStore() : epoch(std::make_unique<Epoch>()) {}
+
+void PatientStore::swap(PatientStore& other) noexcept {
+    std::swap(epoch, other.epoch);
+    std::swap(patients, other.patients);
+    std::swap(revisions, other.revisions);
+}
+
+PatientStore::allocator_type PatientStore::get_allocator() const {
+    return allocator_type(epoch->arenas[0].get());
+}
+
+PatientStore::allocator_type PatientStore::createArena() {
+    epoch->arenas.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+    return allocator_type(epoch->arenas.back().get());
+}
+
+Symbol PatientStore::keyFor(const Patient& patient) {
+    const std::string& patientId = patient.getPatientId();
+    std::string_view normalized = normalizeId(patientId);
+    return normalized.size() == patientId.size() ? patient.getPatientSymbol() : Symbol(normalized);
+}
+
+bool PatientStore::ownsMemoryOf(const Patient& patient) const {
+    std::pmr::memory_resource* resource = patient.get_allocator().resource();
+    for (const auto& arena : epoch->arenas) {
+        if (arena.get() == resource) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PatientStore::upsert(const Patient& patient) {
+    return upsert(Patient(patient, get_allocator()));
+}
+
+bool PatientStore::upsert(Patient&& patient) {
+    // Records from outside the epoch are copied in, so none outlives its arena
+    if (!ownsMemoryOf(patient)) {
+        return upsert(static_cast<const Patient&>(patient));
+    }
+    auto inserted = epoch->indexById.try_emplace(keyFor(patient), patients.size());
+    uint64_t revision = nextRevision.fetch_add(1, std::memory_order_relaxed);
+    if (!inserted.second) {
+        patients[inserted.first->second] = std::move(patient);
+        revisions[inserted.first->second] = revision;
+        return false;
+    }
+    patients.push_back(std::move(patient));
+    revisions.push_back(revision);
+    return true;
+}
+
+const Patient* PatientStore::find(std::string_view patientId) const {
+    // An ID that was never interned cannot belong to a stored patient
+    Symbol key;
+    if (!StringInterner::global().find(normalizeId(patientId), key)) {
+        return nullptr;
+    }
+    auto it = epoch->indexById.find(key);
+    return it == epoch->indexById.end() ? nullptr : &patients[it->second];
+}
+
+bool PatientStore::contains(std::string_view patientId) const {
+    return find(patientId) != nullptr;
+}
+
+void PatientStore::reserve(size_t count) {
+    patients.reserve(count);
+    revisions.reserve(count);
+    epoch->indexById.reserve(count);
+}
+
+void PatientStore::clear() {
+    patients.clear();
+    revisions.clear();
+    epoch = std::make_unique<Epoch>();
+}
+
+std::string_view PatientStore::normalizeId(std::string_view patientId) {
+    size_t first = patientId.find_first_not_of(" \t\n\r");
+    if (first == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t last = patientId.find_last_not_of(" \t\n\r");
+    return patientId.substr(first, last - first + 1);
+}
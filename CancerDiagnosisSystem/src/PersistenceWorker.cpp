@@ -0,0 +1,61 @@
+#include "../headers/PersistenceWorker.h"
+
+PersistenceWorker::PersistenceWorker(std::function<void()> flush, std::chrono::milliseconds interval)
+    : flushFunction(std::move(flush)), interval(interval), dirty(false), stopping(false) {
+    worker = std::thread(&PersistenceWorker::run, this);
+}
+
+PersistenceWorker::~PersistenceWorker() {
+    stop();
+}
+
+void PersistenceWorker::markDirty() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (dirty) {
+            return; // Already scheduled; this change rides along
+        }
+        dirty = true;
+    }
+    condition.notify_one();
+}
+
+void PersistenceWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+    }
+    condition.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void PersistenceWorker::run() {
+    auto lastFlush = std::chrono::steady_clock::now() - interval;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        condition.wait(lock, [&] { return dirty || stopping; });
+
+        // Let a burst of changes accumulate until the interval has elapsed
+        condition.wait_until(lock, lastFlush + interval, [&] { return stopping; });
+
+        if (!dirty) {
+            break; // Stopping with nothing pending
+        }
+        dirty = false;
+        lock.unlock();
+
+        flushFunction();
+        lastFlush = std::chrono::steady_clock::now();
+
+        lock.lock();
+        if (stopping && !dirty) {
+            break;
+        }
+    }
+}
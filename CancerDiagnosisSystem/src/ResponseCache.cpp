@@ -0,0 +1,69 @@
+#include "../headers/ResponseCache.h"
+#include "../headers/CsvScanner.h"
+
+ResponseCache::ResponseCache(size_t maxEntries, size_t maxBodyBytes)
+    : maxEntries(maxEntries), maxBodyBytes(maxBodyBytes), hits(0), misses(0) {}
+
+std::shared_ptr<const ResponseCache::Response> ResponseCache::find(const std::string& key, uint64_t version) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.version != version) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return it->second.response;
+}
+
+std::shared_ptr<const ResponseCache::Response> ResponseCache::store(const std::string& key, uint64_t version,
+                                                                    Response response) {
+    auto shared = std::make_shared<const Response>(std::move(response));
+    if (shared->body.size() > maxBodyBytes) {
+        return shared;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.size() >= maxEntries && entries.find(key) == entries.end()) {
+        // Entries built from older data can never be hit again
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it->second.version < version ? entries.erase(it) : std::next(it);
+        }
+        if (entries.size() >= maxEntries) {
+            entries.erase(entries.begin());
+        }
+    }
+    Entry& entry = entries[key];
+    // A slower request may finish after one that saw newer data
+    if (!entry.response || entry.version <= version) {
+        entry.version = version;
+        entry.response = shared;
+    }
+    return shared;
+}
+
+std::string ResponseCache::makeETag(std::string_view instance, uint64_t version, std::string_view variant) {
+    std::string etag = "\"";
+    etag += instance;
+    etag += "-" + std::to_string(version);
+    if (!variant.empty()) {
+        etag += "-";
+        etag += variant;
+    }
+    etag += "\"";
+    return etag;
+}
+
+bool ResponseCache::etagMatches(std::string_view header, std::string_view etag) {
+    std::string_view rest = header;
+    while (!rest.empty()) {
+        size_t comma = rest.find(',');
+        std::string_view candidate = CsvScanner::trim(rest.substr(0, comma));
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        if (candidate.substr(0, 2) == "W/") {
+            candidate.remove_prefix(2);
+        }
+        if (candidate == "*" || candidate == etag) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,9 +1,20 @@
 #include "../headers/CancerDiagnosisSystem.h"
-#include <iostream>
+#include "../headers/ApiRequests.h"
+#include "../headers/JsonWriter.h"
+#include "../headers/GeneticColumnEncoder.h"
+#include "../headers/CsvScanner.h"
+#include "../headers/ResponseCache.h"
+#include "../headers/Metrics.h"
+#include "../headers/Logger.h"
 #include <sstream>
 #include <string>
 #include <vector>
 #include <fstream>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <charconv>
+#include <climits>
 
 // NOTE: This server uses the single-header cpp-httplib library.
 // Download it from: https://github.com/yhirose/cpp-httplib (place httplib.h in a folder named third_party)
@@ -14,65 +25,286 @@ using namespace std;
 // Forward declare serverMain (defined below after all handlers)
 int serverMain();
 
-// Helper: escape JSON string
-static string json_escape(const string &s) {
-    string out;
-    for (char c : s) {
-        switch (c) {
-            case '"': out += "\\\""; break;
-            case '\\': out += "\\\\"; break;
-            case '\b': out += "\\b"; break;
-            case '\f': out += "\\f"; break;
-            case '\n': out += "\\n"; break;
-            case '\r': out += "\\r"; break;
-            case '\t': out += "\\t"; break;
-            default:
-                out.push_back(c);
+// Default data files and the binary snapshot built from them
+static const string kGenesFile = "data/genes.csv";
+static const string kPatientsFile = "data/patients.csv";
+static const string kSnapshotFile = "data/system.cds";
+static const string kLogFile = "data/changes.wal";
+
+// Changes are flushed to the CSV files in the background at most this often
+static const std::chrono::milliseconds kFlushInterval(2000);
+
+// CDS_WAL_FSYNC=always|periodic|never selects the log durability policy (default: always)
+static WriteAheadLog::FsyncPolicy logFsyncPolicy() {
+    const char* value = std::getenv("CDS_WAL_FSYNC");
+    string policy = value ? value : "always";
+    if (policy == "never") return WriteAheadLog::FsyncPolicy::NEVER;
+    if (policy == "periodic") return WriteAheadLog::FsyncPolicy::PERIODIC;
+    return WriteAheadLog::FsyncPolicy::ALWAYS;
+}
+
+// CDS_DIAGNOSIS_WORKERS=N sets the number of threads that diagnose queued
+// patients as they arrive (default: one per core; 0 runs them only on /queue/process)
+static size_t diagnosisWorkerCount() {
+    const char* value = std::getenv("CDS_DIAGNOSIS_WORKERS");
+    if (value && *value) {
+        char* end = nullptr;
+        unsigned long count = std::strtoul(value, &end, 10);
+        if (end && *end == '\0') return count;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// CDS_HTTP_THREADS=N sets the number of request handler threads (default: one
+// per core, at least 8). Reads share the state lock, so they scale with this.
+static size_t httpThreadCount() {
+    const char* value = std::getenv("CDS_HTTP_THREADS");
+    if (value && *value) {
+        char* end = nullptr;
+        unsigned long count = std::strtoul(value, &end, 10);
+        if (end && *end == '\0' && count > 0) return count;
+    }
+    return std::max(8u, std::thread::hardware_concurrency());
+}
+
+// CDS_QUEUE_SCHEDULING=deadline|fifo orders queued tests by deadline (default)
+// or strictly by arrival
+static SchedulingMode queueSchedulingMode() {
+    const char* value = std::getenv("CDS_QUEUE_SCHEDULING");
+    if (value && string(value) == "fifo") return SchedulingMode::FIFO;
+    return SchedulingMode::DEADLINE;
+}
+
+// CDS_LOG_LEVEL=debug|info|warn|error|off sets the least severe level logged
+// to stderr (default: info; debug also needs a -DCDS_MIN_LOG_LEVEL=0 build)
+static LogLevel logLevel() {
+    const char* value = std::getenv("CDS_LOG_LEVEL");
+    LogLevel level = LogLevel::INFO;
+    if (value) Logger::parseLevel(value, level);
+    return level;
+}
+
+// Records serialized per state lock acquisition when streaming GET /patients and /genetic
+static const size_t kPatientStreamBatch = 1024;
+static const size_t kGeneticStreamBatch = 4096;
+
+// Patients (stored and inline) accepted by one POST /diagnose/batch; the
+// whole batch is featurized under one shared lock and answered in one body
+static const size_t kMaxBatchPatients = 10000;
+
+enum class GeneticFormat { JSON, NDJSON, COLUMNS };
+
+// Helper: pick the GET /genetic response format from an Accept header.
+// The supported type with the highest q-value wins (the first on ties);
+// JSON if none is supported.
+static GeneticFormat negotiate_genetic_format(const string& accept) {
+    GeneticFormat best = GeneticFormat::JSON;
+    double bestQuality = 0.0;
+    std::string_view rest = accept;
+    while (!rest.empty()) {
+        size_t comma = rest.find(',');
+        std::string_view range = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+        size_t semicolon = range.find(';');
+        string type(CsvScanner::trim(range.substr(0, semicolon)));
+        std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+        double quality = 1.0;
+        if (semicolon != std::string_view::npos) {
+            std::string_view params = range.substr(semicolon + 1);
+            size_t q = params.find("q=");
+            if (q != std::string_view::npos) {
+                double parsed = 0.0;
+                quality = CsvScanner::parseDouble(params.substr(q + 2, params.find(';', q) - (q + 2)), parsed) ? parsed : 0.0;
+            }
+        }
+
+        GeneticFormat format;
+        if (type == "application/x-ndjson" || type == "application/ndjson") format = GeneticFormat::NDJSON;
+        else if (type == GeneticColumnEncoder::kContentType || type == "application/octet-stream") format = GeneticFormat::COLUMNS;
+        else if (type == "application/json" || type == "application/*" || type == "*/*") format = GeneticFormat::JSON;
+        else continue;
+        if (quality > bestQuality) {
+            best = format;
+            bestQuality = quality;
         }
     }
+    return best;
+}
+
+// Helper: escape JSON string
+static string json_escape(std::string_view s) {
+    string out;
+    JsonWriter::appendEscaped(out, s);
     return out;
 }
 
+// Helper: parse a non-negative decimal query parameter
+static bool parse_count(const string& text, size_t& out) {
+    unsigned long long value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        return false;
+    }
+    out = static_cast<size_t>(value);
+    return true;
+}
+
+static void write_genetic(JsonWriter& writer, const GeneticData& data) {
+    writer.beginObject()
+          .member("gene_id", std::string_view(data.getGeneId()))
+          .member("mutation_score", data.getMutationScore())
+          .member("label", data.getLabel())
+          .endObject();
+}
+
+static void write_patient(JsonWriter& writer, const Patient& patient) {
+    writer.beginObject()
+          .member("patient_id", std::string_view(patient.getPatientId()))
+          .member("name", patient.getName())
+          .member("age", patient.getAge())
+          .endObject();
+}
+
+// Serialized GET /status, /patients and /genetic responses kept per data version
+static const size_t kResponseCacheEntries = 64;
+static const size_t kResponseCacheMaxBody = 16 * 1024 * 1024;
+// Full lists up to this many records are built whole and cached; longer ones are streamed
+static const size_t kCachedListLimit = 50000;
+
+// Helper: tag for this server process, so ETags from before a restart
+// (when data versions count from zero again) never match
+static const string& instance_tag() {
+    static const string tag = [] {
+        char digits[20];
+        auto now = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+        auto result = std::to_chars(digits, digits + sizeof(digits), now, 36);
+        return string(digits, result.ptr);
+    }();
+    return tag;
+}
+
+// Helper: strong ETag of a representation at a data version
+static string make_etag(uint64_t version, std::string_view variant) {
+    return ResponseCache::makeETag(instance_tag(), version, variant);
+}
+
+// Helper: set the validator headers of a read; returns true (having
+// answered 304 Not Modified) if the client's copy is still current
+static bool not_modified(const httplib::Request& req, httplib::Response& res, const string& etag) {
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", "no-cache"); // Keep it, but revalidate before each use
+    res.set_header("Access-Control-Expose-Headers", "ETag, X-Next-Cursor");
+    if (req.has_header("If-None-Match") && ResponseCache::etagMatches(req.get_header_value("If-None-Match"), etag)) {
+        res.status = 304;
+        return true;
+    }
+    return false;
+}
+
+// Helper: reply with the cached response for `key` at `version`, building
+// (and caching) it first if needed. The shared body is sent without a copy.
+template <typename Build>
+static void send_cached(httplib::Response& res, ResponseCache& cache, const string& key, uint64_t version, Build&& build) {
+    std::shared_ptr<const ResponseCache::Response> response = cache.find(key, version);
+    if (!response) {
+        ResponseCache::Response built;
+        build(built);
+        response = cache.store(key, version, std::move(built));
+    }
+    for (const auto& header : response->headers) {
+        res.set_header(header.first, header.second);
+    }
+    size_t length = response->body.size();
+    res.set_content_provider(length, response->contentType,
+        [response](size_t offset, size_t length, httplib::DataSink& sink) {
+            return sink.write(response->body.data() + offset, length);
+        });
+}
+
+// Helper: wrap a route handler so that its duration and error responses
+// are recorded in Metrics::global(). The series are looked up once, here.
+template <typename Handler>
+static httplib::Server::Handler timed(const char* method, const char* route, Handler handler) {
+    string labels = string("method=\"") + method + "\",route=\"" + route + "\"";
+    LatencyHistogram& latency = Metrics::global().histogram("cds_http_request_duration_seconds", labels, 
+        "Time spent in route handlers (streamed bodies are sent after the handler returns)");
+    Counter& errors = Metrics::global().counter("cds_http_request_errors_total", labels, 
+        "Requests answered with a 4xx or 5xx status");
+    return [&latency, &errors, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res) {
+        {
+            ScopedTimer timer(latency);
+            handler(req, res);
+        }
+        if (res.status >= 400) {
+            errors.increment();
+        }
+    };
+}
+
 int serverMain() {
+    Logger::global().setLevel(logLevel());
     httplib::Server svr;
     CancerDiagnosisSystem system;
-
-    svr.Get("/status", [&](const httplib::Request& req, httplib::Response& res) {
-        std::ostringstream ss;
-        ss << "{\"modelsTrained\":" << (system.areModelsTrained() ? "true" : "false")
-           << ",\"geneticCount\":" << system.getGeneticDataCount()
-           << ",\"patientCount\":" << system.getPatientCount() << "}";
-        res.set_content(ss.str(), "application/json");
+    size_t httpThreads = httpThreadCount();
+    svr.new_task_queue = [httpThreads] { return new httplib::ThreadPool(httpThreads); };
+
+    // Individual additions go to the write-ahead log and are acknowledged once
+    // durable there; the CSV files are rewritten off the request path
+    system.enableWriteAheadLog(kLogFile, kGenesFile, kPatientsFile, logFsyncPolicy());
+    system.enableBackgroundPersistence(kGenesFile, kPatientsFile, kFlushInterval, kSnapshotFile);
+    auto persistChanges = [&]() {
+        system.syncWriteAheadLog();
+    };
+
+    // Warm start: restore data and trained models from the snapshot if it is
+    // still current for the default CSV files
+    system.loadSnapshot(kSnapshotFile, kGenesFile, kPatientsFile);
+    system.setSchedulingMode(queueSchedulingMode());
+    system.startDiagnosisWorkers(diagnosisWorkerCount());
+
+    // GET /status, /patients and /genetic carry an ETag for the current data
+    // version: a poll with If-None-Match gets 304 Not Modified until the data
+    // change, and the body of each version is serialized only once
+    ResponseCache responseCache(kResponseCacheEntries, kResponseCacheMaxBody);
+
+    svr.Get("/status", timed("GET", "/status", [&](const httplib::Request& req, httplib::Response& res) {
+        // Read the version first: a response built afterwards is at least that current
+        uint64_t version = system.getDataVersion();
         res.set_header("Access-Control-Allow-Origin", "*");
-    });
+        if (not_modified(req, res, make_etag(version, ""))) {
+            return;
+        }
+        send_cached(res, responseCache, "/status", version, [&](ResponseCache::Response& response) {
+            std::ostringstream ss;
+            ss << "{\"modelsTrained\":" << (system.areModelsTrained() ? "true" : "false")
+               << ",\"geneticCount\":" << system.getGeneticDataCount()
+               << ",\"patientCount\":" << system.getPatientCount() << "}";
+            response.body = ss.str();
+            response.contentType = "application/json";
+        });
+    }));
 
     // CORS preflight for /status
-    svr.Options("/status", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/status", timed("OPTIONS", "/status", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
-    });
+    }));
 
     // POST /load {"genesFile":"data/genes.csv","patientsFile":"data/patients.csv"}
-    svr.Post("/load", [&](const httplib::Request& req, httplib::Response& res) {
-        string body = req.body;
-        // naive JSON parsing (just extract values)
-        auto extract = [&](const string &key)->string {
-            size_t p = body.find(key);
-            if (p == string::npos) return string();
-            size_t colon = body.find(':', p);
-            if (colon == string::npos) return string();
-            size_t start = body.find_first_of('\"', colon);
-            if (start == string::npos) return string();
-            start++;
-            size_t end = body.find('"', start);
-            if (end == string::npos) return string();
-            return body.substr(start, end - start);
-        };
-
-        string genesFile = extract("genesFile");
-        string patientsFile = extract("patientsFile");
+    // POST /load?mode=append ingests only rows appended since the previous load
+    svr.Post("/load", timed("POST", "/load", [&](const httplib::Request& req, httplib::Response& res) {
+        LoadRequest request;
+        string parseError;
+        if (!request.parse(req.body, parseError)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid JSON: " + json_escape(parseError) + "\"}", "application/json");
+            return;
+        }
+        const string& genesFile = request.genesFile;
+        const string& patientsFile = request.patientsFile;
 
         if (genesFile.empty() || patientsFile.empty()) {
             res.status = 400;
@@ -80,245 +312,245 @@ int serverMain() {
             return;
         }
 
-        // Load data and train models
-        system.loadData(genesFile, patientsFile);
+        // Load data and train models (or restore them from an up-to-date snapshot)
+        string mode = "full";
+        if (req.has_param("mode") && req.get_param_value("mode") == "append") {
+            mode = system.appendData(genesFile, patientsFile) ? "append" : "full";
+            system.saveSnapshot(kSnapshotFile);
+        } else if (system.loadSnapshot(kSnapshotFile, genesFile, patientsFile)) {
+            mode = "snapshot";
+        } else {
+            system.loadData(genesFile, patientsFile);
+            system.saveSnapshot(kSnapshotFile);
+        }
 
         std::ostringstream ss;
-        ss << "{\"modelsTrained\":" << (system.areModelsTrained() ? "true" : "false")
+        ss << "{\"mode\":\"" << mode << "\""
+           << ",\"modelsTrained\":" << (system.areModelsTrained() ? "true" : "false")
            << ",\"geneticCount\":" << system.getGeneticDataCount()
            << ",\"patientCount\":" << system.getPatientCount() << "}";
         res.set_content(ss.str(), "application/json");
         res.set_header("Access-Control-Allow-Origin", "*");
-    });
+    }));
 
     // CORS preflight for /load
-    svr.Options("/load", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/load", timed("OPTIONS", "/load", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
-    });
+    }));
 
     // POST /patients  { "patient_id":"P011","name":"Alice","age":30, "geneticRecords":[{"geneId":"GENE_010","mutationScore":0.45,"label":0}, ...] }
-    svr.Post("/patients", [&](const httplib::Request& req, httplib::Response& res) {
-        string body = req.body;
-        auto extract = [&](const string &key)->string {
-            size_t p = body.find(key);
-            if (p == string::npos) return string();
-            size_t colon = body.find(':', p);
-            if (colon == string::npos) return string();
-            size_t start = body.find_first_of('"', colon);
-            if (start == string::npos) return string();
-            start++;
-            size_t end = body.find('"', start);
-            if (end == string::npos) return string();
-            return body.substr(start, end - start);
-        };
-
-        // Support a few key name variants
-        string pid = extract("patient_id");
-        if (pid.empty()) pid = extract("patientId");
-        if (pid.empty()) pid = extract("id");
-        string name = extract("name");
-        string ageStr = extract("age");
-        int age = 0;
-        try { if (!ageStr.empty()) age = stoi(ageStr); } catch(...) { age = 0; }
-
-        if (pid.empty() || name.empty()) {
+    svr.Post("/patients", timed("POST", "/patients", [&](const httplib::Request& req, httplib::Response& res) {
+        PatientRequest request;
+        string parseError;
+        if (!request.parse(req.body, parseError)) {
             res.status = 400;
-            res.set_content("{\"error\":\"Missing patient_id or name\"}", "application/json");
+            res.set_content("{\"error\":\"Invalid JSON: " + json_escape(parseError) + "\"}", "application/json");
             return;
         }
 
-        // Create patient and attach any genetic records found in body
-        Patient patient(pid, name, age);
-
-        // Naive scan for gene entries: look for occurrences of "geneId" or "gene_id"
-        size_t pos = 0;
-        while (true) {
-            size_t gpos = body.find("geneId", pos);
-            if (gpos == string::npos) gpos = body.find("gene_id", pos);
-            if (gpos == string::npos) break;
-
-            // extract gene id
-            size_t colon = body.find(':', gpos);
-            size_t start = body.find_first_of('"', colon);
-            if (start == string::npos) break; start++;
-            size_t end = body.find('"', start);
-            if (end == string::npos) break;
-            string geneId = body.substr(start, end - start);
-
-            // mutationScore (try several variants)
-            double mutationScore = 0.0;
-            size_t mpos = body.find("mutationScore", end);
-            if (mpos == string::npos) mpos = body.find("mutation_score", end);
-            if (mpos != string::npos) {
-                size_t mcolon = body.find(':', mpos);
-                if (mcolon != string::npos) {
-                    // read number after colon
-                    size_t numStart = body.find_first_not_of(" \t\r\n\"", mcolon+1);
-                    if (numStart != string::npos) {
-                        size_t numEnd = body.find_first_of(",}]\n\r", numStart);
-                        string numStr = body.substr(numStart, (numEnd==string::npos? body.size()-numStart: numEnd-numStart));
-                        try { mutationScore = stod(numStr); } catch(...) { mutationScore = 0.0; }
-                    }
-                }
-            }
-
-            int label = 0;
-            size_t lpos = body.find("label", end);
-            if (lpos != string::npos) {
-                size_t lcolon = body.find(':', lpos);
-                if (lcolon != string::npos) {
-                    size_t numStart = body.find_first_not_of(" \t\r\n\"", lcolon+1);
-                    if (numStart != string::npos) {
-                        size_t numEnd = body.find_first_of(",}]\n\r", numStart);
-                        string numStr = body.substr(numStart, (numEnd==string::npos? body.size()-numStart: numEnd-numStart));
-                        try { label = stoi(numStr); } catch(...) { label = 0; }
-                    }
-                }
-            }
+        if (request.patientId.empty() || request.name.empty()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing patient_id or name\"}", "application/json");
+            return;
+        }
 
-            // Create GeneticData and attach to global system and patient
-            GeneticData gd(geneId, mutationScore, label);
+        // Create patient with its genetic records, which also join the global table
+        Patient patient = request.toPatient();
+        for (const GeneticData& gd : request.geneticRecords) {
             system.addGeneticData(gd);
-            patient.addGeneticData(gd);
-
-            pos = end + 1;
         }
 
         // Add patient to system history (makes patient immediately available for /diagnose)
         system.addPatient(patient);
         
-        // IMPORTANT: Auto-save to CSV files immediately after adding patient
-        system.saveDataToFiles("data/genes.csv", "data/patients.csv");
+        // IMPORTANT: Persist immediately after adding patient
+        persistChanges();
 
         std::ostringstream ss;
         ss << "{\"success\":true,\"patientCount\":" << system.getPatientCount()
-           << ",\"geneticCount\":" << system.getGeneticDataCount() << ",\"message\":\"Patient added and data auto-saved to CSV\"}";
+           << ",\"geneticCount\":" << system.getGeneticDataCount() << ",\"message\":\"Patient added and data persisted\"}";
         res.set_content(ss.str(), "application/json");
         res.set_header("Access-Control-Allow-Origin", "*");
-    });
+    }));
 
     // CORS preflight for /patients
-    svr.Options("/patients", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/patients", timed("OPTIONS", "/patients", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
-    });
+    }));
+
+    // GET /patients -> [{ patient_id, name, age }, ...], most recent first.
+    // With ?limit=N only one page is returned; the X-Next-Cursor header, if
+    // present, is the cursor= value for the next page. Without a limit the
+    // list is streamed in chunks, so its size does not matter.
+    svr.Get("/patients", timed("GET", "/patients", [&](const httplib::Request& req, httplib::Response& res) {
+        uint64_t version = system.getDataVersion();
+        size_t cursor = SIZE_MAX;
+        size_t limit = 0;
+        bool paged = req.has_param("limit");
+        if ((req.has_param("cursor") && !parse_count(req.get_param_value("cursor"), cursor)) ||
+            (paged && (!parse_count(req.get_param_value("limit"), limit) || limit == 0))) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid limit or cursor\"}", "application/json");
+            return;
+        }
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (not_modified(req, res, make_etag(version, ""))) {
+            return;
+        }
 
-    svr.Get("/patients", [&](const httplib::Request& req, httplib::Response& res) {
-        std::ostringstream ss;
-        ss << "[";
-        bool first = true;
-
-        // iterate patients via displayPatientHistory would print; instead replicate traversal
-        // We rely on getPatientCount() and getPatientById for access; but getPatientById requires id.
-        // To extract patients, we will capture patient IDs by reading patients file again would be complex.
-        // Simpler: provide a light-weight approach by calling displayPatientHistory into a stringstream? Not available.
-        // Instead, use the public interface: iterate patient IDs  by invoking getPatientCount and trying common ids isn't possible.
-        // As a pragmatic approach, we'll expose patients through storing them when loading data. Modify system to provide a getter would be better,
-        // but to keep changes minimal we will call displayPatientHistory and parse the output. This is a hack but works for now.
-
-        // Capture output of displayPatientHistory
-        std::ostringstream capture;
-        // Temporarily redirect cout
-        auto cout_buf = std::cout.rdbuf();
-        std::cout.rdbuf(capture.rdbuf());
-        system.displayPatientHistory();
-        std::cout.rdbuf(cout_buf);
-
-        string out = capture.str();
-        // Parse lines looking for "Patient ID:" lines from Patient::display()
-        // Patient::display prints fields; to keep parsing simple, we look for lines with "Patient ID:" etc.
-        std::istringstream iss(out);
-        string line;
-        string id, name;
-        int age = 0;
-        while (std::getline(iss, line)) {
-            // trim
-            auto trim = [](string s){ size_t a = s.find_first_not_of(" \t\r\n"); if (a==string::npos) return string(); s = s.substr(a); size_t b = s.find_last_not_of(" \t\r\n"); if (b!=string::npos) s = s.substr(0,b+1); return s; };
-            line = trim(line);
-            if (line.rfind("Patient ID:", 0) == 0) {
-                id = trim(line.substr(11));
-            } else if (line.rfind("Name:", 0) == 0) {
-                name = trim(line.substr(5));
-            } else if (line.rfind("Age:", 0) == 0) {
-                string agestr = trim(line.substr(4));
-                try { age = stoi(agestr); } catch(...) { age = 0; }
-                if (!id.empty()) {
-                    if (!first) ss << ",";
-                    ss << "{\"patient_id\":\"" << json_escape(id) << "\",\"name\":\"" << json_escape(name) << "\",\"age\":" << age << "}";
-                    first = false;
-                    id.clear(); name.clear(); age = 0;
+        if (paged) {
+            string key = "/patients?limit=" + std::to_string(limit) + "&cursor=" + std::to_string(cursor);
+            send_cached(res, responseCache, key, version, [&](ResponseCache::Response& response) {
+                JsonWriter writer;
+                writer.beginArray();
+                size_t next = system.forEachPatientBefore(cursor, limit, [&](const Patient& patient) {
+                    write_patient(writer, patient);
+                });
+                writer.endArray();
+                if (next > 0) {
+                    response.headers.emplace_back("X-Next-Cursor", std::to_string(next));
                 }
-            }
+                response.body = writer.str();
+                response.contentType = "application/json";
+            });
+            return;
         }
 
-        ss << "]";
-        res.set_content(ss.str(), "application/json");
-        res.set_header("Access-Control-Allow-Origin", "*");
-    });
+        if (system.getPatientCount() <= kCachedListLimit) {
+            send_cached(res, responseCache, "/patients", version, [&](ResponseCache::Response& response) {
+                JsonWriter writer;
+                writer.beginArray();
+                system.forEachPatient([&](const Patient& patient) {
+                    write_patient(writer, patient);
+                });
+                writer.endArray();
+                response.body = writer.str();
+                response.contentType = "application/json";
+            });
+            return;
+        }
+
+        // One batch per chunk; the state lock is only held while a batch is serialized
+        res.set_chunked_content_provider("application/json",
+            [&system, cursor, writer = JsonWriter()](size_t offset, httplib::DataSink& sink) mutable {
+                if (offset == 0) {
+                    writer.beginArray();
+                }
+                cursor = system.forEachPatientBefore(cursor, kPatientStreamBatch, [&](const Patient& patient) {
+                    write_patient(writer, patient);
+                });
+                if (cursor == 0) {
+                    writer.endArray();
+                }
+                if (!sink.write(writer.view().data(), writer.size())) {
+                    return false;
+                }
+                writer.clearText();
+                if (cursor == 0) {
+                    sink.done();
+                }
+                return true;
+            });
+    }));
 
     // CORS preflight for /patients
-    svr.Options("/patients", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/patients", timed("OPTIONS", "/patients", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
-    });
+    }));
+
+    // GET /genetic -> every genetic record, in the format chosen by the Accept header:
+    //   application/json (default)           [{ gene_id, mutation_score, label }, ...]
+    //   application/x-ndjson                 one record object per line
+    //   application/vnd.cds.genetic-columns  columnar binary, see GeneticColumnEncoder
+    // Large JSON and NDJSON tables are streamed in chunks.
+    svr.Get(R"(/genetic)", timed("GET", "/genetic", [&](const httplib::Request& req, httplib::Response& res) {
+        uint64_t version = system.getDataVersion();
+        GeneticFormat format = negotiate_genetic_format(req.get_header_value("Accept"));
+        bool ndjson = format == GeneticFormat::NDJSON;
+        const char* variant = format == GeneticFormat::COLUMNS ? "columns" : ndjson ? "ndjson" : "json";
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Vary", "Accept");
+        if (not_modified(req, res, make_etag(version, variant))) {
+            return;
+        }
 
-    svr.Get(R"(/genetic)", [&](const httplib::Request& req, httplib::Response& res) {
-        std::ostringstream ss;
-        ss << "[";
-        bool first = true;
-        
-        // Similar hack: capture displayGeneticData output and parse
-        std::ostringstream capture;
-        auto cout_buf = std::cout.rdbuf();
-        std::cout.rdbuf(capture.rdbuf());
-        system.displayGeneticData();
-        std::cout.rdbuf(cout_buf);
-
-        string out = capture.str();
-        // Look for lines like: Gene ID: ...
-        istringstream iss(out);
-        string line;
-        string gid; double score=0; int label=0;
-        while (getline(iss, line)) {
-            auto trim = [](string s){ size_t a = s.find_first_not_of(" \t\r\n"); if (a==string::npos) return string(); s = s.substr(a); size_t b = s.find_last_not_of(" \t\r\n"); if (b!=string::npos) s = s.substr(0,b+1); return s; };
-            line = trim(line);
-            if (line.rfind("Gene ID:", 0) == 0) {
-                gid = trim(line.substr(8));
-            } else if (line.rfind("Mutation Score:", 0) == 0) {
-                string s = trim(line.substr(15)); try { score = stod(s); } catch(...) { score = 0; }
-            } else if (line.rfind("Label:", 0) == 0) {
-                string s = trim(line.substr(6)); try { label = stoi(s); } catch(...) { label = 0; }
-                if (!gid.empty()) {
-                    if (!first) ss << ",";
-                    ss << "{\"gene_id\":\"" << json_escape(gid) << "\",\"mutation_score\":" << score << ",\"label\":" << label << "}";
-                    first = false;
-                    gid.clear(); score = 0; label = 0;
+        if (format == GeneticFormat::COLUMNS) {
+            send_cached(res, responseCache, string("/genetic:") + variant, version, [&](ResponseCache::Response& response) {
+                system.visitGeneticTable([&](const GeneticDataTable& table) {
+                    GeneticColumnEncoder::encode(table, response.body);
+                });
+                response.contentType = GeneticColumnEncoder::kContentType;
+            });
+            return;
+        }
+
+        if (system.getGeneticDataCount() <= kCachedListLimit) {
+            send_cached(res, responseCache, string("/genetic:") + variant, version, [&](ResponseCache::Response& response) {
+                JsonWriter writer;
+                if (!ndjson) {
+                    writer.beginArray();
                 }
-            }
+                system.forEachGeneticData([&](const GeneticData& data) {
+                    write_genetic(writer, data);
+                    if (ndjson) {
+                        writer.newline();
+                    }
+                });
+                if (!ndjson) {
+                    writer.endArray();
+                }
+                response.body = writer.str();
+                response.contentType = ndjson ? "application/x-ndjson" : "application/json";
+            });
+            return;
         }
 
-        ss << "]";
-        res.set_content(ss.str(), "application/json");
-        res.set_header("Access-Control-Allow-Origin", "*");
-    });
+        res.set_chunked_content_provider(ndjson ? "application/x-ndjson" : "application/json",
+            [&system, ndjson, position = size_t(0), writer = JsonWriter()](size_t offset, httplib::DataSink& sink) mutable {
+                if (offset == 0 && !ndjson) {
+                    writer.beginArray();
+                }
+                size_t next = system.forEachGeneticDataFrom(position, kGeneticStreamBatch, [&](const GeneticData& data) {
+                    write_genetic(writer, data);
+                    if (ndjson) {
+                        writer.newline();
+                    }
+                });
+                bool done = next - position < kGeneticStreamBatch;
+                position = next;
+                if (done && !ndjson) {
+                    writer.endArray();
+                }
+                if (writer.size() > 0 && !sink.write(writer.view().data(), writer.size())) {
+                    return false;
+                }
+                writer.clearText();
+                if (done) {
+                    sink.done();
+                }
+                return true;
+            });
+    }));
 
     // CORS preflight for /genetic
-    svr.Options("/genetic", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/genetic", timed("OPTIONS", "/genetic", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
-    });
+    }));
 
     // GET /diagnose?patient_id=P001&model=logistic
-    svr.Get(R"(/diagnose)", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Get(R"(/diagnose)", timed("GET", "/diagnose", [&](const httplib::Request& req, httplib::Response& res) {
         auto params = req.params;
         string pid;
         string modelStr = "logistic";
@@ -331,38 +563,137 @@ int serverMain() {
             return;
         }
 
-        Patient patient;
-        if (!system.getPatientById(pid, patient)) {
+        CancerDiagnosisSystem::ModelType model = modelTypeFromName(modelStr);
+
+        // Diagnose the stored patient in place rather than copying it out;
+        // concurrent diagnoses share the state lock
+        std::ostringstream ss;
+        std::optional<CancerDiagnosisSystem::DiagnosisResult> result = system.diagnoseStoredPatient(pid, model);
+        if (result) {
+            ss << "{\"patient_id\":\"" << json_escape(result->patientId) << "\",\"riskScore\":" << result->riskScore 
+               << ",\"prediction\":" << result->prediction << "}";
+        } else {
             res.status = 404;
-            std::ostringstream ss; ss << "{\"error\":\"Patient ID '" << json_escape(pid) << "' not found\"}";
+            ss << "{\"error\":\"Patient ID '" << json_escape(pid) << "' not found\"}";
             res.set_content(ss.str(), "application/json");
             return;
         }
 
-        CancerDiagnosisSystem::ModelType model = CancerDiagnosisSystem::ModelType::LOGISTIC;
-        if (modelStr == "knn") model = CancerDiagnosisSystem::ModelType::KNN;
-        else if (modelStr == "decision_tree") model = CancerDiagnosisSystem::ModelType::DECISION_TREE;
-        else if (modelStr == "naive_bayes") model = CancerDiagnosisSystem::ModelType::NAIVE_BAYES;
-
-        double risk = system.diagnosePatient(patient, model);
-        int pred = system.predictPatient(patient, model);
-
-        std::ostringstream ss;
-        ss << "{\"patient_id\":\"" << json_escape(patient.getPatientId()) << "\",\"riskScore\":" << risk << ",\"prediction\":" << pred << "}";
         res.set_content(ss.str(), "application/json");
         res.set_header("Access-Control-Allow-Origin", "*");
-    });
+    }));
 
     // CORS preflight for /diagnose
-    svr.Options("/diagnose", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/diagnose", timed("OPTIONS", "/diagnose", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
-    });
+    }));
+
+    // GET /diagnose/cache -> { hits, misses, hitRate, entries, capacity } of the /diagnose score cache
+    svr.Get("/diagnose/cache", timed("GET", "/diagnose/cache", [&](const httplib::Request& req, httplib::Response& res) {
+        DiagnosisCache::Stats stats = system.getDiagnosisCacheStats();
+        uint64_t lookups = stats.hits + stats.misses;
+        JsonWriter writer;
+        writer.beginObject()
+              .member("hits", stats.hits)
+              .member("misses", stats.misses)
+              .member("hitRate", lookups > 0 ? static_cast<double>(stats.hits) / lookups : 0.0)
+              .member("entries", static_cast<uint64_t>(stats.entries))
+              .member("capacity", static_cast<uint64_t>(stats.capacity))
+              .endObject();
+        res.set_content(writer.str(), "application/json");
+        res.set_header("Access-Control-Allow-Origin", "*");
+    }));
 
-    // GET /queue -> { queueSize: N, patients: ["P1","P2"] }
-    svr.Get("/queue", [&](const httplib::Request& req, httplib::Response& res) {
+    // CORS preflight for /diagnose/cache
+    svr.Options("/diagnose/cache", timed("OPTIONS", "/diagnose/cache", [&](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type");
+        res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        res.set_content("", "text/plain");
+    }));
+
+    // POST /diagnose/batch { "patient_ids":["P001","P002"], "patients":[{ inline patient }],
+    //                        "models":["logistic","knn"] }
+    // -> { models, count, results: [{ patient_id, name, found,
+    //      diagnoses: [{ model, riskScore, prediction }] }], found }
+    // Stored patients come first, in request order, then inline ones, which
+    // are scored but not stored. Features are extracted once for all patients
+    // and each model scores them in one batch.
+    svr.Post("/diagnose/batch", timed("POST", "/diagnose/batch", [&](const httplib::Request& req, httplib::Response& res) {
+        BatchDiagnosisRequest request;
+        string parseError;
+        if (!request.parse(req.body, parseError)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid JSON: " + json_escape(parseError) + "\"}", "application/json");
+            return;
+        }
+        if (request.patientIds.empty() && request.patients.empty()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing patient_ids or patients\"}", "application/json");
+            return;
+        }
+        if (request.patientIds.size() + request.patients.size() > kMaxBatchPatients) {
+            res.status = 413;
+            res.set_content("{\"error\":\"At most " + std::to_string(kMaxBatchPatients) + 
+                            " patients per batch\"}", "application/json");
+            return;
+        }
+
+        std::vector<Patient> inlinePatients;
+        inlinePatients.reserve(request.patients.size());
+        for (const PatientRequest& patient : request.patients) {
+            inlinePatients.push_back(patient.toPatient());
+        }
+        std::vector<CancerDiagnosisSystem::DiagnosisResult> results =
+            system.diagnoseBatch(request.patientIds, inlinePatients, request.models);
+
+        size_t modelCount = request.models.size();
+        size_t patientCount = results.size() / modelCount;
+        size_t found = 0;
+        JsonWriter writer;
+        writer.reserve(results.size() * 64);
+        writer.beginObject().key("models").beginArray();
+        for (CancerDiagnosisSystem::ModelType model : request.models) {
+            writer.value(CancerDiagnosisSystem::modelName(model));
+        }
+        writer.endArray().member("count", static_cast<uint64_t>(patientCount)).key("results").beginArray();
+        for (size_t i = 0; i < patientCount; ++i) {
+            const CancerDiagnosisSystem::DiagnosisResult& first = results[i * modelCount];
+            writer.beginObject().member("patient_id", std::string_view(first.patientId));
+            if (!first.found) {
+                writer.member("found", false).endObject();
+                continue;
+            }
+            found++;
+            writer.member("name", std::string_view(first.name)).member("found", true).key("diagnoses").beginArray();
+            for (size_t m = 0; m < modelCount; ++m) {
+                const CancerDiagnosisSystem::DiagnosisResult& result = results[i * modelCount + m];
+                writer.beginObject()
+                      .member("model", CancerDiagnosisSystem::modelName(result.model))
+                      .member("riskScore", result.riskScore)
+                      .member("prediction", result.prediction)
+                      .endObject();
+            }
+            writer.endArray().endObject();
+        }
+        writer.endArray().member("found", static_cast<uint64_t>(found)).endObject();
+        res.set_content(writer.str(), "application/json");
+        res.set_header("Access-Control-Allow-Origin", "*");
+    }));
+
+    svr.Options("/diagnose/batch", timed("OPTIONS", "/diagnose/batch", [&](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type");
+        res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        res.set_content("", "text/plain");
+    }));
+
+    // GET /queue -> { queueSize: N, patients: ["P1","P2"], scheduling: "deadline",
+    //                 classes: [{ priority, depth, dispatched, meanWaitMs, maxWaitMs, missedDeadlines }] }
+    svr.Get("/queue", timed("GET", "/queue", [&](const httplib::Request& req, httplib::Response& res) {
         std::ostringstream ss;
         auto ids = system.getQueuedPatientIds();
         ss << "{";
@@ -372,95 +703,93 @@ int serverMain() {
             if (i) ss << ",";
             ss << "\"" << json_escape(ids[i]) << "\"";
         }
+        ss << "],\"scheduling\":\"" 
+           << (system.getSchedulingMode() == SchedulingMode::FIFO ? "fifo" : "deadline") << "\"";
+        ss << ",\"classes\":[";
+        for (size_t i = 0; i < kTestPriorityCount; ++i) {
+            TestPriority priority = static_cast<TestPriority>(i);
+            TestQueueStats stats = system.getQueueStats(priority);
+            if (i) ss << ",";
+            ss << "{\"priority\":\"" << testPriorityName(priority) << "\""
+               << ",\"depth\":" << stats.depth
+               << ",\"dispatched\":" << stats.dispatched
+               << ",\"meanWaitMs\":" << stats.meanWaitMs
+               << ",\"maxWaitMs\":" << stats.maxWaitMs
+               << ",\"missedDeadlines\":" << stats.missedDeadlines << "}";
+        }
         ss << "]}";
         res.set_content(ss.str(), "application/json");
         res.set_header("Access-Control-Allow-Origin", "*");
-    });
+    }));
 
-    svr.Options("/queue", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/queue", timed("OPTIONS", "/queue", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
-    });
+    }));
+
+    // POST /queue { "patient_id":"P001", "model":"knn", "priority":"urgent", "deadline_ms":2000 }
+    // -> schedule patient for testing. model defaults to logistic; priority
+    // (urgent|high|normal|low) defaults to a class derived from the patient;
+    // deadline_ms optionally tightens the class deadline.
+    svr.Post("/queue", timed("POST", "/queue", [&](const httplib::Request& req, httplib::Response& res) {
+        QueueRequest request;
+        string parseError;
+        if (!request.parse(req.body, parseError)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid JSON: " + json_escape(parseError) + "\"}", "application/json");
+            return;
+        }
 
-    // POST /queue { "patient_id":"P001" } -> schedule patient for testing
-    svr.Post("/queue", [&](const httplib::Request& req, httplib::Response& res) {
-        string body = req.body;
-        auto extract = [&](const string &key)->string {
-            size_t p = body.find(key);
-            if (p == string::npos) return string();
-            size_t colon = body.find(':', p);
-            if (colon == string::npos) return string();
-            size_t start = body.find_first_of('"', colon);
-            if (start == string::npos) return string();
-            start++;
-            size_t end = body.find('"', start);
-            if (end == string::npos) return string();
-            return body.substr(start, end - start);
-        };
-
-        string pid = extract("patient_id");
-        if (pid.empty()) pid = extract("patientId");
+        const string& pid = request.patientId;
         if (pid.empty()) {
             res.status = 400;
             res.set_content("{\"error\":\"Missing patient_id\"}", "application/json");
             return;
         }
 
-        Patient patient;
-        if (!system.getPatientById(pid, patient)) {
+        if (!system.visitPatient(pid, [](const Patient&) {})) {
             res.status = 404;
             std::ostringstream ss; ss << "{\"error\":\"Patient ID '" << json_escape(pid) << "' not found\"}";
             res.set_content(ss.str(), "application/json");
             return;
         }
 
-        system.scheduleTest(patient);
+        if (!system.scheduleTest(pid, request.model, request.priority, request.deadline)) {
+            res.status = 503;
+            res.set_content("{\"error\":\"Queue is full\"}", "application/json");
+            return;
+        }
 
         std::ostringstream ss;
         ss << "{\"success\":true,\"queueSize\":" << system.getQueueSize() << ",\"message\":\"Patient scheduled for diagnosis\"}";
         res.set_content(ss.str(), "application/json");
         res.set_header("Access-Control-Allow-Origin", "*");
-    });
-
-    // POST /queue/process -> processes all queued patients with optional model selection
-    // Body: { "model": "logistic" } or empty for default (logistic)
-    svr.Post("/queue/process", [&](const httplib::Request& req, httplib::Response& res) {
-        string body = req.body;
-        
-        // Extract model from request body
-        string modelStr = "logistic"; // default
-        size_t modelPos = body.find("\"model\"");
-        if (modelPos != string::npos) {
-            size_t colon = body.find(':', modelPos);
-            if (colon != string::npos) {
-                size_t start = body.find_first_of('"', colon);
-                if (start != string::npos) {
-                    start++;
-                    size_t end = body.find('"', start);
-                    if (end != string::npos) {
-                        modelStr = body.substr(start, end - start);
-                    }
-                }
-            }
+    }));
+
+    // POST /queue/process -> waits for queued patients to be diagnosed and returns
+    // the results since the previous call. Body: { "model": "logistic" } or empty;
+    // the model only applies to patients no worker has picked up yet.
+    svr.Post("/queue/process", timed("POST", "/queue/process", [&](const httplib::Request& req, httplib::Response& res) {
+        ProcessQueueRequest request;
+        string parseError;
+        if (!request.parse(req.body, parseError)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid JSON: " + json_escape(parseError) + "\"}", "application/json");
+            return;
         }
-        
-        // Map string to ModelType
-        CancerDiagnosisSystem::ModelType model = CancerDiagnosisSystem::ModelType::LOGISTIC;
-        if (modelStr == "knn") model = CancerDiagnosisSystem::ModelType::KNN;
-        else if (modelStr == "decision_tree") model = CancerDiagnosisSystem::ModelType::DECISION_TREE;
-        else if (modelStr == "naive_bayes") model = CancerDiagnosisSystem::ModelType::NAIVE_BAYES;
 
         // Process queue with selected model and get diagnosis results
-        auto results = system.processTestQueueWithModel(model);
+        auto results = system.processTestQueueWithModel(request.model);
 
-        // Persist changes to CSV files
-        system.saveDataToFiles("data/genes.csv", "data/patients.csv");
+        // Persist processed patients
+        persistChanges();
 
         // Build JSON array of results
         std::ostringstream ss;
-        ss << "{\"model\":\"" << modelStr << "\",\"processed\":" << results.size() 
+        ss << "{\"model\":" << (request.model ? "\"" + json_escape(request.modelName) + "\"" : string("null"))
+           << ",\"processed\":" << results.size() 
            << ",\"results\":[";
         for (size_t i = 0; i < results.size(); ++i) {
             if (i) ss << ",";
@@ -470,20 +799,62 @@ int serverMain() {
            << ",\"geneticCount\":" << system.getGeneticDataCount() << "}";
         res.set_content(ss.str(), "application/json");
         res.set_header("Access-Control-Allow-Origin", "*");
-    });
+    }));
 
-    svr.Options("/queue/process", [&](const httplib::Request& req, httplib::Response& res) {
+    svr.Options("/queue/process", timed("OPTIONS", "/queue/process", [&](const httplib::Request& req, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_content("", "text/plain");
+    }));
+
+    // Values kept by the system and the caches are read when /metrics is scraped
+    Metrics& metrics = Metrics::global();
+    for (size_t i = 0; i < kTestPriorityCount; ++i) {
+        TestPriority priority = static_cast<TestPriority>(i);
+        string labels = string("priority=\"") + testPriorityName(priority) + "\"";
+        metrics.gauge("cds_queue_depth", labels, "Tests waiting in the queue", [&system, priority] {
+            return static_cast<double>(system.getQueueStats(priority).depth);
+        });
+        metrics.counter("cds_queue_missed_deadlines_total", labels, "Tests dispatched after their deadline", 
+            [&system, priority] {
+                return static_cast<double>(system.getQueueStats(priority).missedDeadlines);
+            });
+    }
+    metrics.gauge("cds_patients", "", "Stored patients", [&system] {
+        return static_cast<double>(system.getPatientCount());
+    });
+    metrics.gauge("cds_genetic_records", "", "Stored genetic records", [&system] {
+        return static_cast<double>(system.getGeneticDataCount());
+    });
+    metrics.gauge("cds_write_ahead_log_bytes", "", "Changes logged since the CSV files were last rewritten", [&system] {
+        return static_cast<double>(system.getWriteAheadLogSize());
     });
+    metrics.counter("cds_diagnosis_cache_hits_total", "", "GET /diagnose scores reused from the cache", [&system] {
+        return static_cast<double>(system.getDiagnosisCacheStats().hits);
+    });
+    metrics.counter("cds_diagnosis_cache_misses_total", "", "GET /diagnose scores computed", [&system] {
+        return static_cast<double>(system.getDiagnosisCacheStats().misses);
+    });
+    metrics.counter("cds_response_cache_hits_total", "", "Read responses served from the cache", [&responseCache] {
+        return static_cast<double>(responseCache.getHits());
+    });
+    metrics.counter("cds_response_cache_misses_total", "", "Read responses built", [&responseCache] {
+        return static_cast<double>(responseCache.getMisses());
+    });
+
+    // GET /metrics -> every metric in the Prometheus text format
+    svr.Get("/metrics", timed("GET", "/metrics", [&](const httplib::Request& req, httplib::Response& res) {
+        string text;
+        metrics.render(text);
+        res.set_content(std::move(text), Metrics::kContentType);
+    }));
 
-    std::cout << "Starting server on http://localhost:8080 ..." << std::endl;
-        std::cout.flush();
+    CDS_LOG_INFO("Starting server on http://localhost:8080 ...");
     
         if (!svr.listen("localhost", 8080)) {
-            std::cerr << "Failed to bind to port 8080. Is another server already running?" << std::endl;
+            CDS_LOG_ERROR("Failed to bind to port 8080. Is another server already running?");
+            Logger::global().flush();
             return 1;
         }
 
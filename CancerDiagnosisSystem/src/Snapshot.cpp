@@ -0,0 +1,102 @@
+#include "../headers/Snapshot.h"
+#include "../headers/AtomicFile.h"
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'C', 'D', 'S', 'S', 'N', 'A', 'P', '\0'};
+
+} // namespace
+
+uint64_t payloadChecksum(std::string_view data) {
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < data.size(); ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
+
+void SnapshotWriter::writeString(std::string_view value) {
+    write<uint32_t>(static_cast<uint32_t>(value.size()));
+    buffer.append(value.data(), value.size());
+}
+
+void SnapshotWriter::align() {
+    buffer.append((8 - buffer.size() % 8) % 8, '\0');
+}
+
+bool SnapshotWriter::saveToFile(const std::string& filename) const {
+    SnapshotHeader header;
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.payloadSize = buffer.size();
+    header.checksum = payloadChecksum(buffer);
+
+    // Readers never observe a half-written snapshot
+    return writeFileAtomically(filename, {
+        std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)), buffer});
+}
+
+SnapshotReader::SnapshotReader() : position(0) {}
+
+bool SnapshotReader::open(const std::string& filename, std::string& error) {
+    if (!file.open(filename)) {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    std::string_view contents = file.view();
+    if (contents.size() < sizeof(SnapshotHeader)) {
+        error = "file too small for snapshot header";
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) {
+        error = "not a snapshot file";
+        return false;
+    }
+    if (header.version != kSnapshotVersion || header.headerSize != sizeof(SnapshotHeader)) {
+        error = "unsupported snapshot version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.payloadSize != contents.size() - sizeof(SnapshotHeader)) {
+        error = "snapshot payload is truncated";
+        return false;
+    }
+
+    payload = contents.substr(sizeof(SnapshotHeader));
+    if (payloadChecksum(payload) != header.checksum) {
+        error = "snapshot checksum mismatch";
+        return false;
+    }
+    position = 0;
+    return true;
+}
+
+const char* SnapshotReader::take(size_t bytes) {
+    if (bytes > payload.size() - position) {
+        throw std::runtime_error("Unexpected end of snapshot payload");
+    }
+    const char* ptr = payload.data() + position;
+    position += bytes;
+    return ptr;
+}
+
+std::string SnapshotReader::readString() {
+    uint32_t length = read<uint32_t>();
+    return std::string(take(length), length);
+}
+
+void SnapshotReader::align() {
+    take((8 - position % 8) % 8);
+}
@@ -0,0 +1,92 @@
+#include "../headers/StringInterner.h"
+#include <bit>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+// Chunk k holds IDs [first * (2^k - 1), first * (2^(k+1) - 1))
+struct ChunkPosition {
+    size_t chunk;
+    size_t offset;
+};
+
+ChunkPosition chunkPosition(uint32_t id, size_t firstChunkSize) {
+    size_t chunk = std::bit_width(id / firstChunkSize + 1) - 1;
+    size_t chunkStart = firstChunkSize * ((size_t(1) << chunk) - 1);
+    return ChunkPosition{chunk, id - chunkStart};
+}
+
+} // namespace
+
+StringInterner::StringInterner() : count(0) {
+    for (auto& chunk : chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+    intern(std::string_view()); // Symbol 0 is the empty string
+}
+
+StringInterner::~StringInterner() {
+    for (auto& chunk : chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+StringInterner& StringInterner::global() {
+    static StringInterner interner;
+    return interner;
+}
+
+Symbol StringInterner::intern(std::string_view text) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(text);
+        if (it != ids.end()) {
+            return Symbol(it->second);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(text);
+    if (it != ids.end()) {
+        return Symbol(it->second); // Interned by another thread meanwhile
+    }
+
+    if (count == UINT32_MAX) {
+        throw std::runtime_error("String interner is full");
+    }
+    ChunkPosition position = chunkPosition(count, kFirstChunkSize);
+    std::string* chunk = chunks[position.chunk].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new std::string[kFirstChunkSize << position.chunk];
+        chunks[position.chunk].store(chunk, std::memory_order_release);
+    }
+
+    std::string& stored = chunk[position.offset];
+    stored.assign(text.data(), text.size());
+    uint32_t id = count++;
+    ids.emplace(std::string_view(stored), id);
+    return Symbol(id);
+}
+
+bool StringInterner::find(std::string_view text, Symbol& symbol) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(text);
+    if (it == ids.end()) {
+        return false;
+    }
+    symbol = Symbol(it->second);
+    return true;
+}
+
+const std::string& StringInterner::lookup(Symbol symbol) const {
+    // A symbol is only handed out after its string is stored, and stored
+    // strings never change, so no lock is needed here
+    ChunkPosition position = chunkPosition(symbol.value, kFirstChunkSize);
+    return chunks[position.chunk].load(std::memory_order_acquire)[position.offset];
+}
+
+size_t StringInterner::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return count;
+}
@@ -0,0 +1,347 @@
+#include "../headers/WriteAheadLog.h"
+#include "../headers/MappedFile.h"
+#include "../headers/AtomicFile.h"
+#include "../headers/Logger.h"
+#include <algorithm>
+#include <random>
+#include <charconv>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+int openForAppend(const std::string& logFile) {
+#ifdef _WIN32
+    return _open(logFile.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(logFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+void closeFile(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+constexpr std::string_view kHeaderTag = "WAL\t";
+
+uint64_t newLogId() {
+    std::random_device device;
+    uint64_t id = (static_cast<uint64_t>(device()) << 32) ^ device() ^
+                  static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return id == 0 ? 1 : id; // 0 is reserved for logs without a header
+}
+
+// Length of the header line at the start of `contents` (0 if there is none,
+// as in logs written before headers existed); sets `id` to the id it names
+size_t parseHeader(std::string_view contents, uint64_t& id) {
+    id = 0;
+    size_t end = contents.find('\n');
+    if (contents.substr(0, kHeaderTag.size()) != kHeaderTag || end == std::string_view::npos) {
+        return 0;
+    }
+    std::from_chars(contents.data() + kHeaderTag.size(), contents.data() + end, id);
+    return end + 1;
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog()
+    : fsyncPolicy(FsyncPolicy::ALWAYS), fsyncInterval(100), fd(-1),
+      appendedSequence(0), durableSequence(0), logBytes(0), headerBytes(0), logId(0),
+      stopping(false), writeFailed(false), flushing(false), unsynced(false) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open(const std::string& logFile, FsyncPolicy policy,
+                         std::chrono::milliseconds interval) {
+    close();
+
+    fd = openForAppend(logFile);
+    if (fd < 0) {
+        CDS_LOG_ERROR("Could not open write-ahead log " << logFile);
+        return false;
+    }
+
+    // Drop a record torn by a crash so new records do not get glued onto it
+    uint64_t id = 0;
+    size_t header = 0;
+    {
+        MappedFile existing;
+        if (existing.open(logFile)) {
+            std::string_view contents = existing.view();
+            size_t lastNewline = contents.rfind('\n');
+            size_t validBytes = (lastNewline == std::string_view::npos) ? 0 : lastNewline + 1;
+            header = parseHeader(contents.substr(0, validBytes), id);
+            if (validBytes != contents.size()) {
+#ifdef _WIN32
+                _chsize_s(fd, static_cast<__int64>(validBytes));
+#else
+                if (ftruncate(fd, static_cast<off_t>(validBytes)) != 0) {
+                    CDS_LOG_ERROR("Could not trim torn record from " << logFile);
+                }
+#endif
+            }
+        }
+    }
+
+    struct stat st;
+    logBytes = (fstat(fd, &st) == 0) ? static_cast<uint64_t>(st.st_size) : 0;
+
+    // A new (or emptied) log starts a new generation
+    if (logBytes == 0) {
+        id = newLogId();
+        std::string line = makeHeader(id);
+        if (!writeAll(line)) {
+            CDS_LOG_ERROR("Could not write header of " << logFile);
+            closeFile(fd);
+            fd = -1;
+            return false;
+        }
+        if (policy != FsyncPolicy::NEVER) {
+            syncFile();
+        }
+        logBytes = header = line.size();
+    }
+    headerBytes = header;
+    logId = id;
+
+    filename = logFile;
+    fsyncPolicy = policy;
+    fsyncInterval = interval;
+    appendedSequence = 0;
+    durableSequence = 0;
+    stopping = false;
+    writeFailed = false;
+    flushing = false;
+    unsynced = false;
+    lastSync = std::chrono::steady_clock::now();
+    flusher = std::thread(&WriteAheadLog::flushLoop, this);
+    return true;
+}
+
+void WriteAheadLog::close() {
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        pendingCondition.notify_all();
+        flusher.join();
+    }
+    if (fd >= 0) {
+        if (fsyncPolicy != FsyncPolicy::NEVER) {
+            syncFile();
+        }
+        closeFile(fd);
+        fd = -1;
+    }
+}
+
+uint64_t WriteAheadLog::append(std::string_view record) {
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.append(record.data(), record.size());
+        pending.push_back('\n');
+        logBytes += record.size() + 1;
+        sequence = ++appendedSequence;
+    }
+    pendingCondition.notify_one();
+    return sequence;
+}
+
+bool WriteAheadLog::waitDurable(uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex);
+    durableCondition.wait(lock, [&] { return durableSequence >= sequence; });
+    return !writeFailed;
+}
+
+bool WriteAheadLog::sync() {
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sequence = appendedSequence;
+    }
+    return waitDurable(sequence);
+}
+
+bool WriteAheadLog::discardPrefix(uint64_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // Wait for the flusher to go idle; it cannot start another batch while we hold the lock
+    durableCondition.wait(lock, [&] { return durableSequence >= appendedSequence && !flushing; });
+    if (fd < 0) {
+        return false;
+    }
+
+    // Replace the log with a new header and the records after the prefix,
+    // so a crash leaves either the old log or the new one
+    uint64_t start = headerBytes + std::min(bytes, logBytes - headerBytes);
+    std::string tail;
+    {
+        MappedFile existing;
+        if (!existing.open(filename) || existing.view().size() != logBytes) {
+            return false;
+        }
+        tail.assign(existing.view().substr(start));
+    }
+    uint64_t id = newLogId();
+    std::string header = makeHeader(id);
+    closeFile(fd);
+    bool ok = writeFileAtomically(filename, {header, tail});
+    fd = openForAppend(filename);
+    if (fd < 0) {
+        writeFailed = true;
+        CDS_LOG_ERROR("Could not reopen write-ahead log " << filename);
+        return false;
+    }
+    if (ok) {
+        logBytes = header.size() + tail.size();
+        headerBytes = header.size();
+        logId = id;
+    }
+    return ok;
+}
+
+uint64_t WriteAheadLog::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return logBytes - headerBytes;
+}
+
+uint64_t WriteAheadLog::getLogId() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return logId;
+}
+
+const std::string& WriteAheadLog::getFilename() const {
+    return filename;
+}
+
+void WriteAheadLog::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto hasWork = [&] { return stopping || !pending.empty(); };
+    while (true) {
+        // A written but unsynced tail is synced when the interval runs out,
+        // even if no further records arrive
+        if (unsynced) {
+            pendingCondition.wait_until(lock, lastSync + fsyncInterval, hasWork);
+        } else {
+            pendingCondition.wait(lock, hasWork);
+        }
+        if (pending.empty()) {
+            if (stopping) {
+                break; // Nothing left to write; close() syncs the tail
+            }
+            flushing = true;
+            lock.unlock();
+            syncFile();
+            lastSync = std::chrono::steady_clock::now();
+            lock.lock();
+            flushing = false;
+            unsynced = false;
+            durableCondition.notify_all();
+            continue;
+        }
+
+        // Take everything buffered so far as one group commit
+        std::string batch;
+        batch.swap(pending);
+        uint64_t batchEnd = appendedSequence;
+        flushing = true;
+        lock.unlock();
+
+        bool ok = writeAll(batch);
+        bool synced = false;
+        if (ok && fsyncPolicy == FsyncPolicy::ALWAYS) {
+            syncFile();
+            synced = true;
+        } else if (ok && fsyncPolicy == FsyncPolicy::PERIODIC &&
+                   std::chrono::steady_clock::now() - lastSync >= fsyncInterval) {
+            syncFile();
+            lastSync = std::chrono::steady_clock::now();
+            synced = true;
+        }
+
+        lock.lock();
+        flushing = false;
+        if (ok) {
+            unsynced = fsyncPolicy == FsyncPolicy::PERIODIC && !synced;
+        } else {
+            writeFailed = true;
+            CDS_LOG_ERROR("Write to " << filename << " failed");
+        }
+        durableSequence = batchEnd;
+        durableCondition.notify_all();
+    }
+    durableCondition.notify_all();
+}
+
+bool WriteAheadLog::writeAll(const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+#ifdef _WIN32
+        int n = _write(fd, data.data() + written, static_cast<unsigned int>(data.size() - written));
+#else
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+#endif
+        if (n <= 0) {
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string WriteAheadLog::makeHeader(uint64_t id) {
+    std::string header(kHeaderTag);
+    header += std::to_string(id);
+    header += '\n';
+    return header;
+}
+
+void WriteAheadLog::syncFile() {
+#ifdef _WIN32
+    _commit(fd);
+#else
+    fsync(fd);
+#endif
+}
+
+size_t WriteAheadLog::replay(const std::string& logFile,
+                             const std::function<void(std::string_view)>& visitor) {
+    MappedFile file;
+    if (!file.open(logFile)) {
+        return 0;
+    }
+
+    // A record without its trailing newline was torn by a crash; ignore it
+    std::string_view contents = file.view();
+    uint64_t id;
+    size_t count = 0;
+    size_t start = parseHeader(contents, id);
+    while (start < contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        if (end > start) {
+            visitor(contents.substr(start, end - start));
+            count++;
+        }
+        start = end + 1;
+    }
+    return count;
+}
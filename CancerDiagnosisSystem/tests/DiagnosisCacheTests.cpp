@@ -0,0 +1,70 @@
+#include "../headers/DiagnosisCache.h"
+#include "TestSupport.h"
+
+namespace {
+
+DiagnosisCache::Key keyFor(const char* patientId, uint32_t modelId) {
+    return DiagnosisCache::Key{Symbol(patientId), modelId, 1, 1, 1};
+}
+
+// A score is hit only with the versions it was stored with; a change to
+// the patient, the gene table or the models misses
+void testVersionInvalidation() {
+    DiagnosisCache cache(16);
+    DiagnosisCache::Key key = keyFor("CACHE_P1", 0);
+    double score = 0.0;
+    CHECK(!cache.find(key, score));
+    cache.store(key, 0.42);
+    CHECK(cache.find(key, score) && score == 0.42);
+
+    DiagnosisCache::Key changed = key;
+    changed.patientRevision = 2;
+    CHECK(!cache.find(changed, score));
+    changed = key;
+    changed.tableVersion = 2;
+    CHECK(!cache.find(changed, score));
+    changed = key;
+    changed.modelVersion = 2;
+    CHECK(!cache.find(changed, score));
+    CHECK(!cache.find(keyFor("CACHE_P1", 1), score));
+
+    // Storing the new versions overwrites the slot; the old ones now miss
+    changed = key;
+    changed.patientRevision = 2;
+    cache.store(changed, 0.9);
+    CHECK(cache.find(changed, score) && score == 0.9);
+    CHECK(!cache.find(key, score));
+
+    DiagnosisCache::Stats stats = cache.getStats();
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 6);
+    CHECK(stats.entries == 1);
+}
+
+// A full shard drops its least recently used slot; clear drops all
+void testEviction() {
+    DiagnosisCache cache(2, 1);
+    double score = 0.0;
+    cache.store(keyFor("CACHE_A", 0), 0.1);
+    cache.store(keyFor("CACHE_B", 0), 0.2);
+    CHECK(cache.find(keyFor("CACHE_A", 0), score));
+    cache.store(keyFor("CACHE_C", 0), 0.3);
+
+    CHECK(cache.find(keyFor("CACHE_A", 0), score) && score == 0.1);
+    CHECK(!cache.find(keyFor("CACHE_B", 0), score));
+    CHECK(cache.find(keyFor("CACHE_C", 0), score) && score == 0.3);
+    CHECK(cache.getStats().entries == 2);
+    CHECK(cache.getStats().capacity == 2);
+
+    cache.clear();
+    CHECK(cache.getStats().entries == 0);
+    CHECK(!cache.find(keyFor("CACHE_A", 0), score));
+}
+
+} // namespace
+
+int main() {
+    testVersionInvalidation();
+    testEviction();
+    return testResult();
+}
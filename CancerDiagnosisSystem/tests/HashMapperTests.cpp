@@ -0,0 +1,93 @@
+#include "../headers/HashMapper.h"
+#include "TestSupport.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Mappings are found by string and by symbol; unknown mutations score 0
+void testInsertAndLookup() {
+    HashMapper mapper;
+    CHECK(mapper.size() == 0);
+    CHECK(mapper.getMutationId("BRCA1_c.68_69del") == HashMapper::kNoMutation);
+
+    HashMapper::MutationId brca = mapper.addMutationMapping("BRCA1_c.68_69del", 0.9);
+    HashMapper::MutationId tp53 = mapper.addMutationMapping(Symbol("TP53_R175H"), 0.7);
+    CHECK(brca != tp53);
+    CHECK(mapper.size() == 2);
+    CHECK(mapper.hasMutation("BRCA1_c.68_69del"));
+    CHECK(mapper.getMutationId(Symbol("TP53_R175H")) == tp53);
+    CHECK(mapper.getRiskScore("BRCA1_c.68_69del") == 0.9);
+    CHECK(mapper.getRiskScore(tp53) == 0.7);
+
+    CHECK(!mapper.hasMutation("KRAS_G12D"));
+    CHECK(mapper.getRiskScore("KRAS_G12D") == 0.0);
+    CHECK(mapper.getRiskScore("hash-mapper-never-interned") == 0.0);
+    CHECK(mapper.getRiskScore(HashMapper::kNoMutation) == 0.0);
+}
+
+// Adding a known mutation updates its score and keeps its ID
+void testUpdateExisting() {
+    HashMapper mapper;
+    HashMapper::MutationId id = mapper.addMutationMapping("EGFR_L858R", 0.4);
+    CHECK(mapper.addMutationMapping(Symbol("EGFR_L858R"), 0.6) == id);
+    CHECK(mapper.size() == 1);
+    CHECK(mapper.getRiskScore("EGFR_L858R") == 0.6);
+}
+
+// Every mapping survives the table growing well past its first slots,
+// with or without a reserve up front
+void testGrowth() {
+    for (bool reserveFirst : {false, true}) {
+        HashMapper mapper;
+        const size_t count = 5000;
+        if (reserveFirst) {
+            mapper.reserve(count);
+        }
+        std::vector<HashMapper::MutationId> ids;
+        for (size_t i = 0; i < count; ++i) {
+            ids.push_back(mapper.addMutationMapping("GROW_" + std::to_string(i), i * 0.001));
+        }
+        CHECK(mapper.size() == count);
+
+        bool allFound = true;
+        for (size_t i = 0; i < count; ++i) {
+            std::string key = "GROW_" + std::to_string(i);
+            allFound = allFound && mapper.getMutationId(key) == ids[i] &&
+                       mapper.getRiskScore(key) == i * 0.001;
+        }
+        CHECK(allFound);
+        CHECK(!mapper.hasMutation("GROW_" + std::to_string(count)));
+    }
+}
+
+// Batch lookup matches single lookups and rejects mismatched spans
+void testBatchScores() {
+    HashMapper mapper;
+    mapper.buildMutationMap({"M1", "M2", "M3"}, {0.1, 0.2, 0.3});
+    std::vector<HashMapper::MutationId> ids{mapper.getMutationId("M3"), HashMapper::kNoMutation,
+                                            mapper.getMutationId("M1")};
+    std::vector<double> scores(ids.size(), -1.0);
+    mapper.getRiskScores(ids, scores);
+    CHECK((scores == std::vector<double>{0.3, 0.0, 0.1}));
+
+    bool threw = false;
+    try {
+        std::vector<double> tooShort(1);
+        mapper.getRiskScores(ids, tooShort);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+} // namespace
+
+int main() {
+    testInsertAndLookup();
+    testUpdateExisting();
+    testGrowth();
+    testBatchScores();
+    return testResult();
+}
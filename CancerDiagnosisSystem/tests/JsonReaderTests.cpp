@@ -0,0 +1,131 @@
+#include "../headers/ApiRequests.h"
+#include "../headers/JsonReader.h"
+#include "TestSupport.h"
+#include <vector>
+
+namespace {
+
+// True if `text` is one well-formed value with nothing after it
+bool parses(std::string_view text) {
+    JsonReader reader(text);
+    return reader.skipValue() && reader.finish();
+}
+
+void testNumbers() {
+    for (const char* valid : {"0", "-0", "12", "-3.25", "1e3", "1E+2", "2.5e-3"}) {
+        CHECK(parses(valid));
+    }
+    for (const char* invalid : {"01", "+1", "1.", ".5", "1e", "-", "0x10", "NaN", "Infinity"}) {
+        if (parses(invalid)) {
+            std::cerr << "accepted invalid number " << invalid << "\n";
+            testFailures()++;
+        }
+    }
+
+    JsonReader big("1e400");
+    double value = 0.0;
+    CHECK(!big.readNumber(value));
+    CHECK(big.getError().find("out of range") != std::string::npos);
+
+    // Numbers sent as strings are accepted
+    JsonReader quoted("\"42.5\"");
+    CHECK(quoted.readNumber(value) && value == 42.5);
+    for (const char* nonFinite : {"\"nan\"", "\"inf\"", "\"-Infinity\"", "\"1e400\""}) {
+        JsonReader reader(nonFinite);
+        CHECK(!reader.readNumber(value));
+    }
+
+    int whole = 0;
+    JsonReader fraction("1.5");
+    CHECK(!fraction.readInt(whole));
+    JsonReader overflow("3000000000");
+    CHECK(!overflow.readInt(whole));
+    JsonReader exact("-7");
+    CHECK(exact.readInt(whole) && whole == -7);
+}
+
+void testStrings() {
+    std::string out;
+    JsonReader plain("\"abc\"");
+    CHECK(plain.readString(out) && out == "abc");
+
+    JsonReader escaped(R"("a\"b\\c\/\n\té😀")");
+    CHECK(escaped.readString(out));
+    CHECK(out == "a\"b\\c/\n\t\xc3\xa9\xf0\x9f\x98\x80");
+
+    for (const char* invalid : {R"("\x")", R"("\u12")", R"("\ud83d")", R"("\ude00")", R"("\ud83dx")",
+                                "\"open", "\"tab\there\""}) {
+        JsonReader reader(invalid);
+        if (reader.readString(out)) {
+            std::cerr << "accepted invalid string " << invalid << "\n";
+            testFailures()++;
+        }
+    }
+}
+
+void testStructure() {
+    CHECK(parses(" { \"a\" : [1, true, null, {\"b\": []}], \"c\": \"d\" } "));
+    CHECK(parses("[]"));
+    CHECK(parses("{}"));
+    for (const char* invalid : {"[1,]", "{\"a\":1,}", "{\"a\" 1}", "{a:1}", "[1 2]", "[", "{\"a\":1} x", "",
+                                "tru", "nul"}) {
+        if (parses(invalid)) {
+            std::cerr << "accepted invalid document " << invalid << "\n";
+            testFailures()++;
+        }
+    }
+
+    std::string nested(JsonReader::kMaxDepth, '[');
+    nested += std::string(JsonReader::kMaxDepth, ']');
+    CHECK(parses(nested));
+    CHECK(!parses("[" + nested + "]"));
+
+    // Members arrive in order, with escaped keys decoded
+    JsonReader reader(R"({"x": 1, "key": "v", "skip": {"deep": [1, 2]}})");
+    std::vector<std::string> keys;
+    CHECK(reader.readObject([&](std::string_view key) {
+        keys.emplace_back(key);
+        return reader.skipValue();
+    }));
+    CHECK((keys == std::vector<std::string>{"x", "key", "skip"}));
+
+    // The first error sticks and reports where it happened
+    JsonReader broken("[1, ?]");
+    CHECK(!broken.skipValue());
+    CHECK(!broken.ok());
+    CHECK(broken.getError().find("offset 4") != std::string::npos);
+    CHECK(!broken.readNull());
+}
+
+void testQueueDeadline() {
+    std::string error;
+    QueueRequest request;
+    CHECK(request.parse(R"({"patient_id":"P1","deadline_ms":2000})", error));
+    CHECK(request.deadline == std::chrono::milliseconds(2000));
+
+    QueueRequest capped;
+    CHECK(capped.parse(R"({"patient_id":"P1","deadline_ms":1e12})", error));
+    CHECK(capped.deadline == testPriorityBudget(TestPriority::LOW));
+
+    QueueRequest negative;
+    CHECK(!negative.parse(R"({"patient_id":"P1","deadline_ms":-1})", error));
+    CHECK(error.find("deadline_ms") != std::string::npos);
+
+    // Not numbers at all, so the reader rejects them before the deadline check
+    for (const char* invalid : {R"({"deadline_ms":"nan"})", R"({"deadline_ms":"inf"})"}) {
+        QueueRequest rejected;
+        error.clear();
+        CHECK(!rejected.parse(invalid, error));
+        CHECK(error.find("Expected a number") != std::string::npos);
+    }
+}
+
+} // namespace
+
+int main() {
+    testNumbers();
+    testStrings();
+    testStructure();
+    testQueueDeadline();
+    return testResult();
+}
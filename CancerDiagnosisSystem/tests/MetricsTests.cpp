@@ -0,0 +1,119 @@
+#include "../headers/Metrics.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using std::chrono::nanoseconds;
+
+bool hasLine(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+// Durations fall in buckets whose limits are their exclusive upper bounds
+void testBuckets() {
+    CHECK(LatencyHistogram::bucketFor(0) == 0);
+    CHECK(LatencyHistogram::bucketFor(7) == 7);
+    CHECK(LatencyHistogram::bucketLimitMicros(7) == 8);
+    bool bounded = true;
+    for (uint64_t micros : {8u, 9u, 15u, 16u, 17u, 100u, 999u, 1000u, 123456u, 60000000u}) {
+        size_t bucket = LatencyHistogram::bucketFor(micros);
+        bounded = bounded && micros < LatencyHistogram::bucketLimitMicros(bucket) &&
+                  (bucket == 0 || micros >= LatencyHistogram::bucketLimitMicros(bucket - 1));
+    }
+    CHECK(bounded);
+    CHECK(LatencyHistogram::bucketFor(UINT64_MAX) == LatencyHistogram::kBucketCount - 1);
+}
+
+// Each le bucket counts exactly the durations below its bound, bounds sit
+// on recorded bucket edges, and +Inf, _count and _sum cover everything
+void testHistogramOutput() {
+    Metrics metrics;
+    LatencyHistogram& latency = metrics.histogram("test_latency_seconds", "route=\"/x\"", "Request time");
+    const std::vector<uint64_t> recordedNanos{5000, 10000, 10500, 11000, 30000, 2000000, 90000000000};
+    uint64_t sumNanos = 0;
+    for (uint64_t nanos : recordedNanos) {
+        latency.record(nanoseconds(nanos));
+        sumNanos += nanos;
+    }
+    latency.record(nanoseconds(-5)); // Counted as zero
+
+    std::string text;
+    metrics.render(text);
+    CHECK(hasLine(text, "# HELP test_latency_seconds Request time"));
+    CHECK(hasLine(text, "# TYPE test_latency_seconds histogram"));
+    CHECK(hasLine(text, "test_latency_seconds_bucket{route=\"/x\",le=\"1.1e-05\"} 4"));
+    CHECK(hasLine(text, "test_latency_seconds_bucket{route=\"/x\",le=\"2.6e-05\"} 5"));
+    CHECK(hasLine(text, "test_latency_seconds_bucket{route=\"/x\",le=\"+Inf\"} 8"));
+    CHECK(hasLine(text, "test_latency_seconds_count{route=\"/x\"} 8"));
+
+    const std::string bucketPrefix = "test_latency_seconds_bucket{route=\"/x\",le=\"";
+    std::istringstream lines(text);
+    std::string line;
+    size_t bounds = 0;
+    uint64_t previous = 0;
+    bool exact = true;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, bucketPrefix.size(), bucketPrefix) == 0) {
+            size_t quote = line.find('"', bucketPrefix.size());
+            std::string bound = line.substr(bucketPrefix.size(), quote - bucketPrefix.size());
+            uint64_t count = std::stoull(line.substr(line.rfind(' ') + 1));
+            exact = exact && count >= previous;
+            previous = count;
+            if (bound == "+Inf") {
+                continue;
+            }
+            uint64_t limitMicros = static_cast<uint64_t>(std::llround(std::stod(bound) * 1e6));
+            exact = exact && LatencyHistogram::bucketLimitMicros(LatencyHistogram::bucketFor(limitMicros - 1)) ==
+                                 limitMicros;
+            uint64_t below = 1; // The negative duration
+            for (uint64_t nanos : recordedNanos) {
+                below += nanos / 1000 < limitMicros ? 1 : 0;
+            }
+            exact = exact && count == below;
+            ++bounds;
+        } else if (line.rfind("test_latency_seconds_sum{route=\"/x\"} ", 0) == 0) {
+            double sum = std::stod(line.substr(line.rfind(' ') + 1));
+            exact = exact && std::fabs(sum - sumNanos / 1e9) < 1e-9;
+        }
+    }
+    CHECK(exact);
+    CHECK(bounds == 21);
+}
+
+// Families render in name order with their series in registration order;
+// registering again returns the same metric
+void testCountersAndGauges() {
+    Metrics metrics;
+    Counter& requests = metrics.counter("test_requests_total", "code=\"200\"", "Requests");
+    CHECK(&metrics.counter("test_requests_total", "code=\"200\"", "Requests") == &requests);
+    requests.increment();
+    requests.increment(2);
+    metrics.counter("test_requests_total", "code=\"404\"", "Requests").increment();
+    metrics.gauge("test_depth", "", "Depth").set(1.5);
+    metrics.gauge("test_callback", "", "Read on render", []() { return 7.0; });
+
+    std::string text;
+    metrics.render(text);
+    CHECK(hasLine(text, "test_requests_total{code=\"200\"} 3"));
+    CHECK(hasLine(text, "test_requests_total{code=\"404\"} 1"));
+    CHECK(hasLine(text, "# TYPE test_requests_total counter"));
+    CHECK(hasLine(text, "test_depth 1.5"));
+    CHECK(hasLine(text, "test_callback 7"));
+    CHECK(text.find("test_callback") < text.find("test_depth"));
+    CHECK(text.find("code=\"200\"") < text.find("code=\"404\""));
+}
+
+} // namespace
+
+int main() {
+    testBuckets();
+    testHistogramOutput();
+    testCountersAndGauges();
+    return testResult();
+}
@@ -0,0 +1,108 @@
+#include "../headers/MpmcQueue.h"
+#include "TestSupport.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One thread: FIFO order, full and empty failures, and reuse of slots
+// over many laps of the ring
+void testSingleThread() {
+    MpmcQueue<uint32_t> queue(5);
+    CHECK(queue.capacity() == 8);
+    CHECK(queue.empty());
+
+    uint32_t value = 0;
+    CHECK(!queue.tryPop(value));
+    for (uint32_t i = 0; i < 8; ++i) {
+        CHECK(queue.tryPush(i));
+    }
+    CHECK(!queue.tryPush(8));
+    CHECK(queue.size() == 8);
+
+    std::vector<uint32_t> visited;
+    queue.forEach([&visited](uint32_t queued) { visited.push_back(queued); });
+    CHECK((visited == std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7}));
+
+    bool inOrder = true;
+    for (uint32_t i = 0; i < 8; ++i) {
+        inOrder = inOrder && queue.tryPop(value) && value == i;
+    }
+    CHECK(inOrder);
+    CHECK(!queue.tryPop(value));
+
+    bool lapsOk = true;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        lapsOk = lapsOk && queue.tryPush(i) && queue.tryPush(i + 1) &&
+                 queue.tryPop(value) && value == i && queue.tryPop(value) && value == i + 1;
+    }
+    CHECK(lapsOk);
+    CHECK(queue.empty());
+}
+
+// Several producers and consumers on a small ring: every value arrives
+// exactly once, and each consumer sees each producer's values in order
+void testProducersAndConsumers() {
+    const uint32_t producerCount = 4;
+    const uint32_t consumerCount = 4;
+    const uint32_t perProducer = 50000;
+    MpmcQueue<uint32_t> queue(64);
+
+    // Values carry the producer in the top byte and a sequence number below
+    std::vector<std::atomic<uint32_t>> received(producerCount * perProducer);
+    std::atomic<uint32_t> popped{0};
+    std::atomic<bool> ordered{true};
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producerCount; ++p) {
+        threads.emplace_back([&queue, p, perProducer]() {
+            for (uint32_t i = 0; i < perProducer; ++i) {
+                while (!queue.tryPush((p << 24) | i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (uint32_t c = 0; c < consumerCount; ++c) {
+        threads.emplace_back([&]() {
+            std::vector<int64_t> last(producerCount, -1);
+            uint32_t value = 0;
+            while (popped.load() < producerCount * perProducer) {
+                if (!queue.tryPop(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                uint32_t producer = value >> 24;
+                uint32_t sequence = value & 0xffffff;
+                if (static_cast<int64_t>(sequence) <= last[producer]) {
+                    ordered = false;
+                }
+                last[producer] = sequence;
+                received[producer * perProducer + sequence].fetch_add(1);
+                popped.fetch_add(1);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    bool exactlyOnce = true;
+    for (const std::atomic<uint32_t>& count : received) {
+        exactlyOnce = exactlyOnce && count.load() == 1;
+    }
+    CHECK(exactlyOnce);
+    CHECK(ordered);
+    CHECK(popped.load() == producerCount * perProducer);
+    CHECK(queue.empty());
+}
+
+} // namespace
+
+int main() {
+    testSingleThread();
+    testProducersAndConsumers();
+    return testResult();
+}
@@ -0,0 +1,162 @@
+#include "../headers/PatientStore.h"
+#include "../headers/CancerDiagnosisSystem.h"
+#include "TestSupport.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> idsInOrder(const PatientStore& store) {
+    std::vector<std::string> ids;
+    for (const Patient& patient : store) {
+        ids.push_back(patient.getPatientId());
+    }
+    return ids;
+}
+
+// New IDs are appended; a known ID (ignoring surrounding whitespace)
+// replaces its record in place
+void testUpsertAndOrder() {
+    PatientStore store;
+    CHECK(store.empty());
+    CHECK(store.upsert(Patient("A1", "Ann", 30)));
+    CHECK(store.upsert(Patient("B2", "Bob", 40)));
+    CHECK(store.upsert(Patient("C3", "Cy", 50)));
+    CHECK(!store.upsert(Patient(" B2 ", "Bob Ray", 41)));
+    CHECK(store.size() == 3);
+    CHECK((idsInOrder(store) == std::vector<std::string>{"A1", " B2 ", "C3"}));
+
+    const Patient* replaced = store.find("B2");
+    CHECK(replaced != nullptr && replaced->getName() == "Bob Ray" && replaced->getAge() == 41);
+    CHECK(store.find("\tB2\n") == replaced);
+    CHECK(store.positionOf(*replaced) == 1);
+    CHECK(store.contains("C3"));
+    CHECK(!store.contains("D4"));
+    CHECK(!store.contains("never-interned-patient-id"));
+
+    // History order is the reverse of insertion order
+    std::vector<std::string> history;
+    for (auto it = store.rbegin(); it != store.rend(); ++it) {
+        history.push_back(it->getPatientId());
+    }
+    CHECK((history == std::vector<std::string>{"C3", " B2 ", "A1"}));
+
+    // Records upserted from outside the store are copied into its epoch
+    Patient outside("D4", "Dee", 60);
+    outside.addGeneticData(GeneticData("G1", 0.5, 1));
+    CHECK(store.upsert(outside));
+    CHECK(store.find("D4")->getGeneticData().size() == 1);
+    CHECK(outside.getGeneticData().size() == 1);
+
+    store.clear();
+    CHECK(store.empty());
+    CHECK(!store.contains("A1"));
+    CHECK(store.upsert(Patient("A1", "Ann", 30)));
+    CHECK(store.size() == 1);
+}
+
+// swap exchanges whole stores, index included
+void testSwap() {
+    PatientStore first;
+    PatientStore second;
+    first.upsert(Patient("S1", "One", 20));
+    second.upsert(Patient("S2", "Two", 21));
+    second.upsert(Patient("S3", "Three", 22));
+    first.swap(second);
+    CHECK(first.size() == 2 && first.contains("S3") && !first.contains("S1"));
+    CHECK(second.size() == 1 && second.contains("S1"));
+}
+
+// Replacing a record gives it a new revision; revisions are never reused,
+// even by another store, and follow their records through swap
+void testRevisions() {
+    PatientStore first;
+    first.upsert(Patient("R1", "One", 20));
+    first.upsert(Patient("R2", "Two", 21));
+    uint64_t one = first.revisionOf(*first.find("R1"));
+    uint64_t two = first.revisionOf(*first.find("R2"));
+    CHECK(one != two);
+
+    first.upsert(Patient("R1", "One Again", 20));
+    uint64_t replaced = first.revisionOf(*first.find("R1"));
+    CHECK(replaced != one && replaced != two);
+    CHECK(first.revisionOf(*first.find("R2")) == two);
+
+    PatientStore second;
+    second.upsert(Patient("R1", "Other One", 20));
+    uint64_t other = second.revisionOf(*second.find("R1"));
+    CHECK(other != one && other != two && other != replaced);
+
+    first.swap(second);
+    CHECK(first.revisionOf(*first.find("R1")) == other);
+    CHECK(second.revisionOf(*second.find("R1")) == replaced);
+}
+
+struct StoredPatient {
+    std::string name;
+    int age = 0;
+    std::vector<std::string> geneIds;
+};
+
+StoredPatient storedPatient(const CancerDiagnosisSystem& system, const std::string& patientId) {
+    StoredPatient stored;
+    Patient patient;
+    CHECK(system.getPatientById(patientId, patient));
+    stored.name = patient.getName();
+    stored.age = patient.getAge();
+    for (const auto& data : patient.getGeneticData()) {
+        stored.geneIds.push_back(data.getGeneId());
+    }
+    return stored;
+}
+
+bool operator==(const StoredPatient& a, const StoredPatient& b) {
+    return a.name == b.name && a.age == b.age && a.geneIds == b.geneIds;
+}
+
+// Rewriting the patients file keeps a repeated ID's rows, so every patient
+// still draws the same genes from the table after a reload
+void testRewriteKeepsRepeatedIds() {
+    std::string genes = testPath("dup-genes.csv");
+    std::string patients = testPath("dup-patients.csv");
+    writeFile(genes, "Gene_ID,Mutation_Score,Label\n"
+                     "G1,0.1000,0\nG2,0.9000,1\nG3,0.2000,0\nG4,0.8000,1\n"
+                     "G5,0.3000,0\nG6,0.7000,1\nG7,0.4000,0\n");
+    writeFile(patients, "Patient_ID,Name,Age\nP1,Ann,30\nP2,Bob,40\nP1,Ann Lee,31\nP3,Cy,50\n");
+
+    std::vector<std::string> ids{"P1", "P2", "P3"};
+    std::vector<StoredPatient> before;
+    {
+        CancerDiagnosisSystem system;
+        system.loadData(genes, patients);
+        CHECK(system.getPatientCount() == 3);
+        for (const auto& id : ids) {
+            before.push_back(storedPatient(system, id));
+        }
+        CHECK(before[0].name == "Ann Lee"); // The later row wins
+        system.saveDataToFiles(genes, patients);
+    }
+    CHECK(readFile(patients) == "Patient_ID,Name,Age\nP1,Ann Lee,31\nP2,Bob,40\nP1,Ann Lee,31\nP3,Cy,50\n");
+
+    CancerDiagnosisSystem system;
+    system.loadData(genes, patients);
+    CHECK(system.getPatientCount() == 3);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        CHECK(storedPatient(system, ids[i]) == before[i]);
+    }
+
+    for (const std::string& path : {genes, patients, genes + ".commit"}) {
+        std::remove(path.c_str());
+    }
+}
+
+} // namespace
+
+int main() {
+    testUpsertAndOrder();
+    testSwap();
+    testRevisions();
+    testRewriteKeepsRepeatedIds();
+    return testResult();
+}
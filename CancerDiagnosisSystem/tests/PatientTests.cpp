@@ -0,0 +1,80 @@
+#include "../headers/Patient.h"
+#include "TestSupport.h"
+#include <memory>
+#include <memory_resource>
+
+namespace {
+
+bool sameRecords(GeneticDataView data) {
+    return data.size() == 2 &&
+           data[0].getGeneId() == "ROW_GENE_A" && data[0].getMutationScore() == 0.25 &&
+           data[0].getLabel() == 0 &&
+           data[1].getGeneId() == "ROW_GENE_B" && data[1].getMutationScore() == 0.75 &&
+           data[1].getLabel() == 1;
+}
+
+// Rows are read through the table until a plain copy resolves them into
+// owned records that outlive the table
+void testPlainCopyDetaches() {
+    auto table = std::make_unique<GeneticDataTable>();
+    size_t rowA = table->append(Symbol("ROW_GENE_A"), 0.25, 0);
+    size_t rowB = table->append(Symbol("ROW_GENE_B"), 0.75, 1);
+
+    Patient patient("ROW_P1", "Row Patient", 60);
+    patient.addGeneticDataRow(*table, rowA);
+    patient.addGeneticDataRow(*table, rowB);
+    CHECK(patient.getGeneTable() == table.get());
+    CHECK(patient.getGeneRows().size() == 2);
+    CHECK(sameRecords(patient.getGeneticData()));
+
+    Patient copied(patient);
+    Patient assigned;
+    assigned = patient;
+    CHECK(copied.getGeneTable() == nullptr && copied.getGeneRows().empty());
+    CHECK(assigned.getGeneTable() == nullptr && assigned.getGeneRows().empty());
+
+    table.reset();
+    CHECK(sameRecords(copied.getGeneticData()));
+    CHECK(sameRecords(assigned.getGeneticData()));
+    CHECK(copied.getPatientId() == "ROW_P1" && copied.getName() == "Row Patient");
+}
+
+// Allocator-extended copies and moves keep referring to the table
+void testAllocatorCopyKeepsRows() {
+    GeneticDataTable table;
+    table.append(Symbol("ROW_GENE_A"), 0.25, 0);
+    table.append(Symbol("ROW_GENE_B"), 0.75, 1);
+    Patient patient("ROW_P2", "Row Patient", 61);
+    patient.addGeneticDataRow(table, 0);
+    patient.addGeneticDataRow(table, 1);
+
+    std::pmr::monotonic_buffer_resource arena;
+    Patient placed(patient, Patient::allocator_type(&arena));
+    CHECK(placed.getGeneTable() == &table);
+    CHECK(sameRecords(placed.getGeneticData()));
+
+    Patient moved(std::move(placed));
+    CHECK(moved.getGeneTable() == &table);
+    CHECK(sameRecords(moved.getGeneticData()));
+}
+
+// A row added to a patient that already owns records is copied in
+void testRowAfterOwnedRecords() {
+    GeneticDataTable table;
+    size_t row = table.append(Symbol("ROW_GENE_B"), 0.75, 1);
+    Patient patient("ROW_P3", "Row Patient", 62);
+    patient.addGeneticData(GeneticData("ROW_GENE_A", 0.25, 0));
+    patient.addGeneticDataRow(table, row);
+    CHECK(patient.getGeneTable() == nullptr);
+    table.clear();
+    CHECK(sameRecords(patient.getGeneticData()));
+}
+
+} // namespace
+
+int main() {
+    testPlainCopyDetaches();
+    testAllocatorCopyKeepsRows();
+    testRowAfterOwnedRecords();
+    return testResult();
+}
@@ -0,0 +1,81 @@
+#include "../headers/ResponseCache.h"
+#include "TestSupport.h"
+#include <memory>
+#include <string>
+
+namespace {
+
+ResponseCache::Response response(const std::string& body) {
+    ResponseCache::Response built;
+    built.body = body;
+    built.contentType = "application/json";
+    return built;
+}
+
+// ETags are quoted and name the process, the data version and the variant
+void testMakeETag() {
+    CHECK(ResponseCache::makeETag("abc", 7, "") == "\"abc-7\"");
+    CHECK(ResponseCache::makeETag("abc", 7, "csv") == "\"abc-7-csv\"");
+    CHECK(ResponseCache::makeETag("abc", 7, "") != ResponseCache::makeETag("xyz", 7, ""));
+}
+
+// If-None-Match lists match on any exact entry, "*" or a weak validator
+void testETagMatching() {
+    const std::string etag = ResponseCache::makeETag("abc", 7, "");
+    CHECK(ResponseCache::etagMatches(etag, etag));
+    CHECK(ResponseCache::etagMatches("\"abc-6\", " + etag, etag));
+    CHECK(ResponseCache::etagMatches(" \"abc-6\" ,\t" + etag + " ", etag));
+    CHECK(ResponseCache::etagMatches("W/" + etag, etag));
+    CHECK(ResponseCache::etagMatches("*", etag));
+
+    CHECK(!ResponseCache::etagMatches("", etag));
+    CHECK(!ResponseCache::etagMatches("\"abc-6\"", etag));
+    CHECK(!ResponseCache::etagMatches("abc-7", etag));
+    CHECK(!ResponseCache::etagMatches("\"abc-7-csv\"", etag));
+    CHECK(!ResponseCache::etagMatches("\"xyz-7\"", etag));
+    CHECK(!ResponseCache::etagMatches(",,", etag));
+}
+
+// Entries are hit only at the version they were stored at, and a slower
+// request cannot overwrite a newer entry with an older one
+void testVersions() {
+    ResponseCache cache(4, 1024);
+    CHECK(cache.find("/status", 1) == nullptr);
+    cache.store("/status", 1, response("v1"));
+    std::shared_ptr<const ResponseCache::Response> hit = cache.find("/status", 1);
+    CHECK(hit && hit->body == "v1");
+    CHECK(cache.find("/status", 2) == nullptr);
+    CHECK(cache.getHits() == 1 && cache.getMisses() == 2);
+
+    cache.store("/status", 3, response("v3"));
+    std::shared_ptr<const ResponseCache::Response> stale = cache.store("/status", 2, response("v2"));
+    CHECK(stale->body == "v2");
+    CHECK(cache.find("/status", 2) == nullptr);
+    CHECK(cache.find("/status", 3) && cache.find("/status", 3)->body == "v3");
+}
+
+// A full cache drops older versions first; oversized bodies are returned
+// for sending but not kept
+void testLimits() {
+    ResponseCache cache(2, 8);
+    cache.store("/a", 1, response("a"));
+    cache.store("/b", 2, response("b"));
+    cache.store("/c", 2, response("c"));
+    CHECK(cache.find("/a", 1) == nullptr);
+    CHECK(cache.find("/b", 2) != nullptr);
+    CHECK(cache.find("/c", 2) != nullptr);
+
+    std::shared_ptr<const ResponseCache::Response> big = cache.store("/big", 2, response("123456789"));
+    CHECK(big && big->body == "123456789");
+    CHECK(cache.find("/big", 2) == nullptr);
+}
+
+} // namespace
+
+int main() {
+    testMakeETag();
+    testETagMatching();
+    testVersions();
+    testLimits();
+    return testResult();
+}
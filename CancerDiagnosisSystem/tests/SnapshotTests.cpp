@@ -0,0 +1,207 @@
+#include "../headers/Snapshot.h"
+#include "../headers/CancerDiagnosisSystem.h"
+#include "TestSupport.h"
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Values of several kinds, with a placeholder filled in afterwards
+std::string writeSample() {
+    SnapshotWriter writer;
+    writer.write<uint32_t>(7);
+    writer.writeString("genes.csv");
+    writer.writeArray(std::vector<double>{1.5, -2.25, 3.0});
+    writer.writeArray(std::vector<uint32_t>{});
+    size_t stamp = writer.position();
+    writer.write<uint64_t>(0);
+    writer.writeString("");
+    writer.overwrite<uint64_t>(stamp, 42);
+
+    std::string path = testPath("sample.cds");
+    CHECK(writer.saveToFile(path));
+    return path;
+}
+
+void testRoundTrip() {
+    std::string path = writeSample();
+    SnapshotReader reader;
+    std::string error;
+    CHECK(reader.open(path, error));
+    CHECK(error.empty());
+    CHECK(reader.read<uint32_t>() == 7);
+    CHECK(reader.readString() == "genes.csv");
+    CHECK((reader.readArray<double>() == std::vector<double>{1.5, -2.25, 3.0}));
+    CHECK(reader.readArray<uint32_t>().empty());
+    CHECK(reader.read<uint64_t>() == 42);
+    CHECK(reader.readString().empty());
+
+    bool threw = false;
+    try {
+        reader.read<uint32_t>();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    std::remove(path.c_str());
+}
+
+void expectOpenError(const std::string& path, const std::string& expected) {
+    SnapshotReader reader;
+    std::string error;
+    CHECK(!reader.open(path, error));
+    if (error.find(expected) == std::string::npos) {
+        std::cerr << "expected \"" << expected << "\", got \"" << error << "\"\n";
+        testFailures()++;
+    }
+}
+
+void testDamagedFiles() {
+    std::string path = writeSample();
+    std::string contents = readFile(path);
+
+    std::string corrupt = contents;
+    corrupt.back() ^= 0x01;
+    writeFile(path, corrupt);
+    expectOpenError(path, "checksum mismatch");
+
+    writeFile(path, contents.substr(0, contents.size() - 1));
+    expectOpenError(path, "truncated");
+
+    writeFile(path, contents.substr(0, sizeof(SnapshotHeader) - 1));
+    expectOpenError(path, "too small");
+
+    std::string foreign = contents;
+    foreign[0] = 'X';
+    writeFile(path, foreign);
+    expectOpenError(path, "not a snapshot");
+
+    std::remove(path.c_str());
+    expectOpenError(path, "cannot open");
+}
+
+// A length that runs past the payload is caught before anything is copied
+void testOversizedArray() {
+    SnapshotWriter writer;
+    writer.write<uint64_t>(1000);
+    std::string path = testPath("oversized.cds");
+    CHECK(writer.saveToFile(path));
+
+    SnapshotReader reader;
+    std::string error;
+    CHECK(reader.open(path, error));
+    bool threw = false;
+    try {
+        reader.readArray<double>();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    std::remove(path.c_str());
+}
+
+using ModelType = CancerDiagnosisSystem::ModelType;
+
+// Everything a snapshot restores, as comparable text (scores to full precision)
+std::vector<std::string> describeSystem(const CancerDiagnosisSystem& system) {
+    std::vector<std::string> lines;
+    auto line = [&]() -> std::ostringstream {
+        std::ostringstream out;
+        out << std::setprecision(17);
+        return out;
+    };
+
+    for (const GeneticData& data : system.getAllGeneticData()) {
+        auto out = line();
+        out << "gene " << data.getGeneId() << ' ' << data.getMutationScore() << ' ' << data.getLabel();
+        lines.push_back(out.str());
+        system.visitMutationMapper([&](const HashMapper& mapper) {
+            auto mapped = line();
+            mapped << "mapped " << data.getGeneId() << ' ' << mapper.getRiskScore(data.getGeneId());
+            lines.push_back(mapped.str());
+        });
+    }
+    system.visitMutationMapper([&](const HashMapper& mapper) {
+        lines.push_back("mappings " + std::to_string(mapper.size()));
+    });
+
+    for (const Patient& patient : system.getAllPatients()) {
+        auto out = line();
+        out << "patient " << patient.getPatientId() << ' ' << patient.getName() << ' ' << patient.getAge()
+            << ' ' << patient.getRiskScore() << ' ' << patient.getPrediction();
+        for (const auto& data : patient.getGeneticData()) {
+            out << ' ' << data.getGeneId() << ':' << data.getMutationScore() << ':' << data.getLabel();
+        }
+        lines.push_back(out.str());
+        for (ModelType model : {ModelType::LOGISTIC, ModelType::KNN, ModelType::DECISION_TREE, 
+                                ModelType::NAIVE_BAYES}) {
+            auto result = system.diagnoseStoredPatient(patient.getPatientId(), model);
+            CHECK(result.has_value());
+            auto diagnosis = line();
+            diagnosis << "diagnosis " << patient.getPatientId() << ' ' << CancerDiagnosisSystem::modelName(model)
+                      << ' ' << result->riskScore << ' ' << result->prediction;
+            lines.push_back(diagnosis.str());
+        }
+    }
+    return lines;
+}
+
+// A system restored from a snapshot matches the one that saved it: gene
+// table, mutation map, patients (loaded, repeated and added ones) and the
+// diagnoses of its trained models. Changing a CSV afterwards makes the
+// snapshot stale.
+void testSystemRoundTrip() {
+    std::string genes = testPath("system-genes.csv");
+    std::string patients = testPath("system-patients.csv");
+    std::string snapshot = testPath("system.cds");
+    writeFile(genes, "Gene_ID,Mutation_Score,Label\n"
+                     "G1,0.1000,0\nG2,0.9000,1\nG3,0.2000,0\nG4,0.8000,1\nG5,0.3000,0\n"
+                     "G6,0.7000,1\nG7,0.4000,0\nG8,0.6000,1\nG2,0.9500,1\n");
+    writeFile(patients, "Patient_ID,Name,Age\nP1,Ann,30\nP2,Bob,70\nP1,Ann Lee,31\nP3,Cy,50\n");
+
+    std::vector<std::string> saved;
+    {
+        CancerDiagnosisSystem system;
+        system.loadData(genes, patients);
+        CHECK(system.areModelsTrained());
+        Patient added("P4", "Dee", 45);
+        added.addGeneticData(GeneticData("G9", 0.55, 1));
+        system.addPatient(added);
+        saved = describeSystem(system);
+        CHECK(system.saveSnapshot(snapshot));
+    }
+    CHECK(saved.size() > 20);
+
+    {
+        CancerDiagnosisSystem system;
+        CHECK(system.loadSnapshot(snapshot, genes, patients));
+        CHECK(system.areModelsTrained());
+        CHECK(describeSystem(system) == saved);
+    }
+
+    // Stale once a source file changes, and only for the files it was built from
+    writeFile(patients, readFile(patients) + "P5,Eve,60\n");
+    {
+        CancerDiagnosisSystem system;
+        CHECK(!system.loadSnapshot(snapshot, genes, patients));
+        CHECK(!system.loadSnapshot(snapshot, patients, genes));
+        CHECK(system.getPatientCount() == 0);
+    }
+
+    for (const std::string& path : {genes, patients, snapshot}) {
+        std::remove(path.c_str());
+    }
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testDamagedFiles();
+    testOversizedArray();
+    testSystemRoundTrip();
+    return testResult();
+}
@@ -0,0 +1,85 @@
+#include "../headers/StringInterner.h"
+#include "TestSupport.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Equal strings intern to the same symbol and round trip through str()
+void testInternAndLookup() {
+    StringInterner& interner = StringInterner::global();
+    Symbol gene = interner.intern("GENE_INTERN_1");
+    CHECK(!gene.empty());
+    CHECK(Symbol("GENE_INTERN_1") == gene);
+    CHECK(Symbol(std::string("GENE_INTERN_2")) != gene);
+    CHECK(gene.str() == "GENE_INTERN_1");
+    CHECK(interner.lookup(gene) == "GENE_INTERN_1");
+
+    Symbol found;
+    CHECK(interner.find("GENE_INTERN_1", found) && found == gene);
+    CHECK(!interner.find("interner-never-interned", found));
+}
+
+// The default symbol is the empty string
+void testEmptySymbol() {
+    Symbol none;
+    CHECK(none.empty());
+    CHECK(none.str().empty());
+    CHECK(Symbol("") == none);
+}
+
+// Strings interned past the first chunk keep their IDs and text
+void testChunkGrowth() {
+    StringInterner& interner = StringInterner::global();
+    size_t before = interner.size();
+    const size_t count = 5000;
+    std::vector<Symbol> symbols;
+    for (size_t i = 0; i < count; ++i) {
+        symbols.push_back(interner.intern("CHUNK_" + std::to_string(i)));
+    }
+    CHECK(interner.size() == before + count);
+
+    bool allMatch = true;
+    for (size_t i = 0; i < count; ++i) {
+        std::string text = "CHUNK_" + std::to_string(i);
+        allMatch = allMatch && symbols[i].str() == text && Symbol(text) == symbols[i];
+    }
+    CHECK(allMatch);
+    CHECK(interner.size() == before + count);
+}
+
+// Threads interning the same strings at once agree on every symbol
+void testConcurrentIntern() {
+    const size_t threadCount = 4;
+    const size_t count = 2000;
+    std::vector<std::vector<Symbol>> results(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&results, t, count]() {
+            for (size_t i = 0; i < count; ++i) {
+                results[t].push_back(Symbol("SHARED_" + std::to_string(i)));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    bool agree = true;
+    for (size_t t = 1; t < threadCount; ++t) {
+        agree = agree && results[t] == results[0];
+    }
+    CHECK(agree);
+    CHECK(results[0][count - 1].str() == "SHARED_" + std::to_string(count - 1));
+}
+
+} // namespace
+
+int main() {
+    testInternAndLookup();
+    testEmptySymbol();
+    testChunkGrowth();
+    testConcurrentIntern();
+    return testResult();
+}
@@ -0,0 +1,100 @@
+#include "../headers/TestScheduler.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<uint32_t> drain(TestScheduler<uint32_t>& scheduler) {
+    std::vector<uint32_t> order;
+    uint32_t value = 0;
+    while (scheduler.pop(value)) {
+        order.push_back(value);
+    }
+    return order;
+}
+
+std::vector<uint32_t> waiting(const TestScheduler<uint32_t>& scheduler) {
+    std::vector<uint32_t> order;
+    scheduler.forEach([&order](uint32_t value) { order.push_back(value); });
+    return order;
+}
+
+// FIFO mode dispatches in arrival order whatever the class, and rejects
+// tests once every entry is in use
+void testFifoOrder() {
+    TestScheduler<uint32_t> scheduler(4, SchedulingMode::FIFO);
+    CHECK(scheduler.push(1, TestPriority::LOW));
+    CHECK(scheduler.push(2, TestPriority::URGENT));
+    CHECK(scheduler.push(3, TestPriority::NORMAL));
+    CHECK(scheduler.push(4, TestPriority::URGENT));
+    CHECK(!scheduler.push(5, TestPriority::URGENT));
+    CHECK(scheduler.size() == 4);
+    CHECK(scheduler.getStats(TestPriority::URGENT).depth == 2);
+
+    CHECK((waiting(scheduler) == std::vector<uint32_t>{1, 2, 3, 4}));
+    CHECK((drain(scheduler) == std::vector<uint32_t>{1, 2, 3, 4}));
+    CHECK(scheduler.empty());
+    CHECK(scheduler.getStats(TestPriority::URGENT).dispatched == 2);
+    CHECK(scheduler.getStats(TestPriority::URGENT).depth == 0);
+
+    // Freed entries are reused
+    CHECK(scheduler.push(6, TestPriority::HIGH));
+    CHECK((drain(scheduler) == std::vector<uint32_t>{6}));
+}
+
+// DEADLINE mode runs the most urgent class first, ties in arrival order
+void testDeadlinePriorityOrder() {
+    TestScheduler<uint32_t> scheduler(8, SchedulingMode::DEADLINE);
+    scheduler.push(1, TestPriority::LOW);
+    scheduler.push(2, TestPriority::NORMAL);
+    scheduler.push(3, TestPriority::URGENT);
+    scheduler.push(4, TestPriority::HIGH);
+    scheduler.push(5, TestPriority::URGENT);
+    scheduler.push(6, TestPriority::NORMAL);
+
+    CHECK((waiting(scheduler) == std::vector<uint32_t>{3, 5, 4, 2, 6, 1}));
+    CHECK((drain(scheduler) == std::vector<uint32_t>{3, 5, 4, 2, 6, 1}));
+}
+
+// A caller deadline sooner than the class budget moves a test ahead of
+// more urgent classes; a later one is ignored
+void testCallerDeadline() {
+    using namespace std::chrono_literals;
+    TestScheduler<uint32_t> scheduler(8, SchedulingMode::DEADLINE);
+    scheduler.push(1, TestPriority::URGENT);
+    scheduler.push(2, TestPriority::LOW, 1s);
+    scheduler.push(3, TestPriority::URGENT, std::chrono::hours(1));
+    scheduler.push(4, TestPriority::NORMAL, 10s);
+
+    CHECK((drain(scheduler) == std::vector<uint32_t>{2, 1, 3, 4}));
+}
+
+// Tests dispatched after their deadline are counted as missed
+void testMissedDeadline() {
+    using namespace std::chrono_literals;
+    for (SchedulingMode mode : {SchedulingMode::FIFO, SchedulingMode::DEADLINE}) {
+        TestScheduler<uint32_t> scheduler(4, mode);
+        scheduler.push(1, TestPriority::HIGH, 0s);
+        scheduler.push(2, TestPriority::HIGH);
+        std::this_thread::sleep_for(2ms);
+        CHECK(drain(scheduler).size() == 2);
+
+        TestQueueStats stats = scheduler.getStats(TestPriority::HIGH);
+        CHECK(stats.dispatched == 2);
+        CHECK(stats.missedDeadlines == 1);
+        CHECK(stats.maxWaitMs >= 2.0 && stats.meanWaitMs >= 2.0);
+    }
+}
+
+} // namespace
+
+int main() {
+    testFifoOrder();
+    testDeadlinePriorityOrder();
+    testCallerDeadline();
+    testMissedDeadline();
+    return testResult();
+}
@@ -0,0 +1,48 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Minimal checks for the test executables: a failed check is reported and
+// counted, and main returns testResult() so ctest sees the failure.
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n"; \
+            testFailures()++;                                                             \
+        }                                                                                 \
+    } while (0)
+
+inline int testResult() {
+    if (testFailures() > 0) {
+        std::cerr << testFailures() << " check(s) failed\n";
+        return 1;
+    }
+    return 0;
+}
+
+// A path in the temporary directory that no other run uses; the caller removes it
+inline std::string testPath(const std::string& name) {
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    return (std::filesystem::temp_directory_path() / ("cds-test-" + std::to_string(stamp) + "-" + name)).string();
+}
+
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+inline void writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+}
+
+#endif // TEST_SUPPORT_H
@@ -0,0 +1,171 @@
+#include "../headers/WriteAheadLog.h"
+#include "../headers/CancerDiagnosisSystem.h"
+#include "TestSupport.h"
+#include <cstdio>
+#include <set>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> replayAll(const std::string& path) {
+    std::vector<std::string> records;
+    WriteAheadLog::replay(path, [&](std::string_view record) { records.emplace_back(record); });
+    return records;
+}
+
+// Replay skips empty lines and a last record without its newline
+void testReplaySkipsTornRecord() {
+    std::string path = testPath("torn.wal");
+    writeFile(path, "P|first\n\nP|second\nP|torn");
+    CHECK((replayAll(path) == std::vector<std::string>{"P|first", "P|second"}));
+    CHECK(readFile(path) == "P|first\n\nP|second\nP|torn"); // Replay never writes
+    std::remove(path.c_str());
+
+    CHECK(WriteAheadLog::replay(testPath("missing.wal"), [](std::string_view) {}) == 0);
+}
+
+// Opening trims the torn record so the next append starts a fresh line
+void testOpenTrimsTornRecord() {
+    std::string path = testPath("trim.wal");
+    writeFile(path, "P|first\nP|torn");
+    {
+        WriteAheadLog log;
+        CHECK(log.open(path, WriteAheadLog::FsyncPolicy::ALWAYS));
+        CHECK(log.size() == 8);
+        CHECK(log.waitDurable(log.append("P|second")));
+        CHECK(log.size() == 17);
+    }
+    CHECK(readFile(path) == "P|first\nP|second\n");
+    std::remove(path.c_str());
+}
+
+// Folded records are dropped and later ones kept, in order
+void testDiscardPrefix() {
+    std::string path = testPath("discard.wal");
+    std::remove(path.c_str());
+    WriteAheadLog log;
+    CHECK(log.open(path, WriteAheadLog::FsyncPolicy::NEVER));
+    log.append("G|one");
+    log.append("G|two");
+    CHECK(log.sync());
+    uint64_t folded = log.size();
+    log.append("G|three");
+
+    CHECK(log.discardPrefix(folded));
+    CHECK(log.size() == 8);
+    CHECK(log.waitDurable(log.append("G|four")));
+    CHECK((replayAll(path) == std::vector<std::string>{"G|three", "G|four"}));
+
+    CHECK(log.discardPrefix(log.size()));
+    CHECK(log.size() == 0);
+    CHECK(log.waitDurable(log.append("G|five")));
+    CHECK((replayAll(path) == std::vector<std::string>{"G|five"}));
+    log.close();
+    std::remove(path.c_str());
+}
+
+// A new log starts with a header that is neither replayed nor counted, and
+// discarding records moves the log to a new id
+void testHeaderAndLogId() {
+    std::string path = testPath("header.wal");
+    WriteAheadLog log;
+    CHECK(log.open(path, WriteAheadLog::FsyncPolicy::NEVER));
+    uint64_t firstId = log.getLogId();
+    CHECK(firstId != 0);
+    CHECK(log.size() == 0);
+    CHECK(readFile(path) == "WAL\t" + std::to_string(firstId) + "\n");
+
+    CHECK(log.waitDurable(log.append("G|one")));
+    CHECK(log.size() == 6);
+    CHECK((replayAll(path) == std::vector<std::string>{"G|one"}));
+
+    CHECK(log.discardPrefix(0));
+    CHECK(log.getLogId() != firstId);
+    CHECK(log.size() == 6);
+    uint64_t secondId = log.getLogId();
+    log.close();
+
+    // Reopening keeps the id
+    CHECK(log.open(path, WriteAheadLog::FsyncPolicy::NEVER));
+    CHECK(log.getLogId() == secondId);
+    CHECK((replayAll(path) == std::vector<std::string>{"G|one"}));
+    log.close();
+    std::remove(path.c_str());
+}
+
+// A fold that crashes after committing the rewritten CSVs, but before the
+// folded records were discarded from the log, must not replay them on top
+// of the new files. Crashing between the commit record and the renames
+// must still end with the new files.
+void testFoldCrashBeforeDiscard(bool beforeRenames) {
+    std::string genes = testPath("fold-genes.csv");
+    std::string patients = testPath("fold-patients.csv");
+    std::string logFile = testPath("fold.wal");
+    std::string snapshot = testPath("fold.cds");
+    std::string oldGenes = "Gene_ID,Mutation_Score,Label\nG1,0.1000,0\nG2,0.9000,1\nG3,0.2000,0\nG4,0.8000,1\n";
+    std::string oldPatients = "Patient_ID,Name,Age\nP1,Ann,40\n";
+    writeFile(genes, oldGenes);
+    writeFile(patients, oldPatients);
+
+    std::string logBeforeFold;
+    {
+        CancerDiagnosisSystem system;
+        CHECK(system.enableWriteAheadLog(logFile, genes, patients, WriteAheadLog::FsyncPolicy::ALWAYS));
+        system.loadData(genes, patients);
+        system.addGeneticData(GeneticData("G5", 0.7, 1));
+        system.addGeneticData(GeneticData("G6", 0.3, 0));
+        CHECK(system.syncWriteAheadLog());
+        logBeforeFold = readFile(logFile);
+        CHECK(system.saveSnapshot(snapshot)); // Folds the log
+        CHECK(system.getWriteAheadLogSize() == 0);
+    }
+    std::string newGenes = readFile(genes);
+    std::string newPatients = readFile(patients);
+    CHECK(newGenes != oldGenes);
+
+    // Put back what the crash would have left on disk
+    writeFile(logFile, logBeforeFold);
+    if (beforeRenames) {
+        std::filesystem::rename(genes, genes + ".tmp");
+        std::filesystem::rename(patients, patients + ".tmp");
+        writeFile(genes, oldGenes);
+        writeFile(patients, oldPatients);
+    }
+
+    {
+        CancerDiagnosisSystem system;
+        CHECK(system.enableWriteAheadLog(logFile, genes, patients, WriteAheadLog::FsyncPolicy::ALWAYS));
+        CHECK(system.getWriteAheadLogSize() == 0);
+        if (!system.loadSnapshot(snapshot, genes, patients)) {
+            CHECK(!beforeRenames); // The renames change the files' stamps
+            system.loadData(genes, patients);
+        }
+        std::vector<GeneticData> rows = system.getAllGeneticData();
+        std::set<std::string> geneIds;
+        for (const auto& row : rows) {
+            geneIds.insert(row.getGeneId());
+        }
+        CHECK(rows.size() == 6);
+        CHECK(geneIds.size() == 6);
+        CHECK(system.getPatientCount() == 1);
+    }
+    CHECK(readFile(genes) == newGenes);
+    CHECK(readFile(patients) == newPatients);
+    CHECK(!std::filesystem::exists(genes + ".tmp"));
+
+    for (const std::string& path : {genes, patients, logFile, snapshot, genes + ".commit"}) {
+        std::remove(path.c_str());
+    }
+}
+
+} // namespace
+
+int main() {
+    testReplaySkipsTornRecord();
+    testOpenTrimsTornRecord();
+    testDiscardPrefix();
+    testHeaderAndLogId();
+    testFoldCrashBeforeDiscard(false);
+    testFoldCrashBeforeDiscard(true);
+    return testResult();
+}
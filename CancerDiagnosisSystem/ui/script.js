@@ -548,13 +548,18 @@ async function enqueuePatientFromUI() {
         showStatus(statusDiv, 'Enter a patient ID to enqueue', 'error');
         return;
     }
+    const modelSelect = document.getElementById('queue-model-select');
+    const model = modelSelect ? modelSelect.value : 'logistic';
+    const prioritySelect = document.getElementById('queue-priority-select');
+    const request = { patient_id: pid, model: model };
+    if (prioritySelect && prioritySelect.value) request.priority = prioritySelect.value;
     showStatus(statusDiv, 'Scheduling patient...', 'info');
     setStatusOnline(false);
     try {
         const resp = await fetch(systemState.apiEndpoint + '/queue', {
             method: 'POST',
             headers: { 'Content-Type': 'application/json' },
-            body: JSON.stringify({ patient_id: pid })
+            body: JSON.stringify(request)
         });
         if (!resp.ok) {
             const txt = await resp.text();